@@ -0,0 +1,48 @@
+#include "uart_ipc_cobs.h"
+
+#include <errno.h>
+#include <zephyr/sys/__assert.h>
+
+size_t cobs_encode_in_place(uint8_t *buf, size_t len) {
+    __ASSERT(len <= COBS_IN_PLACE_MAX_LEN, "Block too long to encode in place");
+
+    /* Every zero is replaced by the distance to the next zero, the last one pointing past the end */
+    size_t code_pos = 0;
+    for (size_t i = 1; i <= len; ++i) {
+        if (buf[i] == COBS_DELIMITER) {
+            buf[code_pos] = (uint8_t)(i - code_pos);
+            code_pos = i;
+        }
+    }
+    buf[code_pos] = (uint8_t)(len + 1 - code_pos);
+
+    return len + 1;
+}
+
+int cobs_decode(uint8_t *dst, const uint8_t *src, size_t len) {
+    size_t read = 0;
+    size_t written = 0;
+
+    while (read < len) {
+        uint8_t code = src[read];
+        if (code == COBS_DELIMITER || read + code > len) {
+            return -EINVAL;
+        }
+        read++;
+
+        for (uint8_t i = 1; i < code; ++i) {
+            uint8_t byte = src[read++];
+            if (byte == COBS_DELIMITER) {
+                return -EINVAL;
+            }
+            dst[written++] = byte;
+        }
+
+        /* A code of 0xFF is a full block without a trailing zero. The implicit zero after the last block is dropped */
+        if (code != 0xFF && read < len) {
+            dst[written++] = 0;
+        }
+    }
+
+    return (int)written;
+}
@@ -0,0 +1,33 @@
+#ifndef UART_IPC_COBS_H_
+#define UART_IPC_COBS_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Frame delimiter. COBS encoded data never contains this byte */
+#define COBS_DELIMITER 0x00
+
+/* Largest block that can be encoded in place, longer blocks need more than one overhead byte */
+#define COBS_IN_PLACE_MAX_LEN 253
+
+/**
+ * @brief COBS encodes a block in place. The block to encode starts at buf[1], buf[0] is overwritten by the
+ * first code byte. The encoded block is len + 1 bytes and does not include a delimiter.
+ *
+ * @param buf Buffer holding one free byte followed by the data to encode
+ * @param len Length of the data, at most COBS_IN_PLACE_MAX_LEN
+ * @return Length of the encoded block
+ */
+size_t cobs_encode_in_place(uint8_t *buf, size_t len);
+
+/**
+ * @brief Decodes a COBS encoded block without its delimiter. Decoding in place (dst == src) is supported.
+ *
+ * @param dst Destination buffer, at least len - 1 bytes
+ * @param src Encoded block
+ * @param len Length of the encoded block
+ * @return Length of the decoded data, or -EINVAL if the block is not valid COBS
+ */
+int cobs_decode(uint8_t *dst, const uint8_t *src, size_t len);
+
+#endif /* UART_IPC_COBS_H_ */
@@ -0,0 +1,19 @@
+#ifndef UART_IPC_CRC_H_
+#define UART_IPC_CRC_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Computes the crc32-ieee of a buffer, using the implementation selected in Kconfig. The result is the
+ * same as crc32_ieee.
+ */
+uint32_t uart_ipc_crc32(const uint8_t *data, size_t len);
+
+/**
+ * @brief Computes the CRC-16/CCITT-FALSE of a buffer (polynomial 0x1021, initial value 0xFFFF). The result
+ * is the same as crc16_itu_t with a seed of 0xFFFF.
+ */
+uint16_t uart_ipc_crc16(const uint8_t *data, size_t len);
+
+#endif /* UART_IPC_CRC_H_ */
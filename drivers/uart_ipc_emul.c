@@ -0,0 +1,455 @@
+#include <string.h>
+#include <zephyr/device.h>
+#include <zephyr/devicetree.h>
+#include <zephyr/drivers/uart.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+
+#include "uart_ipc_emul.h"
+
+LOG_MODULE_REGISTER(uart_ipc_emul, CONFIG_UART_LOG_LEVEL);
+
+#define DT_DRV_COMPAT zephyr_uart_ipc_emul
+
+/* Bytes sent with poll_out that can wait for the system work queue */
+#define EMUL_POLL_BUF_LEN 32
+
+/*
+ * Emulated UART wired to a peer emulated UART, implementing the async API. Transmitted bytes arrive at the
+ * peer once the time they take on the line at the configured baud rate has passed. Events are raised from the
+ * system work queue, and the RX state of a device is only touched from there and from its own callback.
+ *
+ * Faults can be injected into the received bytes with uart_ipc_emul_set_faults, decided by a seeded pseudo random
+ * number generator so that a run can be repeated.
+ */
+
+struct uart_ipc_emul_config {
+    const struct device *peer;
+};
+
+struct uart_ipc_emul_data {
+    const struct device *dev;
+    struct uart_config uart_cfg;
+    uart_callback_t callback;
+    void *user_data;
+
+    const uint8_t *tx_buf;  // Transfer in progress, NULL if idle
+    size_t tx_len;
+    struct k_work_delayable tx_work;
+
+    struct k_spinlock poll_lock;          // Protects the poll_out bytes below
+    uint8_t poll_buf[EMUL_POLL_BUF_LEN];  // Bytes sent with poll_out, handed to the peer by poll_work
+    size_t poll_len;
+    struct k_work poll_work;
+
+    bool rx_enabled;
+    uint8_t *rx_buf;        // Buffer being filled
+    size_t rx_len;
+    size_t rx_filled;       // Bytes written to rx_buf
+    size_t rx_reported;     // Bytes of rx_buf already reported with UART_RX_RDY
+    uint8_t *rx_next_buf;   // Buffer provided with uart_rx_buf_rsp, NULL if none
+    size_t rx_next_len;
+    int32_t rx_timeout_us;  // Inactivity timeout given to uart_rx_enable
+    struct k_work_delayable rx_idle_work;     // Reports bytes held back by a merge fault
+    struct k_work_delayable rx_buf_req_work;  // Raises a delayed buffer request
+
+    struct uart_ipc_emul_faults faults;
+    struct uart_ipc_emul_fault_counts fault_counts;
+    uint32_t rand_state;
+};
+
+/* xorshift32, cheap and repeatable for a given seed */
+static uint32_t emul_rand(struct uart_ipc_emul_data *data) {
+    uint32_t x = data->rand_state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    data->rand_state = x;
+    return x;
+}
+
+static bool emul_fault(struct uart_ipc_emul_data *data, uint32_t ppm) {
+    return ppm > 0 && emul_rand(data) % 1000000 < ppm;
+}
+
+static void emul_notify(struct uart_ipc_emul_data *data, struct uart_event *evt) {
+    if (data->callback != NULL) {
+        data->callback(data->dev, evt, data->user_data);
+    }
+}
+
+static void emul_rx_report(struct uart_ipc_emul_data *data) {
+    if (data->rx_filled == data->rx_reported) {
+        return;
+    }
+    struct uart_event evt = {
+        .type = UART_RX_RDY,
+        .data.rx = {.buf = data->rx_buf, .offset = data->rx_reported, .len = data->rx_filled - data->rx_reported},
+    };
+    data->rx_reported = data->rx_filled;
+    emul_notify(data, &evt);
+}
+
+static void emul_rx_request_buf(struct uart_ipc_emul_data *data) {
+    if (emul_fault(data, data->faults.buf_request_delay_ppm)) {
+        data->fault_counts.delayed_buf_requests++;
+        k_work_schedule(&data->rx_buf_req_work, K_USEC(data->faults.buf_request_delay_us));
+        return;
+    }
+    struct uart_event evt = {.type = UART_RX_BUF_REQUEST};
+    emul_notify(data, &evt);
+}
+
+static void emul_rx_buf_req_handler(struct k_work *work) {
+    struct uart_ipc_emul_data *data = CONTAINER_OF(k_work_delayable_from_work(work), struct uart_ipc_emul_data, rx_buf_req_work);
+    struct uart_event evt = {.type = UART_RX_BUF_REQUEST};
+
+    if (data->rx_enabled && data->rx_next_buf == NULL) {
+        emul_notify(data, &evt);
+    }
+}
+
+static void emul_rx_stop(struct uart_ipc_emul_data *data) {
+    struct uart_event evt = {.type = UART_RX_BUF_RELEASED};
+
+    emul_rx_report(data);
+    data->rx_enabled = false;
+    k_work_cancel_delayable(&data->rx_buf_req_work);
+    if (data->rx_buf != NULL) {
+        evt.data.rx_buf.buf = data->rx_buf;
+        data->rx_buf = NULL;
+        emul_notify(data, &evt);
+    }
+    if (data->rx_next_buf != NULL) {
+        evt.data.rx_buf.buf = data->rx_next_buf;
+        data->rx_next_buf = NULL;
+        emul_notify(data, &evt);
+    }
+    evt.type = UART_RX_DISABLED;
+    emul_notify(data, &evt);
+}
+
+/**
+ * @brief Switches to the next RX buffer once the current one is full. Receiving stops if there is none.
+ *
+ * @return true if receiving continues in the next buffer.
+ */
+static bool emul_rx_next_buf(struct uart_ipc_emul_data *data) {
+    struct uart_event evt = {.type = UART_RX_BUF_RELEASED, .data.rx_buf.buf = data->rx_buf};
+
+    emul_rx_report(data);
+    if (data->rx_next_buf == NULL) {
+        LOG_WRN("%s: no RX buffer provided, receiving stops", data->dev->name);
+        emul_rx_stop(data);
+        return false;
+    }
+    data->rx_buf = data->rx_next_buf;
+    data->rx_len = data->rx_next_len;
+    data->rx_filled = 0;
+    data->rx_reported = 0;
+    data->rx_next_buf = NULL;
+    emul_notify(data, &evt);
+
+    emul_rx_request_buf(data);
+    return true;
+}
+
+/**
+ * @brief Receives bytes from the peer, with the configured faults. Bytes arriving while receiving is disabled are
+ * lost, as on a real line, including the rest of a transfer during which receiving stopped.
+ *
+ * @param garbled The bytes were sent at another baud rate or faster than the line carries, every byte arrives
+ * as a random one.
+ */
+static void emul_rx_bytes(struct uart_ipc_emul_data *data, const uint8_t *bytes, size_t len, bool garbled) {
+    size_t split_at = SIZE_MAX;
+
+    if (!data->rx_enabled) {
+        return;
+    }
+    if (len > 1 && emul_fault(data, data->faults.split_ppm)) {
+        data->fault_counts.splits++;
+        split_at = 1 + emul_rand(data) % (len - 1);
+    }
+
+    for (size_t i = 0; i < len; ++i) {
+        if (i == split_at) {
+            emul_rx_report(data);
+        }
+        uint8_t byte = bytes[i];
+        if (garbled) {
+            data->fault_counts.garbled_bytes++;
+            byte = emul_rand(data);
+        }
+        if (emul_fault(data, data->faults.drop_ppm)) {
+            data->fault_counts.dropped_bytes++;
+            continue;
+        }
+        if (emul_fault(data, data->faults.bit_flip_ppm)) {
+            data->fault_counts.bit_flips++;
+            byte ^= BIT(emul_rand(data) % 8);
+        }
+        data->rx_buf[data->rx_filled++] = byte;
+
+        if (data->rx_filled == data->rx_len && !emul_rx_next_buf(data)) {
+            return;
+        }
+    }
+
+    /* The line goes idle after the transfer, so the inactivity timeout reports the rest right away */
+    if (emul_fault(data, data->faults.merge_ppm)) {
+        data->fault_counts.merges++;
+        k_work_schedule(&data->rx_idle_work, K_USEC(data->rx_timeout_us > 0 ? data->rx_timeout_us : 100));
+        return;
+    }
+    emul_rx_report(data);
+}
+
+static void emul_rx_idle_handler(struct k_work *work) {
+    struct uart_ipc_emul_data *data = CONTAINER_OF(k_work_delayable_from_work(work), struct uart_ipc_emul_data, rx_idle_work);
+
+    if (data->rx_enabled) {
+        emul_rx_report(data);
+    }
+}
+
+/* Bytes sent by one side arrive garbled if the baud rates differ, or exceed the highest rate the line carries */
+static bool emul_garbled(const struct uart_ipc_emul_data *data, const struct uart_ipc_emul_data *peer_data) {
+    uint32_t max_baudrate = peer_data->faults.max_baudrate;
+
+    return data->uart_cfg.baudrate != peer_data->uart_cfg.baudrate || (max_baudrate != 0 && data->uart_cfg.baudrate > max_baudrate);
+}
+
+static void emul_tx_handler(struct k_work *work) {
+    struct uart_ipc_emul_data *data = CONTAINER_OF(k_work_delayable_from_work(work), struct uart_ipc_emul_data, tx_work);
+    const struct uart_ipc_emul_config *config = data->dev->config;
+    struct uart_ipc_emul_data *peer_data = config->peer->data;
+
+    struct uart_event evt = {
+        .type = UART_TX_DONE,
+        .data.tx = {.buf = data->tx_buf, .len = data->tx_len},
+    };
+    if (data->tx_len > 0 && emul_fault(peer_data, peer_data->faults.tx_abort_ppm)) {
+        peer_data->fault_counts.tx_aborts++;
+        evt.type = UART_TX_ABORTED;
+        evt.data.tx.len = emul_rand(peer_data) % data->tx_len;
+    }
+    emul_rx_bytes(peer_data, data->tx_buf, evt.data.tx.len, emul_garbled(data, peer_data));
+    data->tx_buf = NULL;
+    emul_notify(data, &evt);
+}
+
+/* Time the bytes take on the line, with one start and one stop bit per byte */
+static k_timeout_t emul_line_time(const struct uart_ipc_emul_data *data, size_t len) {
+    if (data->uart_cfg.baudrate == 0) {
+        return K_NO_WAIT;
+    }
+    return K_USEC((uint64_t)len * 10 * USEC_PER_SEC / data->uart_cfg.baudrate);
+}
+
+static int emul_callback_set(const struct device *dev, uart_callback_t callback, void *user_data) {
+    struct uart_ipc_emul_data *data = dev->data;
+
+    data->callback = callback;
+    data->user_data = user_data;
+    return 0;
+}
+
+static int emul_tx(const struct device *dev, const uint8_t *buf, size_t len, int32_t timeout) {
+    struct uart_ipc_emul_data *data = dev->data;
+
+    if (data->tx_buf != NULL) {
+        return -EBUSY;
+    }
+    data->tx_buf = buf;
+    data->tx_len = len;
+    k_work_schedule(&data->tx_work, emul_line_time(data, len));
+    return 0;
+}
+
+static int emul_tx_abort(const struct device *dev) {
+    struct uart_ipc_emul_data *data = dev->data;
+
+    if (data->tx_buf == NULL || k_work_cancel_delayable(&data->tx_work) != 0) {
+        return -EFAULT;
+    }
+    struct uart_event evt = {
+        .type = UART_TX_ABORTED,
+        .data.tx = {.buf = data->tx_buf, .len = 0},
+    };
+    data->tx_buf = NULL;
+    emul_notify(data, &evt);
+    return 0;
+}
+
+static int emul_rx_enable(const struct device *dev, uint8_t *buf, size_t len, int32_t timeout) {
+    struct uart_ipc_emul_data *data = dev->data;
+
+    if (data->rx_enabled) {
+        return -EBUSY;
+    }
+    data->rx_buf = buf;
+    data->rx_len = len;
+    data->rx_filled = 0;
+    data->rx_reported = 0;
+    data->rx_next_buf = NULL;
+    data->rx_timeout_us = timeout;
+    data->rx_enabled = true;
+
+    emul_rx_request_buf(data);
+    return 0;
+}
+
+static int emul_rx_buf_rsp(const struct device *dev, uint8_t *buf, size_t len) {
+    struct uart_ipc_emul_data *data = dev->data;
+
+    if (!data->rx_enabled) {
+        return -EACCES;
+    }
+    if (data->rx_next_buf != NULL) {
+        return -EBUSY;
+    }
+    data->rx_next_buf = buf;
+    data->rx_next_len = len;
+    return 0;
+}
+
+static int emul_rx_disable(const struct device *dev) {
+    struct uart_ipc_emul_data *data = dev->data;
+
+    if (!data->rx_enabled) {
+        return -EFAULT;
+    }
+    emul_rx_stop(data);
+    return 0;
+}
+
+static int emul_poll_in(const struct device *dev, unsigned char *c) {
+    return -1;  // Only the async API is emulated
+}
+
+static void emul_poll_handler(struct k_work *work) {
+    struct uart_ipc_emul_data *data = CONTAINER_OF(work, struct uart_ipc_emul_data, poll_work);
+    const struct uart_ipc_emul_config *config = data->dev->config;
+    uint8_t bytes[EMUL_POLL_BUF_LEN];
+
+    k_spinlock_key_t key = k_spin_lock(&data->poll_lock);
+    size_t len = data->poll_len;
+    memcpy(bytes, data->poll_buf, len);
+    data->poll_len = 0;
+    k_spin_unlock(&data->poll_lock, key);
+
+    emul_rx_bytes(config->peer->data, bytes, len, emul_garbled(data, config->peer->data));
+}
+
+/* Queues the byte for the system work queue, which is the only context touching the RX state of the peer */
+static void emul_poll_out(const struct device *dev, unsigned char c) {
+    struct uart_ipc_emul_data *data = dev->data;
+    bool dropped = false;
+
+    k_spinlock_key_t key = k_spin_lock(&data->poll_lock);
+    if (data->poll_len < sizeof(data->poll_buf)) {
+        data->poll_buf[data->poll_len++] = c;
+    } else {
+        dropped = true;
+    }
+    k_spin_unlock(&data->poll_lock, key);
+
+    if (dropped) {
+        LOG_WRN("%s: poll_out bytes pile up, dropping one", dev->name);
+    }
+    k_work_submit(&data->poll_work);
+}
+
+static int emul_configure(const struct device *dev, const struct uart_config *cfg) {
+    struct uart_ipc_emul_data *data = dev->data;
+
+    data->uart_cfg = *cfg;
+    return 0;
+}
+
+static int emul_config_get(const struct device *dev, struct uart_config *cfg) {
+    struct uart_ipc_emul_data *data = dev->data;
+
+    *cfg = data->uart_cfg;
+    return 0;
+}
+
+static const struct uart_driver_api emul_api = {
+    .poll_in = emul_poll_in,
+    .poll_out = emul_poll_out,
+#ifdef CONFIG_UART_USE_RUNTIME_CONFIGURE
+    .configure = emul_configure,
+    .config_get = emul_config_get,
+#endif
+    .callback_set = emul_callback_set,
+    .tx = emul_tx,
+    .tx_abort = emul_tx_abort,
+    .rx_enable = emul_rx_enable,
+    .rx_buf_rsp = emul_rx_buf_rsp,
+    .rx_disable = emul_rx_disable,
+};
+
+int uart_ipc_emul_set_faults(const struct device *dev, const struct uart_ipc_emul_faults *faults) {
+    struct uart_ipc_emul_data *data = dev->data;
+
+    if (dev->api != &emul_api) {
+        return -EINVAL;
+    }
+    k_sched_lock();  // Faults are applied from the system work queue
+    data->faults = *faults;
+    if (faults->seed != 0) {
+        data->rand_state = faults->seed;
+    }
+    memset(&data->fault_counts, 0, sizeof(data->fault_counts));
+    k_sched_unlock();
+    return 0;
+}
+
+int uart_ipc_emul_get_fault_counts(const struct device *dev, struct uart_ipc_emul_fault_counts *counts) {
+    struct uart_ipc_emul_data *data = dev->data;
+
+    if (dev->api != &emul_api) {
+        return -EINVAL;
+    }
+    k_sched_lock();
+    *counts = data->fault_counts;
+    k_sched_unlock();
+    return 0;
+}
+
+static int emul_init(const struct device *dev) {
+    struct uart_ipc_emul_data *data = dev->data;
+
+    data->dev = dev;
+    data->rand_state = 1;
+    k_work_init_delayable(&data->tx_work, emul_tx_handler);
+    k_work_init(&data->poll_work, emul_poll_handler);
+    k_work_init_delayable(&data->rx_idle_work, emul_rx_idle_handler);
+    k_work_init_delayable(&data->rx_buf_req_work, emul_rx_buf_req_handler);
+    return 0;
+}
+
+#define DEFINE_UART_IPC_EMUL(inst)                                          \
+    static const struct uart_ipc_emul_config uart_ipc_emul_config_##inst = { \
+        .peer = DEVICE_DT_GET(DT_INST_PHANDLE(inst, peer)),                 \
+    };                                                                      \
+    static struct uart_ipc_emul_data uart_ipc_emul_data_##inst = {          \
+        .uart_cfg = {                                                       \
+            .baudrate = DT_INST_PROP_OR(inst, current_speed, 0),            \
+            .parity = UART_CFG_PARITY_NONE,                                 \
+            .stop_bits = UART_CFG_STOP_BITS_1,                              \
+            .data_bits = UART_CFG_DATA_BITS_8,                              \
+            .flow_ctrl = UART_CFG_FLOW_CTRL_NONE,                           \
+        },                                                                  \
+    };                                                                      \
+    DEVICE_DT_INST_DEFINE(inst,                                             \
+                          &emul_init,                                       \
+                          NULL,                                             \
+                          &uart_ipc_emul_data_##inst,                       \
+                          &uart_ipc_emul_config_##inst,                     \
+                          PRE_KERNEL_1,                                     \
+                          CONFIG_SERIAL_INIT_PRIORITY,                      \
+                          &emul_api);
+
+DT_INST_FOREACH_STATUS_OKAY(DEFINE_UART_IPC_EMUL);
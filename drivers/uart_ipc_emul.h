@@ -0,0 +1,49 @@
+#ifndef UART_IPC_EMUL_H_
+#define UART_IPC_EMUL_H_
+
+#include <stdint.h>
+#include <zephyr/device.h>
+
+/**
+ * @brief Faults injected into the bytes an emulated UART receives from its peer. Rates are given in parts per
+ * million, so 0 disables a fault and 1000000 applies it every time.
+ */
+struct uart_ipc_emul_faults {
+    uint32_t seed;                   // Seed of the random number generator deciding when faults happen, 0 keeps the current state
+    uint32_t bit_flip_ppm;           // Per byte, one random bit of the byte is flipped
+    uint32_t drop_ppm;               // Per byte, the byte is lost
+    uint32_t split_ppm;              // Per transfer, the bytes are reported in two chunks
+    uint32_t merge_ppm;              // Per transfer, the bytes are held back and reported together with the next transfer
+    uint32_t buf_request_delay_ppm;  // Per RX buffer, the request for the next buffer is raised late
+    uint32_t buf_request_delay_us;   // How late a delayed buffer request is raised
+    uint32_t tx_abort_ppm;           // Per transfer of the peer, the transfer is aborted after a random number of bytes
+    uint32_t max_baudrate;           // Bytes sent faster than this arrive garbled, 0 for no limit
+};
+
+/* Number of faults injected since the faults were last set */
+struct uart_ipc_emul_fault_counts {
+    uint32_t bit_flips;
+    uint32_t dropped_bytes;
+    uint32_t splits;
+    uint32_t merges;
+    uint32_t delayed_buf_requests;
+    uint32_t tx_aborts;
+    uint32_t garbled_bytes;  // Bytes sent at another baud rate than the receiver's, or above max_baudrate
+};
+
+/**
+ * @brief Sets the faults injected into the bytes received by an emulated UART, and clears the fault counts.
+ * Transfers aborted with tx_abort_ppm are counted on the receiving UART.
+ *
+ * @return 0 on success, -EINVAL if the device is not an emulated UART.
+ */
+int uart_ipc_emul_set_faults(const struct device *dev, const struct uart_ipc_emul_faults *faults);
+
+/**
+ * @brief Reads the number of faults injected into the bytes received by an emulated UART.
+ *
+ * @return 0 on success, -EINVAL if the device is not an emulated UART.
+ */
+int uart_ipc_emul_get_fault_counts(const struct device *dev, struct uart_ipc_emul_fault_counts *counts);
+
+#endif /* UART_IPC_EMUL_H_ */
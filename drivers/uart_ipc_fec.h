@@ -0,0 +1,33 @@
+#ifndef UART_IPC_FEC_H_
+#define UART_IPC_FEC_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Parity bytes appended to a protected block. Up to half as many corrupted bytes are corrected */
+#define UART_IPC_FEC_PARITY_LEN CONFIG_IPC_BACKEND_UART_FEC_PARITY
+
+/* Longest block that can be protected, a Reed-Solomon codeword over GF(2^8) holds at most 255 bytes */
+#define UART_IPC_FEC_MAX_LEN (255 - UART_IPC_FEC_PARITY_LEN)
+
+/**
+ * @brief Computes the Reed-Solomon parity of a block (GF(2^8) with polynomial 0x11D, first consecutive root 1).
+ *
+ * @param data Block to protect
+ * @param len Length of the block, at most UART_IPC_FEC_MAX_LEN
+ * @param parity Destination of UART_IPC_FEC_PARITY_LEN parity bytes
+ */
+void uart_ipc_fec_encode(const uint8_t *data, size_t len, uint8_t *parity);
+
+/**
+ * @brief Corrects a received block in place with its parity. Errors in the parity bytes are corrected as well,
+ * but only the block is written.
+ *
+ * @param data Received block
+ * @param len Length of the block, at most UART_IPC_FEC_MAX_LEN
+ * @param parity The UART_IPC_FEC_PARITY_LEN parity bytes received with the block
+ * @return Number of corrected bytes, or -EBADMSG if the block has more errors than the parity can correct
+ */
+int uart_ipc_fec_decode(uint8_t *data, size_t len, const uint8_t *parity);
+
+#endif /* UART_IPC_FEC_H_ */
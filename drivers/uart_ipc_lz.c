@@ -0,0 +1,176 @@
+#include "uart_ipc_lz.h"
+
+#include <errno.h>
+#include <string.h>
+#include <zephyr/sys/byteorder.h>
+#include <zephyr/sys/util.h>
+
+/*
+ * LZ4 block format. A block is a sequence of sequences, each a token byte holding the literal count in the
+ * high nibble and the match length minus LZ_MIN_MATCH in the low nibble, followed by the literals and the
+ * little endian match offset. Nibbles of 15 are continued with bytes that are added to them, up to and
+ * including the first byte that is not 255. The last sequence only has literals.
+ */
+#define LZ_MIN_MATCH 4
+#define LZ_LAST_LITERALS 5    // The last bytes of a block are always literals
+#define LZ_MATCH_END_LIMIT 12 // No match starts in the last bytes of a block
+#define LZ_NIBBLE_MAX 15
+#define LZ_HASH_SIZE BIT(CONFIG_IPC_BACKEND_UART_COMPRESSION_HASH_BITS)
+
+static inline size_t lz_hash(uint32_t sequence) {
+    return (sequence * 2654435761U) >> (32 - CONFIG_IPC_BACKEND_UART_COMPRESSION_HASH_BITS);
+}
+
+/* Bytes needed to continue a length that does not fit in its nibble */
+static inline size_t lz_length_bytes(size_t len) {
+    return len < LZ_NIBBLE_MAX ? 0 : (len - LZ_NIBBLE_MAX) / 255 + 1;
+}
+
+static uint8_t *lz_put_length(uint8_t *dst, size_t len) {
+    for (len -= LZ_NIBBLE_MAX; len >= 255; len -= 255) {
+        *dst++ = 255;
+    }
+    *dst++ = (uint8_t)len;
+    return dst;
+}
+
+/**
+ * @brief Writes a sequence. A match_len of 0 writes the last sequence, which has no match.
+ *
+ * @return 0 on success, -ENOSPC if the sequence does not fit.
+ */
+static int lz_put_sequence(uint8_t *dst, size_t dst_len, size_t *out, const uint8_t *literals, size_t literal_len, uint16_t offset,
+                           size_t match_len) {
+    size_t match_code = match_len > 0 ? match_len - LZ_MIN_MATCH : 0;
+    size_t needed = 1 + lz_length_bytes(literal_len) + literal_len;
+    if (match_len > 0) {
+        needed += sizeof(offset) + lz_length_bytes(match_code);
+    }
+    if (needed > dst_len - *out) {
+        return -ENOSPC;
+    }
+
+    uint8_t *pos = dst + *out;
+    *pos++ = (MIN(literal_len, LZ_NIBBLE_MAX) << 4) | MIN(match_code, LZ_NIBBLE_MAX);
+    if (literal_len >= LZ_NIBBLE_MAX) {
+        pos = lz_put_length(pos, literal_len);
+    }
+    memcpy(pos, literals, literal_len);
+    pos += literal_len;
+
+    if (match_len > 0) {
+        sys_put_le16(offset, pos);
+        pos += sizeof(offset);
+        if (match_code >= LZ_NIBBLE_MAX) {
+            pos = lz_put_length(pos, match_code);
+        }
+    }
+    *out = pos - dst;
+    return 0;
+}
+
+int uart_ipc_lz_compress(uint8_t *dst, size_t dst_len, const uint8_t *src, size_t src_len) {
+    uint16_t table[LZ_HASH_SIZE];  // Last position of each hashed sequence. Candidates are verified, so stale entries are harmless
+    size_t anchor = 0;             // Start of the literals not yet written
+    size_t out = 0;
+
+    memset(table, 0, sizeof(table));
+
+    if (src_len > LZ_MATCH_END_LIMIT) {
+        const size_t match_start_limit = src_len - LZ_MATCH_END_LIMIT;
+        const size_t match_end_limit = src_len - LZ_LAST_LITERALS;
+
+        for (size_t pos = 1; pos <= match_start_limit;) {
+            uint32_t sequence = sys_get_le32(src + pos);
+            size_t hash = lz_hash(sequence);
+            size_t candidate = table[hash];
+            table[hash] = pos;
+
+            if (candidate >= pos || sys_get_le32(src + candidate) != sequence) {
+                pos++;
+                continue;
+            }
+
+            size_t match_len = LZ_MIN_MATCH;
+            while (pos + match_len < match_end_limit && src[candidate + match_len] == src[pos + match_len]) {
+                match_len++;
+            }
+
+            int err = lz_put_sequence(dst, dst_len, &out, src + anchor, pos - anchor, pos - candidate, match_len);
+            if (err) {
+                return err;
+            }
+            pos += match_len;
+            anchor = pos;
+        }
+    }
+
+    int err = lz_put_sequence(dst, dst_len, &out, src + anchor, src_len - anchor, 0, 0);
+    return err ? err : (int)out;
+}
+
+/**
+ * @brief Reads the continuation of a length whose nibble is 15.
+ *
+ * @return 0 on success, -EINVAL if the block ends first.
+ */
+static int lz_get_length(const uint8_t *src, size_t src_len, size_t *in, size_t *len) {
+    uint8_t byte;
+    do {
+        if (*in >= src_len) {
+            return -EINVAL;
+        }
+        byte = src[(*in)++];
+        *len += byte;
+    } while (byte == 255);
+    return 0;
+}
+
+int uart_ipc_lz_decompress(uint8_t *dst, size_t dst_len, const uint8_t *src, size_t src_len) {
+    size_t in = 0;
+    size_t out = 0;
+
+    while (in < src_len) {
+        uint8_t token = src[in++];
+
+        size_t literal_len = token >> 4;
+        if (literal_len == LZ_NIBBLE_MAX && lz_get_length(src, src_len, &in, &literal_len)) {
+            return -EINVAL;
+        }
+        if (literal_len > src_len - in || literal_len > dst_len - out) {
+            return -EINVAL;
+        }
+        memcpy(dst + out, src + in, literal_len);
+        in += literal_len;
+        out += literal_len;
+
+        if (in == src_len) {
+            break;  // Last sequence
+        }
+
+        if (src_len - in < sizeof(uint16_t)) {
+            return -EINVAL;
+        }
+        size_t offset = sys_get_le16(src + in);
+        in += sizeof(uint16_t);
+        if (offset == 0 || offset > out) {
+            return -EINVAL;
+        }
+
+        size_t match_len = token & LZ_NIBBLE_MAX;
+        if (match_len == LZ_NIBBLE_MAX && lz_get_length(src, src_len, &in, &match_len)) {
+            return -EINVAL;
+        }
+        match_len += LZ_MIN_MATCH;
+        if (match_len > dst_len - out) {
+            return -EINVAL;
+        }
+
+        /* Byte by byte, as the match may overlap the bytes it produces */
+        for (size_t i = 0; i < match_len; ++i, ++out) {
+            dst[out] = dst[out - offset];
+        }
+    }
+
+    return (int)out;
+}
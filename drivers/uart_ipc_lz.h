@@ -0,0 +1,30 @@
+#ifndef UART_IPC_LZ_H_
+#define UART_IPC_LZ_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Compresses a block in the LZ4 block format. Matches are found with a hash table of
+ * 2^CONFIG_IPC_BACKEND_UART_COMPRESSION_HASH_BITS entries on the stack, nothing is allocated.
+ *
+ * @param dst Destination buffer
+ * @param dst_len Size of the destination buffer
+ * @param src Data to compress
+ * @param src_len Length of the data, at most UINT16_MAX
+ * @return Length of the compressed block, or -ENOSPC if it does not fit in dst
+ */
+int uart_ipc_lz_compress(uint8_t *dst, size_t dst_len, const uint8_t *src, size_t src_len);
+
+/**
+ * @brief Decompresses a block in the LZ4 block format.
+ *
+ * @param dst Destination buffer
+ * @param dst_len Size of the destination buffer
+ * @param src Compressed block
+ * @param src_len Length of the compressed block
+ * @return Length of the decompressed data, or -EINVAL if the block is malformed or does not fit in dst
+ */
+int uart_ipc_lz_decompress(uint8_t *dst, size_t dst_len, const uint8_t *src, size_t src_len);
+
+#endif /* UART_IPC_LZ_H_ */
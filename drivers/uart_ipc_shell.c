@@ -0,0 +1,67 @@
+#include <zephyr/device.h>
+#include <zephyr/shell/shell.h>
+
+#include "uart_ipc_stats.h"
+
+static const struct device *shell_instance(const struct shell *sh, const char *name) {
+    const struct device *instance = device_get_binding(name);
+    if (instance == NULL) {
+        shell_error(sh, "Device %s not found", name);
+    }
+    return instance;
+}
+
+static void print_histogram(const struct shell *sh, const char *title, const uint32_t *hist) {
+    shell_print(sh, "%s:", title);
+    for (size_t i = 0; i < UART_IPC_STATS_HIST_BUCKETS; ++i) {
+        if (hist[i] == 0) {
+            continue;
+        }
+        if (i == UART_IPC_STATS_HIST_BUCKETS - 1) {
+            shell_print(sh, "  >= %8u us: %u", 1U << i, hist[i]);
+        } else {
+            shell_print(sh, "  <  %8u us: %u", 1U << (i + 1), hist[i]);
+        }
+    }
+}
+
+static int cmd_stats(const struct shell *sh, size_t argc, char **argv) {
+    const struct device *instance = shell_instance(sh, argv[1]);
+    if (instance == NULL) {
+        return -ENODEV;
+    }
+
+    struct uart_ipc_stats stats;
+    int err = uart_ipc_stats_get(instance, &stats);
+    if (err) {
+        shell_error(sh, "%s is not a UART IPC backend: %d", argv[1], err);
+        return err;
+    }
+
+#define PRINT_COUNTER(name, description) shell_print(sh, "%-20s %10u  %s", #name, stats.name, description);
+    UART_IPC_STATS_COUNTERS(PRINT_COUNTER)
+#undef PRINT_COUNTER
+    print_histogram(sh, "TX latency", stats.tx_latency);
+    print_histogram(sh, "RX reassembly time", stats.rx_reassembly);
+    return 0;
+}
+
+static int cmd_reset(const struct shell *sh, size_t argc, char **argv) {
+    const struct device *instance = shell_instance(sh, argv[1]);
+    if (instance == NULL) {
+        return -ENODEV;
+    }
+
+    int err = uart_ipc_stats_reset(instance);
+    if (err) {
+        shell_error(sh, "%s is not a UART IPC backend: %d", argv[1], err);
+    }
+    return err;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(sub_uart_ipc,
+    SHELL_CMD_ARG(stats, NULL, "Show link statistics <device>", cmd_stats, 2, 0),
+    SHELL_CMD_ARG(reset, NULL, "Reset link statistics <device>", cmd_reset, 2, 0),
+    SHELL_SUBCMD_SET_END);
+
+SHELL_CMD_REGISTER(uart_ipc, &sub_uart_ipc, "UART IPC service backend", NULL);
@@ -0,0 +1,56 @@
+#ifndef UART_IPC_STATS_H_
+#define UART_IPC_STATS_H_
+
+#include <stdint.h>
+#include <zephyr/device.h>
+
+/* Counters kept per instance, as X(name, description) */
+#define UART_IPC_STATS_COUNTERS(X)                                                  \
+    X(tx_frames, "Frames sent")                                                     \
+    X(tx_bytes, "Bytes sent, including framing")                                    \
+    X(rx_frames, "Valid frames received")                                           \
+    X(rx_bytes, "Bytes received, including framing and invalid data")               \
+    X(crc_errors, "Frames with a crc mismatch")                                     \
+    X(resyncs, "Times frame alignment was lost")                                    \
+    X(rx_timeouts, "Transfers dropped waiting for their next frame")                \
+    X(rx_dropped, "Received chunks dropped because the RX thread fell behind")      \
+    X(tx_aborts, "Transmissions aborted by the UART")                               \
+    X(tx_errors, "Transmissions the UART refused to start")                         \
+    X(retransmissions, "Frames resent in reliable mode")                            \
+    X(rx_slab_failures, "RX buffer requests that found no free RX buffer")          \
+    X(tx_slab_failures, "Sends that found no free TX buffer")                       \
+    X(heap_failures, "Failed heap or static pool message allocations")              \
+    X(tx_queue_full, "Sends that found the TX queue full")                          \
+    X(tx_queue_high_water, "Most messages waiting in one TX queue at once")         \
+    X(link_ups, "Times the link handshake completed, once per start of the peer")   \
+    X(baud_fallbacks, "Returns to the default baud rate after too many RX errors")  \
+    X(frag_size_changes, "Fragment sizes asked of the peer as RX errors changed")   \
+    X(fec_corrected, "Received bytes repaired by forward error correction")         \
+    X(fec_failures, "Frames with more errors than forward error correction repairs")
+
+/* Number of histogram buckets. Bucket n counts durations of [2^n, 2^(n+1)) us, bucket 0 also counts 0 us */
+#define UART_IPC_STATS_HIST_BUCKETS 16
+
+struct uart_ipc_stats {
+#define UART_IPC_STATS_MEMBER(name, description) uint32_t name;
+    UART_IPC_STATS_COUNTERS(UART_IPC_STATS_MEMBER)
+#undef UART_IPC_STATS_MEMBER
+    uint32_t tx_latency[UART_IPC_STATS_HIST_BUCKETS];    // Time from queueing a message to the TX done event of its last frame
+    uint32_t rx_reassembly[UART_IPC_STATS_HIST_BUCKETS]; // Time from the first to the last frame of a received message
+};
+
+/**
+ * @brief Reads the statistics of a UART IPC service backend instance. Counters wrap around.
+ *
+ * @return 0 on success, -ENOTSUP if CONFIG_IPC_BACKEND_UART_STATS is disabled.
+ */
+int uart_ipc_stats_get(const struct device *instance, struct uart_ipc_stats *stats);
+
+/**
+ * @brief Clears the statistics of a UART IPC service backend instance.
+ *
+ * @return 0 on success, -ENOTSUP if CONFIG_IPC_BACKEND_UART_STATS is disabled.
+ */
+int uart_ipc_stats_reset(const struct device *instance);
+
+#endif /* UART_IPC_STATS_H_ */
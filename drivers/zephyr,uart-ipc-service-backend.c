@@ -4,94 +4,708 @@
 #include <sys/util.h>
 #include <zephyr/drivers/uart.h>
 #include <zephyr/ipc/ipc_service_backend.h>
+#include <zephyr/random/rand32.h>
 #include <zephyr/sys/byteorder.h>
-#include <zephyr/sys/crc.h>
+
+#include "uart_ipc_cobs.h"
+#include "uart_ipc_crc.h"
+#include "uart_ipc_fec.h"
+#include "uart_ipc_lz.h"
+#include "uart_ipc_stats.h"
 LOG_MODULE_REGISTER(IPC_BACKEND_UART, CONFIG_IPC_BACKEND_UART_LOG_LEVEL);
 
 #define DT_DRV_COMPAT zephyr_uart_ipc_service_backend
 
 static inline void uart_callback(const struct device *dev, struct uart_event *evt, void *user_data);  // Forward declaration for readability
+#ifdef CONFIG_IPC_BACKEND_UART_RX_THREAD
+static void rx_thread_entry(void *p1, void *p2, void *p3);
+#endif
+struct backend_endpoint;
+static int send_bind(const struct device *instance, struct backend_endpoint *endpoint, uint8_t type);
+static bool link_ready(const struct device *instance);
+static void link_announce(const struct device *instance);
+static void rate_open(const struct device *instance);
+static void receive_batch(const void *msg, size_t len, void *priv);
+
+/* Wire formats, selected per instance with the framing devicetree property */
+enum uart_ipc_framing {
+    UART_IPC_FRAMING_FIXED,  // Fixed size frames, padded to a full fragment
+    UART_IPC_FRAMING_COBS,   // Variable length COBS encoded frames terminated by a zero byte
+};
 
+/* Fixed size frame. The natural layout is the wire format */
 struct uart_ipc_frame {
     uint16_t total_data_length;  // Total length of the data in the transfer
     uint16_t frag_start;         // Offset of the fragment in the transfer
     uint8_t frag_len;            // Length of the fragment
     uint8_t frag[64];            // Data fragment
+    uint8_t addr;                // Address of the sending endpoint
+    uint8_t credit_count;        // Flow control, as in struct uart_ipc_credit_header. 0 without flow control
+    uint8_t credit_limit;
     uint32_t crc;                // crc32-ieee for the frame
-} __packed__;
+};
+
+#define FRAME_FRAG_SIZE sizeof(((struct uart_ipc_frame *)0)->frag)
+
+/* Header of a COBS frame. It is followed by the fragment and a crc of header and fragment */
+struct uart_ipc_cobs_header {
+    uint8_t flags;               // COBS_FLAG_* bits, unused bits must be 0
+    uint8_t addr;                // Address of the sending endpoint
+    uint16_t total_data_length;  // Total length of the data in the transfer
+    uint16_t frag_start;         // Offset of the fragment in the transfer
+} __packed;
+
+#define COBS_FLAG_CRC16 BIT(0)     // Frame ends with a CRC-16/CCITT instead of a crc32-ieee
+#define COBS_FLAG_ARQ BIT(1)       // Header is followed by struct uart_ipc_arq_header
+#define COBS_FLAG_NO_DATA BIT(2)   // Frame only carries link state, it has no sequence number or fragment
+#define COBS_FLAG_CREDIT BIT(3)    // Header is followed by struct uart_ipc_credit_header, after the ARQ header if present
+#define COBS_FLAG_COMPRESSED BIT(4)  // The fragment is part of a compressed message, set on every frame of the message
+
+/* Reliable mode extension of the COBS header */
+struct uart_ipc_arq_header {
+    uint8_t seq;    // Sequence number of the frame
+    uint8_t ack;    // Next sequence number expected from the peer, all earlier frames were received
+    uint32_t sack;  // Bit n is set if frame ack + 1 + n was received out of order
+} __packed;
+
+/* Credit based flow control state, carried by every frame when flow control is enabled */
+struct uart_ipc_credit_header {
+    uint8_t count;  // Number of data frames sent so far, including this one, modulo 256
+    uint8_t limit;  // The peer may send data frames as long as its count stays below this
+} __packed;
+
+/* Compressed messages start with this header, followed by the message compressed in the LZ4 block format */
+struct uart_ipc_compressed_header {
+    uint16_t len;  // Length of the message before compression, little endian
+} __packed;
+
+/* Frames without data are marked as flow control probes in the otherwise unused frag_start field */
+#define UART_IPC_CREDIT_PROBE 1
+
+#define COBS_CRC_SIZE(flags) (((flags) & COBS_FLAG_CRC16) ? sizeof(uint16_t) : sizeof(uint32_t))
+#define COBS_FRAME_MAX_LEN                                                                                              \
+    (sizeof(struct uart_ipc_cobs_header) + sizeof(struct uart_ipc_arq_header) + sizeof(struct uart_ipc_credit_header) + \
+     FRAME_FRAG_SIZE + sizeof(uint32_t))
+/* Largest encoded frame in any wire format, including parity bytes, the COBS code byte and delimiter */
+#define TX_FRAME_MAX_LEN (MAX(sizeof(struct uart_ipc_frame), COBS_FRAME_MAX_LEN + 2) + UART_IPC_FEC_PARITY_LEN)
+
+BUILD_ASSERT(COBS_FRAME_MAX_LEN + UART_IPC_FEC_PARITY_LEN <= COBS_IN_PLACE_MAX_LEN, "COBS frames must be encodable in place");
+BUILD_ASSERT(MAX(sizeof(struct uart_ipc_frame), COBS_FRAME_MAX_LEN) <= UART_IPC_FEC_MAX_LEN, "Frames must fit in one codeword");
+
+/* Fixed size frame as received, followed by its parity bytes when the instance uses forward error correction */
+struct uart_ipc_fec_frame {
+    struct uart_ipc_frame frame;
+    uint8_t parity[UART_IPC_FEC_PARITY_LEN];
+};
+
+/* Fields of a frame to be encoded */
+struct frame_info {
+    uint8_t flags;  // COBS_FLAG_* except COBS_FLAG_CRC16, the crc type is chosen by the encoder
+    uint8_t addr;
+    uint16_t total_data_length;
+    uint16_t frag_start;
+    const uint8_t *frag;
+    size_t frag_len;
+    struct uart_ipc_arq_header arq;        // Sent with COBS_FLAG_ARQ, sack in little endian
+    struct uart_ipc_credit_header credit;  // Sent with COBS_FLAG_CREDIT
+};
+
+/* Address of the link control channel. Endpoints are addressed by their index in the endpoint table, below the
+ * reserved addresses */
+#define UART_IPC_ADDR_CONTROL 0xFF
+/* Address of batches of coalesced messages of TX priority level 0. Each level sends its batches to its own address
+ * above it, so that batches of several frames preempting each other are reassembled apart */
+#define UART_IPC_ADDR_BATCH 0xF5
+#define UART_IPC_BATCH_LEVELS 8
+/* Address of link management frames. They bypass reliable mode and flow control, so that a restarted peer is reachable */
+#define UART_IPC_ADDR_LINK 0xFD
+
+/* Version of the link protocol, sent in every hello. The link does not come up with a peer of another version */
+#define UART_IPC_PROTOCOL_VERSION 4
+
+/* Link management frames start with this header, followed by the message of the type */
+struct uart_ipc_link_header {
+    uint8_t type;  // enum uart_ipc_link_type
+} __packed;
+
+/* Link management messages. Each is sent in a single frame, ahead of any other frame, lowest type first */
+enum uart_ipc_link_type {
+    UART_IPC_LINK_HELLO = 0,      // struct uart_ipc_hello
+    UART_IPC_LINK_RATE_REQ = 1,   // struct uart_ipc_rate. The leader asks to try a faster baud rate
+    UART_IPC_LINK_RATE_ACK = 2,   // struct uart_ipc_rate. Answer to RATE_REQ, both sides switch once it has been sent
+    UART_IPC_LINK_RATE_TEST = 3,  // struct uart_ipc_rate and the test pattern, sent at the new rate. Echoed by the follower
+    UART_IPC_LINK_RATE_DONE = 4,  // struct uart_ipc_rate. The leader settled on a baud rate
+    UART_IPC_LINK_FRAG_SIZE = 5,  // struct uart_ipc_frag_size. The receiver asks for another fragment size
+    UART_IPC_LINK_TYPE_COUNT,
+};
+
+/* Link handshake message. Multi byte fields are little endian */
+struct uart_ipc_hello {
+    uint8_t version;        // UART_IPC_PROTOCOL_VERSION
+    uint8_t capabilities;   // UART_IPC_CAP_* bits, both sides must have the same
+    uint8_t flags;          // UART_IPC_HELLO_FLAG_* bits
+    uint8_t frag_size;      // Largest fragment the sender sends, both sides send the smaller of the two
+    uint32_t session;       // Random id picked when the instance was opened, never 0
+    uint32_t peer_session;  // Session of the last hello received from the peer, 0 if none
+} __packed;
+
+#define UART_IPC_HELLO_FLAG_UP BIT(0)     // The link is up on the sender. Hellos without it are answered
+#define UART_IPC_HELLO_FLAG_RATES BIT(1)  // The sender has baud rates to step up to
+
+/* Baud rate negotiation message. Multi byte fields are little endian */
+struct uart_ipc_rate {
+    uint32_t baudrate;  // Rate the message is about
+    uint8_t accepted;   // RATE_ACK: the follower switches to the rate, 0 otherwise
+} __packed;
+
+/* Fragment size the receiver of this message wants to receive, adapted to the error rate it sees */
+struct uart_ipc_frag_size {
+    uint8_t frag_size;  // Between UART_IPC_FRAG_MIN_SIZE and the size agreed in the hello exchange
+} __packed;
+
+#define UART_IPC_FRAG_MIN_SIZE 8   // Adaptive fragments do not shrink below this
+#define UART_IPC_FRAG_GROW_STEP 8  // Adaptive fragments grow by this after a window without errors
+
+/* Sent with every RATE_TEST. Mixes long runs, alternating bits and single edges, which fail first at a bad rate */
+static const uint8_t rate_test_pattern[] = {0x00, 0xFF, 0x55, 0xAA, 0x0F, 0xF0, 0x33, 0xCC,
+                                            0x01, 0x80, 0xFE, 0x7F, 0x5A, 0xA5, 0x00, 0xFF};
+
+BUILD_ASSERT(sizeof(struct uart_ipc_link_header) + MAX(sizeof(struct uart_ipc_hello), sizeof(struct uart_ipc_rate) + sizeof(rate_test_pattern)) <=
+                 FRAME_FRAG_SIZE,
+             "Link messages must fit in a single frame");
+
+#define UART_IPC_CAP_RELIABLE BIT(0)      // The instance has the reliable property
+#define UART_IPC_CAP_FLOW_CONTROL BIT(1)  // The instance has the flow_control property
+#define UART_IPC_CAP_FEC BIT(2)           // The instance has the fec property
+#define UART_IPC_CAP_PRIO_COUNT(n) (((n) - 1) << 3)  // CONFIG_IPC_BACKEND_UART_TX_PRIO_COUNT, in bits 3 to 5
+
+BUILD_ASSERT(UART_IPC_ADDR_BATCH + UART_IPC_BATCH_LEVELS == UART_IPC_ADDR_LINK, "Batch addresses overlap");
+BUILD_ASSERT(CONFIG_IPC_BACKEND_UART_TX_PRIO_COUNT <= UART_IPC_BATCH_LEVELS, "Every TX priority level needs a batch address");
+
+/* Messages on the control channel start with this header */
+struct uart_ipc_control_header {
+    uint8_t type;  // enum uart_ipc_control_type
+    uint8_t addr;  // Local address of the endpoint the message is about
+} __packed;
+
+enum uart_ipc_control_type {
+    UART_IPC_CONTROL_BIND_REQ = 1,  // Endpoint registered, followed by its name. Answered with BIND_RSP
+    UART_IPC_CONTROL_BIND_RSP = 2,  // Answer to BIND_REQ for an endpoint registered on both sides
+};
+
+/* Room before and after the data of a TX buffer for the header and trailer of a frame encoded in place */
+#define TX_BUF_HEADROOM (1 + sizeof(struct uart_ipc_cobs_header) + sizeof(struct uart_ipc_credit_header))
+#define TX_BUF_TAILROOM \
+    (sizeof(struct uart_ipc_frame) - offsetof(struct uart_ipc_frame, frag) - FRAME_FRAG_SIZE + UART_IPC_FEC_PARITY_LEN)
+
+BUILD_ASSERT(TX_BUF_HEADROOM >= offsetof(struct uart_ipc_frame, frag), "Fixed frame headers must fit in the headroom");
+BUILD_ASSERT(TX_BUF_TAILROOM >= sizeof(uint32_t) + UART_IPC_FEC_PARITY_LEN + 1, "COBS frame trailers must fit in the tailroom");
+
+/**
+ * @brief Preallocated TX buffer holding an outgoing message. Frames are encoded from it one at a time while
+ * sending. Without reliable mode the last frame of the message is encoded in place around its fragment, so a
+ * message of a single fragment is sent without being copied.
+ */
+struct uart_ipc_tx_buf {
+    uint8_t __aligned(4) head[TX_BUF_HEADROOM];
+    uint8_t data[CONFIG_IPC_BACKEND_UART_TX_BUF_FRAMES * FRAME_FRAG_SIZE];
+    uint8_t tail[TX_BUF_TAILROOM];
+};
+
+/* Record in a batch of coalesced messages, followed by the message */
+struct uart_ipc_batch_record {
+    uint8_t addr;  // Address of the sending endpoint
+    uint8_t len;   // Length of the message
+} __packed;
+
+/* Batch of small messages being coalesced, sent as one message to the batch address of its priority level */
+struct tx_batch {
+    struct uart_ipc_tx_buf *buf;  // NULL if no batch is open
+    size_t len;                   // Bytes of records in buf
+    uint32_t opened_at;           // Cycle count when the batch was opened
+};
+
+/* Completion of a message framed straight from the buffer of its sender */
+struct tx_done {
+    struct k_sem sem;  // Given once the last fragment has been framed or the message was dropped
+    int result;        // 0 if every fragment was framed, -ECONNRESET if the message was dropped
+};
+
+/* Message waiting in the TX queue */
+struct tx_request {
+    const uint8_t *data;
+    size_t len;
+    size_t sent;                       // Bytes of data already framed
+    uint8_t flags;                     // COBS_FLAG_COMPRESSED if data holds a compressed message
+    struct uart_ipc_tx_buf *pool_buf;  // Owning pool buffer, NULL if the data is the buffer of the sender
+    struct tx_done *done;              // Completed once the message has been framed, if the data belongs to the sender
+    struct backend_endpoint *endpoint;
+    uint32_t queued_at;                // Cycle count when the message was sent, for the TX latency statistics
+};
+
+/* Encoded frame. The next frame is encoded into a second buffer while one is on the line */
+struct tx_frame_buf {
+    uint8_t __aligned(4) data[TX_FRAME_MAX_LEN];
+    uint8_t *encoded;                   // Start of the frame, data or a frame encoded in place in pool_buf
+    size_t len;                         // Bytes to transmit, 0 if the buffer is free
+    struct uart_ipc_tx_buf *pool_buf;   // TX buffer the frame was encoded in, freed with the frame. NULL if none
+    struct tx_request *request;         // Message continuing after this frame, dropped with it. NULL if it was the last frame
+    struct backend_endpoint *endpoint;  // Endpoint notified if the frame is aborted, NULL in reliable mode
+    bool follows_prev;                  // Continues the message of the frame encoded before it
+#ifdef CONFIG_IPC_BACKEND_UART_STATS
+    uint32_t queued_at;                 // Queue time of the message, if this is the first transmission of its last frame
+    bool timed;
+#endif
+};
+
+/* Steps of a baud rate change. Data frames are held while a change is in progress */
+enum rate_step {
+    RATE_IDLE,       // Running at rate
+    RATE_REQUESTED,  // Leader: RATE_REQ sent, waiting for RATE_ACK
+    RATE_SWITCHING,  // Trial accepted, waiting for the frames sent at the old rate to leave
+    RATE_TESTING,    // Switched to trial, exchanging the test pattern
+    RATE_FALLBACK,   // Too many RX errors at rate, returning to the default rate
+};
+
+/**
+ * @brief Baud rate negotiation state of an instance. Once the link is up, the side with the larger session
+ * leads: it steps up through the candidate rates one at a time, and both sides keep a rate only if the test
+ * pattern made it through in both directions.
+ */
+struct rate_state {
+    struct k_spinlock lock;      // Protects everything below
+    uint32_t default_rate;       // Rate the UART was opened with, the rate both sides start from. 0 if unknown
+    uint32_t rate;               // Rate the link runs at
+    uint32_t trial;              // Rate being tried
+    uint32_t tried;              // Highest rate tried since the link came up
+    uint32_t ceiling;            // Lowest rate that failed, only lower rates are tried
+    uint32_t ack_rate;           // Content of the next RATE_ACK
+    bool ack_accepted;
+    bool negotiating;            // Stepping up after the link came up. Endpoints are announced once done
+    enum rate_step step;
+    uint32_t errors;             // RX errors in the current window
+    uint32_t errors_since;       // Uptime in ms at the start of the window
+    struct k_work_delayable work;  // Switches rates and times out steps
+};
+
+/**
+ * @brief Fragment size asked of the peer by an instance with adaptive fragments. Received frames are counted in
+ * windows of CONFIG_IPC_BACKEND_UART_FRAG_WINDOW frames: a window with many corrupted frames halves the size, so
+ * that less is lost per corrupted frame, and a window without any grows it, so that less is spent on headers.
+ * Only used from the RX context.
+ */
+struct frag_state {
+    uint8_t rx_size;         // Fragment size last asked of the peer
+    uint8_t rx_largest;      // Largest fragment received in the current window
+    uint16_t window_frames;  // Frames received in the current window, including corrupted ones
+    uint16_t window_errors;  // Corrupted and malformed frames in the current window
+};
+
+#define ARQ_WINDOW CONFIG_IPC_BACKEND_UART_ARQ_WINDOW
+
+BUILD_ASSERT(IS_POWER_OF_TWO(ARQ_WINDOW) && ARQ_WINDOW <= 32, "The reliable mode window must be a power of two of at most 32");
+
+/* Fragment kept for retransmission or in-order delivery in reliable mode */
+struct arq_frame {
+    uint8_t flags;  // COBS_FLAG_COMPRESSED of the message
+    uint8_t addr;
+    uint16_t total_data_length;
+    uint16_t frag_start;
+    uint8_t frag_len;
+    uint8_t frag[FRAME_FRAG_SIZE];
+};
+
+struct arq_tx_slot {
+    struct arq_frame frame;
+    bool acked;
+    bool retransmit;          // Waiting to be sent again
+    bool fast_retransmitted;  // Already resent because the peer reported it missing
+};
+
+/* Reliable mode state of an instance. Sequence numbers wrap at 256 */
+struct arq_state {
+    const struct device *instance;
+    struct k_spinlock lock;                  // Protects everything below except rx_frames
+    struct arq_tx_slot tx[ARQ_WINDOW];       // Sent frames, indexed by sequence number modulo the window
+    uint8_t tx_base;                         // Oldest unacknowledged sequence number
+    uint8_t tx_next;                         // Sequence number of the next new frame
+    uint8_t timeouts;                        // Retransmission timeouts since the peer last acknowledged a frame
+    uint8_t rx_expected;                     // Next sequence number to deliver
+    uint32_t rx_sack;                        // Frames received ahead of rx_expected, as in struct uart_ipc_arq_header
+    bool ack_due;                            // Received frames have not been acknowledged yet
+    bool ack_delay_expired;                  // Nothing picked up the acknowledgement in time, send it on its own
+    struct arq_frame rx_frames[ARQ_WINDOW];  // Frames received out of order. Only used from the RX context
+    struct k_work_delayable ack_work;
+    struct k_work_delayable rto_work;
+};
 
 struct backend_endpoint {
     struct ipc_ept_cfg cfg;
+    const struct device *instance;
+    uint8_t addr;                // Local address, sent in every frame from this endpoint
+    uint8_t remote_addr;         // Address of the peer endpoint with the same name, valid once bound
+    uint8_t tx_prio;             // TX priority level, 0 is the most urgent
     bool is_registered;
-    bool hold_rx_buf;
+    bool is_bound;
+    bool hold_rx_buf;            // Set when the buffer being delivered is held by the receiver
+    atomic_ptr_t held_rx_bufs[CONFIG_IPC_BACKEND_UART_RX_HOLD_COUNT]; // Held buffers not yet released, NULL if free
     uint8_t *rx_buffer;
     size_t rx_buf_size;
+    bool rx_compressed;          // The transfer being reassembled is a compressed message
     size_t bytes_received;
+    uint32_t rx_started_at;      // Cycle count when the first frame of the transfer arrived
     struct k_work_delayable rx_timeout_work;
+    atomic_t rx_timed_out;       // Set by the timeout work for the RX thread to drop the transfer
+};
+
+#ifdef CONFIG_IPC_BACKEND_UART_RX_THREAD
+BUILD_ASSERT(IS_POWER_OF_TWO(CONFIG_IPC_BACKEND_UART_RX_RING_SIZE), "RX ring size must be a power of two");
+
+/* Received data handed from the UART callback to the RX thread */
+struct rx_chunk {
+    uint8_t *buf;   // RX buffer holding the data
+    size_t offset;  // Offset of the data in buf
+    size_t len;     // Length of the data, 0 if buf was released by the UART and can be freed
 };
+#endif
+
+#ifdef CONFIG_IPC_BACKEND_UART_STATS
+enum stats_counter {
+#define STATS_COUNTER_ENUM(name, description) STATS_##name,
+    UART_IPC_STATS_COUNTERS(STATS_COUNTER_ENUM)
+#undef STATS_COUNTER_ENUM
+    STATS_COUNTER_COUNT,
+};
+
+/* Link statistics, updated lock free from any context */
+struct backend_stats {
+    atomic_t counters[STATS_COUNTER_COUNT];
+    atomic_t tx_latency[UART_IPC_STATS_HIST_BUCKETS];
+    atomic_t rx_reassembly[UART_IPC_STATS_HIST_BUCKETS];
+};
+
+#define STATS_ADD(instance_data, name, value) atomic_add(&(instance_data)->stats.counters[STATS_##name], (value))
+#define STATS_TIMESTAMP() k_cycle_get_32()
+#else
+#define STATS_ADD(instance_data, name, value) ((void)(instance_data))
+#define STATS_TIMESTAMP() 0
+#endif
+#define STATS_INC(instance_data, name) STATS_ADD(instance_data, name, 1)
 
 struct backend_data {
-    struct backend_endpoint endpoint;
+    struct backend_endpoint control;  // Link control channel, not visible to the IPC service
+    /* Receive the batches of coalesced messages of each priority level, not visible to the IPC service */
+    struct backend_endpoint batches[CONFIG_IPC_BACKEND_UART_TX_PRIO_COUNT];
     bool is_opened;
-    struct k_mem_slab rx_slab;
+    uint32_t link_session;               // Random id of this opening of the instance, sent in every hello
+    uint32_t link_peer_session;          // Session of the peer as of its last hello, 0 before the first one
+    atomic_t link_up;                    // The peer has echoed the local session, endpoints are announced
+    atomic_t link_due;                   // BIT(enum uart_ipc_link_type) of the link messages to send ahead of any other frame
+    struct k_work_delayable hello_work;  // Repeats the hello until the link is up, then the announcements of unbound endpoints
+    struct rate_state rate;
+    uint8_t frag_max;                    // Largest fragment either side sends, agreed in the hello exchange
+    uint8_t tx_frag_size;                // Largest fragment sent, at most frag_max. Adapted when the peer asks
+    struct frag_state frag;
+    struct uart_ipc_fec_frame fixed_rx;           // Fixed size frame being received
+    size_t fixed_rx_len;
+    bool rx_resyncing;                            // Frame alignment was lost, searching for the next frame
+    uint8_t cobs_rx_buf[COBS_FRAME_MAX_LEN + UART_IPC_FEC_PARITY_LEN + 1];  // Encoded COBS frame being received
+    size_t cobs_rx_len;
+    bool cobs_rx_overflow;                        // Discarding bytes until the next delimiter
+    struct k_mem_slab *rx_slab;
     k_timeout_t rx_timeout;
-    uint8_t *tx_buffer;
-    struct k_work free_tx_work;
-    struct k_sem tx_semaphore;
+    struct k_mem_slab *tx_slab;
+    struct k_msgq tx_queues[CONFIG_IPC_BACKEND_UART_TX_PRIO_COUNT];     // One queue per priority level
+    struct tx_request tx_active[CONFIG_IPC_BACKEND_UART_TX_PRIO_COUNT];  // Partially sent message per level, data is NULL if none
+    struct tx_frame_buf tx_frames[2];  // The frame on the line and the frame encoded to follow it
+    uint8_t tx_line;                   // Index of the frame on the line
+    atomic_t tx_busy;                  // Set while a frame is on the line
+    atomic_t tx_drop_partial;          // The peer restarted, partially sent messages are dropped before the next frame
+    struct tx_batch tx_batches[CONFIG_IPC_BACKEND_UART_TX_PRIO_COUNT];  // Open batch per priority level
+    struct k_spinlock tx_batch_lock;                                    // Protects tx_batches
+    struct k_work_delayable tx_batch_work;                              // Queues open batches once the window has passed
+    struct k_spinlock credit_lock;  // Protects the credit counts and limits, used by the RX and TX paths
+    uint8_t tx_credit_count;        // Data frames sent, modulo 256
+    uint8_t tx_credit_limit;        // Data frames may be sent while tx_credit_count is below this
+    uint8_t rx_credit_count;        // Data frames sent by the peer, as of the last frame processed
+    uint8_t rx_credit_limit;        // Last limit advertised to the peer
+    atomic_t credit_due;      // The peer used up enough credit or asked for an update, advertise a new limit
+    atomic_t credit_probe;    // Out of credit for a while, ask the peer for an update
+    struct k_work_delayable credit_probe_work;
+#ifdef CONFIG_IPC_BACKEND_UART_RX_THREAD
+    struct rx_chunk rx_ring[CONFIG_IPC_BACKEND_UART_RX_RING_SIZE];  // Single producer, single consumer
+    atomic_t rx_ring_head;  // Only written by the UART callback
+    atomic_t rx_ring_tail;  // Only written by the RX thread
+    struct k_sem rx_sem;    // Signals new chunks or a timed out transfer to the RX thread
+    struct k_thread rx_thread;
+#endif
+#ifdef CONFIG_IPC_BACKEND_UART_STATS
+    struct backend_stats stats;
+#endif
 };
 
 struct backend_config {
     const struct device *uart_dev;
     int64_t rx_timeout_usec;
+    struct k_mem_slab *rx_slab;          // rx_buffer_count DMA buffers of rx_buffer_size bytes
+    int32_t rx_inactivity_timeout_usec;  // Idle time before received bytes are handed over
+    struct backend_endpoint *endpoints;  // max_endpoint_count entries
+    size_t endpoint_count;
+    char *endpoint_names;                // max_endpoint_count names of max_endpoint_name_length characters
+    size_t endpoint_name_len;
+    struct k_mem_slab *tx_slab;
+    char *tx_queue_buf;  // CONFIG_IPC_BACKEND_UART_TX_PRIO_COUNT queues of CONFIG_IPC_BACKEND_UART_TX_QUEUE_SIZE requests
+    enum uart_ipc_framing framing;
+    struct arq_state *arq;  // Reliable mode state, NULL if the instance is not reliable
+    bool flow_control;      // Credit based flow control
+    uint8_t rx_credits;     // Data frames the peer may send ahead of the frames processed here
+    bool hw_flow_control;   // The UART has RTS/CTS flow control
+    uint32_t coalesce_window_usec;  // Longest time a message waits in a batch, 0 disables coalescing
+    size_t coalesce_threshold;      // Batches are queued once they hold this many bytes
+    bool compression;               // Messages are compressed when that makes them smaller
+    const uint32_t *baud_rates;     // Rates to step up to once the link is up
+    size_t baud_rate_count;
+    uint8_t frag_size;              // Largest fragment sent, at most FRAME_FRAG_SIZE
+    bool adaptive_frag;             // The peer is asked for smaller fragments when frames get corrupted
+    bool fec;                       // Frames carry Reed-Solomon parity, receivers repair corrupted bytes
+    struct k_mem_slab *rx_msg_pool;  // Reassembly buffers with CONFIG_IPC_BACKEND_UART_STATIC_ALLOC, NULL otherwise
+#ifdef CONFIG_IPC_BACKEND_UART_RX_THREAD
+    k_thread_stack_t *rx_stack;
+#endif
 };
 
-static void endpoint_rx_timeout_handler(struct k_work *work) {
-    struct backend_endpoint *ept = CONTAINER_OF(work, struct backend_endpoint, rx_timeout_work);
-    unsigned int key = irq_lock();  // Prevent RX from writing to buffer after it is freed
-    k_free(ept->rx_buffer);
+/* Reports a link level error to every registered endpoint */
+static void report_error(const struct device *instance, const char *message) {
+    const struct backend_config *config = instance->config;
+
+    for (size_t i = 0; i < config->endpoint_count; ++i) {
+        struct backend_endpoint *endpoint = &config->endpoints[i];
+        if (endpoint->is_registered && endpoint->cfg.cb.error != NULL) {
+            endpoint->cfg.cb.error(message, endpoint->cfg.priv);
+        }
+    }
+}
+
+#ifdef CONFIG_IPC_BACKEND_UART_STATS
+/* Counts the time since a cycle count in the log2 microsecond bucket it falls in */
+static void stats_hist_add(atomic_t *hist, uint32_t since) {
+    uint32_t us = k_cyc_to_us_floor32(k_cycle_get_32() - since);
+    size_t bucket = us == 0 ? 0 : MIN(31 - __builtin_clz(us), UART_IPC_STATS_HIST_BUCKETS - 1);
+
+    atomic_inc(&hist[bucket]);
+}
+
+/* Raises the TX queue high water mark to the fill level of a queue */
+static void stats_queue_level(struct backend_data *instance_data, size_t prio) {
+    atomic_t *high_water = &instance_data->stats.counters[STATS_tx_queue_high_water];
+    atomic_val_t used = k_msgq_num_used_get(&instance_data->tx_queues[prio]);
+    atomic_val_t max;
+
+    do {
+        max = atomic_get(high_water);
+    } while (used > max && !atomic_cas(high_water, max, used));
+}
+
+/* Starts timing the TX latency of a message whose last frame has been encoded for its first transmission */
+static void stats_tx_last_frame(struct tx_frame_buf *frame, const struct tx_request *request) {
+    frame->queued_at = request->queued_at;
+    frame->timed = true;
+}
+
+/* Accounts for the end of a frame transmission, completing the TX latency of its message if it was the last frame */
+static void stats_tx_done(struct backend_data *instance_data, struct tx_frame_buf *frame, bool aborted) {
+    if (frame->timed && !aborted) {
+        stats_hist_add(instance_data->stats.tx_latency, frame->queued_at);
+    }
+    frame->timed = false;
+}
+
+/* Accounts for a completely reassembled transfer */
+static void stats_rx_done(struct backend_endpoint *endpoint) {
+    struct backend_data *instance_data = endpoint->instance->data;
+
+    stats_hist_add(instance_data->stats.rx_reassembly, endpoint->rx_started_at);
+}
+#else
+#define stats_queue_level(instance_data, prio) ((void)0)
+#define stats_tx_last_frame(frame, request) ((void)0)
+#define stats_tx_done(instance_data, frame, aborted) ((void)0)
+#define stats_rx_done(endpoint) ((void)0)
+#endif
+
+/**
+ * @brief Allocates a buffer for a whole message. Buffers come from the heap, or with
+ * CONFIG_IPC_BACKEND_UART_STATIC_ALLOC from a pool of max_message_size buffers of the instance, which is also
+ * safe in the UART callback.
+ *
+ * @param pool Pool of the instance, unused without CONFIG_IPC_BACKEND_UART_STATIC_ALLOC
+ * @return The buffer, or NULL if no memory is left. Callers check with msg_fits that the message fits in a
+ * pool buffer first, as a larger message is not an allocation failure.
+ */
+static void *msg_alloc(struct k_mem_slab *pool, size_t len) {
+#ifdef CONFIG_IPC_BACKEND_UART_STATIC_ALLOC
+    void *buf;
+    if (k_mem_slab_alloc(pool, &buf, K_NO_WAIT) != 0) {
+        return NULL;
+    }
+    return buf;
+#else
+    return k_malloc(len);
+#endif
+}
+
+/* A message of len bytes fits in a buffer from msg_alloc. Always true without CONFIG_IPC_BACKEND_UART_STATIC_ALLOC */
+static bool msg_fits(const struct k_mem_slab *pool, size_t len) {
+#ifdef CONFIG_IPC_BACKEND_UART_STATIC_ALLOC
+    return len <= pool->block_size;
+#else
+    return true;
+#endif
+}
+
+/* Returns a buffer allocated with msg_alloc */
+static void msg_free(struct k_mem_slab *pool, const void *buf) {
+#ifdef CONFIG_IPC_BACKEND_UART_STATIC_ALLOC
+    k_mem_slab_free(pool, (void **)&buf);
+#else
+    k_free((void *)buf);
+#endif
+}
+
+/* Pool of reassembly buffers of the instance an endpoint belongs to */
+static inline struct k_mem_slab *rx_msg_pool(const struct backend_endpoint *ept) {
+    return ((const struct backend_config *)ept->instance->config)->rx_msg_pool;
+}
+
+/**
+ * @brief Drops the transfer being reassembled by an endpoint. Must not race with reception.
+ *
+ * @return true if a transfer was dropped, false if it completed after the timeout fired.
+ */
+static bool endpoint_rx_drop(struct backend_endpoint *ept) {
+    if (ept->rx_buffer == NULL) {
+        return false;
+    }
+    msg_free(rx_msg_pool(ept), ept->rx_buffer);
     ept->rx_buffer = NULL;
     ept->bytes_received = 0;
     ept->rx_buf_size = 0;
-    irq_unlock(key);
+    return true;
+}
+
+/* Drops the transfer being reassembled by an endpoint and its timeout. Only called from the RX context */
+static void endpoint_rx_reset(struct backend_endpoint *ept) {
+    k_work_cancel_delayable(&ept->rx_timeout_work);
+    atomic_clear(&ept->rx_timed_out);
+    endpoint_rx_drop(ept);
+}
 
+static void endpoint_rx_timed_out(struct backend_endpoint *ept) {
+    STATS_INC((struct backend_data *)ept->instance->data, rx_timeouts);
     if (ept->cfg.cb.error) {
         ept->cfg.cb.error("Transfer timed out waiting for next frame", ept->cfg.priv);
     }
 }
 
+static void endpoint_rx_timeout_handler(struct k_work *work) {
+    struct k_work_delayable *dwork = k_work_delayable_from_work(work);
+    struct backend_endpoint *ept = CONTAINER_OF(dwork, struct backend_endpoint, rx_timeout_work);
+
+#ifdef CONFIG_IPC_BACKEND_UART_RX_THREAD
+    /* Reassembly runs in the RX thread, which this work may preempt. Let the thread drop the transfer */
+    struct backend_data *data = ept->instance->data;
+    atomic_set(&ept->rx_timed_out, 1);
+    k_sem_give(&data->rx_sem);
+#else
+    unsigned int key = irq_lock();  // Prevent RX from writing to buffer after it is freed
+    bool dropped = endpoint_rx_drop(ept);
+    irq_unlock(key);
+
+    if (dropped) {
+        endpoint_rx_timed_out(ept);
+    }
+#endif
+}
+
+static void endpoint_init(struct backend_endpoint *endpoint, const struct device *instance, uint8_t addr) {
+    memset(endpoint, 0, sizeof(*endpoint));
+    endpoint->instance = instance;
+    endpoint->addr = addr;
+    k_work_init_delayable(&endpoint->rx_timeout_work, endpoint_rx_timeout_handler);
+}
+
+/**
+ * @brief Registers an endpoint in the first free slot of the endpoint table. The endpoint is bound once the
+ * peer has registered an endpoint with the same name.
+ *
+ * @return 0 on success, -EALREADY if the name is taken, -EINVAL if the name is too long, -ENOMEM if all
+ * max_endpoint_count endpoints are registered.
+ */
 static int register_endpoint(const struct device *instance, void **token, const struct ipc_ept_cfg *cfg) {
-    if (instance == NULL || token == NULL || cfg == NULL) {
+    if (instance == NULL || token == NULL || cfg == NULL || cfg->name == NULL) {
         LOG_ERR("One or more arguments are NULL");
         return -EINVAL;
     }
 
+    const struct backend_config *config = instance->config;
     struct backend_data *data = instance->data;
 
-    if (data->endpoint.is_registered) {
-        LOG_ERR("Endpoint \"%s\" already registered", data->endpoint.cfg.name);
-        return -EALREADY;
+    if (strlen(cfg->name) > config->endpoint_name_len) {
+        LOG_ERR("Endpoint name \"%s\" is longer than %d characters", cfg->name, config->endpoint_name_len);
+        return -EINVAL;
     }
 
-    data->endpoint.cfg = *cfg;
-    char *name_buf = k_malloc(strlen(cfg->name) + 1);
-    if (name_buf == NULL) {
-        LOG_ERR("Failed to allocate memory for endpoint name");
+    struct backend_endpoint *endpoint = NULL;
+    for (size_t i = 0; i < config->endpoint_count; ++i) {
+        struct backend_endpoint *candidate = &config->endpoints[i];
+        if (!candidate->is_registered) {
+            endpoint = endpoint == NULL ? candidate : endpoint;
+        } else if (strcmp(candidate->cfg.name, cfg->name) == 0) {
+            LOG_ERR("Endpoint \"%s\" already registered", cfg->name);
+            return -EALREADY;
+        }
+    }
+
+    if (endpoint == NULL) {
+        LOG_ERR("All %d endpoints are registered", config->endpoint_count);
         return -ENOMEM;
     }
+
+    uint8_t addr = endpoint - config->endpoints;
+    char *name_buf = config->endpoint_names + addr * (config->endpoint_name_len + 1);
     strcpy(name_buf, cfg->name);
-    data->endpoint.cfg.name = name_buf;
-    data->endpoint.is_registered = true;
 
-    if (data->endpoint.cfg.cb.bound != NULL) {
-        data->endpoint.cfg.cb.bound(data->endpoint.cfg.priv);
-    }
+    endpoint_init(endpoint, instance, addr);
+    endpoint->cfg = *cfg;
+    endpoint->cfg.name = name_buf;
+    endpoint->tx_prio = CLAMP(cfg->prio, 0, CONFIG_IPC_BACKEND_UART_TX_PRIO_COUNT - 1);
+    endpoint->is_registered = true;
 
-    k_work_init_delayable(&data->endpoint.rx_timeout_work, endpoint_rx_timeout_handler);
+    *token = endpoint;
 
-    *token = &data->endpoint;
+    if (link_ready(instance)) {
+        link_announce(instance);
+    }
     return 0;
 }
 
+/* Makes sure RTS/CTS flow control is on when the devicetree node of the UART asks for it */
+static void enable_hw_flow_control(const struct device *uart_dev) {
+    struct uart_config uart_cfg;
+
+    int err = uart_config_get(uart_dev, &uart_cfg);
+    if (err == 0 && uart_cfg.flow_ctrl != UART_CFG_FLOW_CTRL_RTS_CTS) {
+        uart_cfg.flow_ctrl = UART_CFG_FLOW_CTRL_RTS_CTS;
+        err = uart_configure(uart_dev, &uart_cfg);
+    }
+
+    if (err) {
+        LOG_WRN("Could not enable RTS/CTS flow control %d", err);
+    } else {
+        LOG_DBG("RTS/CTS flow control enabled");
+    }
+}
+
 static int open_instance(const struct device *instance) {
     const struct backend_config *config = instance->config;
     struct backend_data *data = instance->data;
@@ -102,36 +716,28 @@ static int open_instance(const struct device *instance) {
         return -EALREADY;
     }
 
-    int err = 0;
-
-    uint8_t *rx_slab_buffer = k_malloc(2 * sizeof(struct uart_ipc_frame));
-    if (rx_slab_buffer == NULL) {
-        LOG_ERR("Failed to allocate memory for rx slab buffer %d", err);
-        err = -ENOMEM;
-        goto rx_slab_buffer_alloc_failed;
-    }
-
-    err = k_mem_slab_init(&data->rx_slab, rx_slab_buffer, ROUND_UP(sizeof(struct uart_ipc_frame), 4), 2);
-    if (err) {
-        LOG_ERR("Failed to initialize rx slab %d", err);
-        goto rx_slab_init_failed;
-    }
-
     void *initial_buf = NULL;
-    err = k_mem_slab_alloc(&(data->rx_slab), &initial_buf, K_NO_WAIT);
+    int err = k_mem_slab_alloc(data->rx_slab, &initial_buf, K_NO_WAIT);
     if (err) {
         LOG_ERR("Failed to allocate initial buffer from rx slab %d", err);
         goto init_buf_alloc_failed;
     }
 
+    if (config->hw_flow_control) {
+        enable_hw_flow_control(uart_dev);
+    }
+    if (config->baud_rate_count > 0) {
+        rate_open(instance);
+    }
+
     err = uart_callback_set(uart_dev, uart_callback, (void *)instance);
     if (err) {
         LOG_ERR("Failed to set uart callback %d", err);
         goto callback_set_failed;
     }
 
-    err = uart_rx_enable(uart_dev, initial_buf, data->rx_slab.block_size, 100);
-    LOG_DBG("Set initial rx buffer <%p>. Size: %d bytes ", initial_buf, data->rx_slab.block_size);
+    err = uart_rx_enable(uart_dev, initial_buf, data->rx_slab->block_size, config->rx_inactivity_timeout_usec);
+    LOG_DBG("Set initial rx buffer <%p>. Size: %d bytes ", initial_buf, data->rx_slab->block_size);
     if (err == -EBUSY) {
         err = -EALREADY;
     }
@@ -142,309 +748,3092 @@ static int open_instance(const struct device *instance) {
     }
 
     data->is_opened = true;
+
+    /* Endpoints are announced once the peer has answered the hello */
+    do {
+        data->link_session = sys_rand32_get();
+    } while (data->link_session == 0);
+    k_work_schedule(&data->hello_work, K_NO_WAIT);
     return 0;
 
 // Cleanup in case of failure
 rx_enable_failed:
 callback_set_failed:
-    k_mem_slab_free(&data->rx_slab, &initial_buf);
+    k_mem_slab_free(data->rx_slab, &initial_buf);
 init_buf_alloc_failed:
-rx_slab_init_failed:
-    k_free((void *)rx_slab_buffer);
-rx_slab_buffer_alloc_failed:
     return err;
 }
 
 /**
- * @brief Packages the data into an array of frames. The returned array is suitable for passing to uart_tx.
- * The array is heap allocated and must eventually be freed.
+ * @brief Fills in the header and crc of a frame whose fragment has already been written.
  *
- * @param data Data to be packaged
- * @param len Length of the data
- * @param n_frames Number of frames in the returned array
- * @return struct uart_ipc_frame*
+ * @param frame Frame to finalize
+ * @param addr Address of the sending endpoint
+ * @param total_data_length Total length of the data in the transfer
+ * @param frag_start Offset of the fragment in the transfer
+ * @param frag_len Length of the fragment
  */
-static struct uart_ipc_frame *create_frames(const void *data, uint16_t len, size_t *n_frames) {
-    uint16_t max_frag_size = (uint8_t)sizeof(((struct uart_ipc_frame *)0)->frag);
-    uint16_t num_frames = (uint16_t)(len / max_frag_size);
-    if (len % max_frag_size != 0) {
-        num_frames++;
+static void finalize_frame(struct uart_ipc_frame *frame, uint8_t addr, uint16_t total_data_length, uint16_t frag_start, uint8_t frag_len) {
+    frame->addr = addr;
+    frame->total_data_length = sys_cpu_to_le16(total_data_length);
+    frame->frag_start = sys_cpu_to_le16(frag_start);
+    frame->frag_len = frag_len;
+    frame->crc = sys_cpu_to_le32(uart_ipc_crc32((uint8_t *)frame, sizeof(*frame) - sizeof(frame->crc)));
+}
+
+/**
+ * @brief Encodes a fixed size frame.
+ *
+ * @return Number of bytes in the frame
+ */
+static size_t encode_fixed_frame(struct uart_ipc_frame *frame, const struct frame_info *info) {
+    if (info->frag_len > 0 && info->frag != frame->frag) {
+        memcpy(frame->frag, info->frag, info->frag_len);
     }
-    struct uart_ipc_frame *frames = k_calloc(num_frames, sizeof(struct uart_ipc_frame));
-    if (frames == NULL) {
-        LOG_ERR("Failed to allocate %d bytes for %d frames", num_frames * sizeof(struct uart_ipc_frame), num_frames);
+    memset(frame->frag + info->frag_len, 0, FRAME_FRAG_SIZE - info->frag_len);
+    frame->credit_count = info->credit.count;
+    frame->credit_limit = info->credit.limit;
+    finalize_frame(frame, info->addr, info->total_data_length, info->frag_start, info->frag_len);
+    return sizeof(*frame);
+}
 
-        return NULL;
+/**
+ * @brief Encodes a COBS frame and terminates it with a delimiter. The frame is built one byte into the
+ * destination and then encoded in place.
+ *
+ * @param dest Destination, at least TX_FRAME_MAX_LEN bytes
+ * @param info Frame to encode
+ * @param fec Append parity bytes to the frame before encoding it
+ * @return Number of bytes in the encoded frame, including the delimiter
+ */
+static size_t encode_cobs_frame(uint8_t *dest, const struct frame_info *info, bool fec) {
+    uint8_t *frame = dest + 1;
+    struct uart_ipc_cobs_header *header = (struct uart_ipc_cobs_header *)frame;
+    size_t frame_len = sizeof(*header);
+
+    if (info->flags & COBS_FLAG_ARQ) {
+        memcpy(frame + frame_len, &info->arq, sizeof(info->arq));
+        frame_len += sizeof(info->arq);
+    }
+    if (info->flags & COBS_FLAG_CREDIT) {
+        memcpy(frame + frame_len, &info->credit, sizeof(info->credit));
+        frame_len += sizeof(info->credit);
+    }
+    if (info->frag_len > 0 && info->frag != frame + frame_len) {
+        memcpy(frame + frame_len, info->frag, info->frag_len);
+    }
+    frame_len += info->frag_len;
+
+    header->flags = info->flags | (frame_len <= CONFIG_IPC_BACKEND_UART_CRC16_MAX_FRAME_LEN ? COBS_FLAG_CRC16 : 0);
+    header->addr = info->addr;
+    header->total_data_length = sys_cpu_to_le16(info->total_data_length);
+    header->frag_start = sys_cpu_to_le16(info->frag_start);
+
+    if (header->flags & COBS_FLAG_CRC16) {
+        sys_put_le16(uart_ipc_crc16(frame, frame_len), frame + frame_len);
+    } else {
+        sys_put_le32(uart_ipc_crc32(frame, frame_len), frame + frame_len);
+    }
+    frame_len += COBS_CRC_SIZE(header->flags);
+    if (fec) {
+        uart_ipc_fec_encode(frame, frame_len, frame + frame_len);
+        frame_len += UART_IPC_FEC_PARITY_LEN;
+    }
+
+    size_t encoded_len = cobs_encode_in_place(dest, frame_len);
+    dest[encoded_len] = COBS_DELIMITER;
+    return encoded_len + 1;
+}
+
+/**
+ * @brief Encodes a frame in the wire format of the instance.
+ *
+ * @param dest Destination, at least TX_FRAME_MAX_LEN bytes and aligned for struct uart_ipc_frame. The fragment
+ *             is not copied if it is already where the frame places it, see tx_frame_in_place
+ * @return Number of bytes to transmit
+ */
+static size_t encode_frame(const struct backend_config *config, uint8_t *dest, const struct frame_info *info) {
+    if (config->framing == UART_IPC_FRAMING_COBS) {
+        return encode_cobs_frame(dest, info, config->fec);
     }
 
-    for (uint16_t i = 0; i < num_frames; ++i) {
-        uint16_t frag_start = i * max_frag_size;
-        uint8_t frag_len = MIN(max_frag_size, len - frag_start);
+    size_t len = encode_fixed_frame((struct uart_ipc_frame *)dest, info);
+    if (config->fec) {
+        uart_ipc_fec_encode(dest, len, dest + len);
+        len += UART_IPC_FEC_PARITY_LEN;
+    }
+    return len;
+}
 
-        frames[i].total_data_length = sys_cpu_to_le16(len);
-        frames[i].frag_start = sys_cpu_to_le16(frag_start);
-        frames[i].frag_len = frag_len;
-        memcpy(frames[i].frag, (uint8_t *)data + frag_start, frag_len);
-        frames[i].crc = sys_cpu_to_le32(crc32_ieee((uint8_t *)&frames[i], sizeof(frames[i]) - sizeof(frames[i].crc)));
+/* Cheap sanity check of a fixed frame header, used to find frame starts before paying for the crc */
+static inline bool frame_header_plausible(uint16_t total_data_length, uint16_t frag_start, uint8_t frag_len) {
+    if (frag_len == 0) {
+        return total_data_length == 0 && frag_start <= UART_IPC_CREDIT_PROBE;  // Frame without data
     }
+    return frag_len > 0 && frag_len <= FRAME_FRAG_SIZE && frag_start + frag_len <= total_data_length;
+}
 
-    *n_frames = num_frames;
+/**
+ * @brief Checks that a fixed size frame is intact.
+ *
+ * @return 0 if the frame is valid, -EBADMSG if it is corrupted or not aligned to a frame start.
+ */
+static int check_frame(const struct uart_ipc_frame *frame) {
+    if (!frame_header_plausible(sys_le16_to_cpu(frame->total_data_length), sys_le16_to_cpu(frame->frag_start), frame->frag_len)) {
+        return -EBADMSG;
+    }
 
-    return frames;
+    if (uart_ipc_crc32((uint8_t *)frame, sizeof(*frame) - sizeof(frame->crc)) != sys_le32_to_cpu(frame->crc)) {
+        LOG_ERR("CRC mismatch. Fragment is likely corrupted");
+        return -EBADMSG;
+    }
+    return 0;
 }
 
 /**
- * @brief Extracts data from a frame into a buffer. The buffer must be large enough to hold the complete
- *        data from the transaction.
+ * @brief Extracts data from a validated frame into a buffer. The buffer must be large enough to hold the
+ *        complete data from the transaction.
  *
  * @param dest_buf Buffer to hold received data
  * @param dest_buf_len Total size of the destination buffer
- * @param frame Frame to be unwrapped
+ * @param frame Frame to be unwrapped, already checked with check_frame
  * @param added_data_len Number of bytes added to the destination buffer. Does not account for overlapping frames or preexisting data.
- * @return 0 on success, negative errno on failure: -EINVAL if crc check fails. -ENOMEM if the fragment would overflow the destination buffer.
+ * @return 0 on success, negative errno on failure: -ENOMEM if the fragment would overflow the destination buffer.
  */
 static int unwrap_frame(void *dest_buf, size_t dest_buf_len, struct uart_ipc_frame *frame, size_t *added_data_len) {
-    uint32_t crc = crc32_ieee((uint8_t *)frame, sizeof(*frame) - sizeof(frame->crc));
-
-    struct uart_ipc_frame_header {
-        uint16_t total_data_length;
-        uint16_t frag_start;
-        uint8_t frag_len;
-        uint32_t crc;
-    } frame_hdr = { // Frame metadata converted to CPU endianness
-        .total_data_length = sys_le16_to_cpu(frame->total_data_length),
-        .frag_start = sys_le16_to_cpu(frame->frag_start),
-        .frag_len = frame->frag_len,
-        .crc = sys_le32_to_cpu(frame->crc),
-    };
-
-    if (crc != frame_hdr.crc) {
-        LOG_ERR("CRC mismatch. Fragment is likely corrupted");
-        return -EINVAL;
-    }
+    uint16_t frag_start = sys_le16_to_cpu(frame->frag_start);
 
-    if (frame_hdr.frag_start + frame_hdr.frag_len > dest_buf_len) {
+    if (frag_start + frame->frag_len > dest_buf_len) {
         LOG_ERR("Frame overflows destination buffer");
         return -ENOMEM;
     }
 
-    /*Uses frame instead of sys_end_frame to save on*/
-    memcpy((uint8_t *)dest_buf + frame_hdr.frag_start, frame->frag, (size_t)frame_hdr.frag_len);
+    memcpy((uint8_t *)dest_buf + frag_start, frame->frag, (size_t)frame->frag_len);
 
-    *added_data_len = frame_hdr.frag_len;
+    *added_data_len = frame->frag_len;
     return 0;
 }
 
-static int send(const struct device *instance, void *token, const void *data, size_t len) {
-    struct backend_data *instance_data = instance->data;
-    const struct backend_config *instance_config = instance->config;
-    struct backend_endpoint *endpoint = (struct backend_endpoint *)token;
+/**
+ * @brief Returns the TX buffer that owns a buffer handed out by get_tx_buffer.
+ *
+ * @return The owning buffer, or NULL if the pointer was not handed out by this instance.
+ */
+static struct uart_ipc_tx_buf *tx_buf_from_payload(const struct backend_config *config, const void *data) {
+    struct k_mem_slab *slab = config->tx_slab;
+    uint8_t *pool_start = (uint8_t *)slab->buffer;
+    uint8_t *pool_end = pool_start + slab->num_blocks * slab->block_size;
 
-    if (!instance_data->is_opened) {
-        LOG_ERR("UART backend not opened");
-        return -EIO;
+    if ((uint8_t *)data < pool_start || (uint8_t *)data >= pool_end) {
+        return NULL;
     }
 
-    if (k_sem_take(&instance_data->tx_semaphore, K_FOREVER) != 0) {
-        return -EBUSY;
+    size_t index = ((uint8_t *)data - pool_start) / slab->block_size;
+    return (struct uart_ipc_tx_buf *)(pool_start + index * slab->block_size);
+}
+
+/* Returns the data of a message that has been framed or dropped: frees its TX buffer, or wakes up its sender */
+static void tx_request_free(const struct device *instance, struct tx_request *request) {
+    struct backend_data *instance_data = instance->data;
+
+    if (request->pool_buf != NULL) {
+        k_mem_slab_free(instance_data->tx_slab, (void **)&request->pool_buf);
+    } else if (request->done != NULL) {
+        request->done->result = request->sent >= request->len ? 0 : -ECONNRESET;
+        k_sem_give(&request->done->sem);
     }
+    request->data = NULL;
+}
+
+/* Takes the next fragment of at most frag_size bytes of a message. The fragment points into the message data */
+static void tx_request_take_frame(struct tx_request *request, struct frame_info *info, size_t frag_size) {
+    info->flags |= request->flags;
+    info->addr = request->endpoint->addr;
+    info->total_data_length = request->len;
+    info->frag_start = request->sent;
+    info->frag = request->data + request->sent;
+    info->frag_len = MIN(frag_size, request->len - request->sent);
+    request->sent += info->frag_len;
+}
 
-    size_t n_frames;
-    struct uart_ipc_frame *frames = create_frames(data, len, &n_frames);
-    if (frames == NULL) {
-        if (endpoint->cfg.cb.error != NULL) {
-            endpoint->cfg.cb.error("Could not allocate memory for data frames", endpoint->cfg.priv);
+/**
+ * @brief Returns the message to send the next frame from, the partially sent or oldest queued message of the
+ * most urgent priority level. Only called while holding tx_busy.
+ *
+ * @return The message, or NULL if nothing is waiting to be sent.
+ */
+static struct tx_request *tx_next_request(struct backend_data *instance_data) {
+    for (size_t prio = 0; prio < CONFIG_IPC_BACKEND_UART_TX_PRIO_COUNT; ++prio) {
+        struct tx_request *active = &instance_data->tx_active[prio];
+        if (active->data != NULL || k_msgq_get(&instance_data->tx_queues[prio], active, K_NO_WAIT) == 0) {
+            return active;
         }
-        return -ENOMEM;
     }
-    int err = uart_tx(instance_config->uart_dev, (void *)frames, n_frames * sizeof(struct uart_ipc_frame), SYS_FOREVER_US);
-    if (err) {
-        LOG_ERR("UART TX failed %d", err);
-        if (endpoint->cfg.cb.error != NULL) {
-            endpoint->cfg.cb.error("UART TX failed", endpoint->cfg.priv);
+    return NULL;
+}
+
+/**
+ * @brief Drops the messages partially sent to a peer that has since restarted, as it cannot reassemble the rest
+ * of them. Only called while holding tx_busy.
+ *
+ * @param prev Frame on the line, NULL if the line is idle.
+ */
+static void tx_drop_partial(const struct device *instance, struct tx_frame_buf *prev) {
+    struct backend_data *instance_data = instance->data;
+
+    for (size_t prio = 0; prio < CONFIG_IPC_BACKEND_UART_TX_PRIO_COUNT; ++prio) {
+        struct tx_request *active = &instance_data->tx_active[prio];
+        if (active->data != NULL && active->sent > 0) {
+            if (prev != NULL && prev->request == active) {
+                prev->request = NULL;
+            }
+            tx_request_free(instance, active);
         }
-        k_free((void *)frames);
-        return err;
     }
-    instance_data->tx_buffer = (uint8_t *)frames;
-    return 0;
 }
 
-static void free_tx_work_handler(struct k_work *work_item) {
-    LOG_DBG("Freeing tx buffer");
-    struct backend_data *instance_data = CONTAINER_OF(work_item, struct backend_data, free_tx_work);
-    k_free((void *)instance_data->tx_buffer);
-    k_sem_give(&instance_data->tx_semaphore);
+static bool tx_pending(struct backend_data *instance_data) {
+    for (size_t prio = 0; prio < CONFIG_IPC_BACKEND_UART_TX_PRIO_COUNT; ++prio) {
+        if (instance_data->tx_active[prio].data != NULL || k_msgq_num_used_get(&instance_data->tx_queues[prio]) > 0) {
+            return true;
+        }
+    }
+    return false;
 }
 
-const static struct ipc_service_backend backend_ops = {
-    .open_instance = open_instance,
-    .register_endpoint = register_endpoint,
-    .send = send,
-};
+/* Slot of a sequence number in the reliable mode windows */
+static inline size_t arq_slot(uint8_t seq) {
+    return seq % ARQ_WINDOW;
+}
 
-static int backend_init(const struct device *dev) {
-    const struct backend_config *config = dev->config;
-    struct backend_data *data = dev->data;
-    data->is_opened = false;
+/* Data frames to send in reliable mode: retransmissions, or new frames while the window is open */
+static bool arq_data_pending(struct arq_state *arq, struct backend_data *instance_data) {
+    k_spinlock_key_t key = k_spin_lock(&arq->lock);
+    bool pending = (uint8_t)(arq->tx_next - arq->tx_base) < ARQ_WINDOW && tx_pending(instance_data);
 
-    if (!device_is_ready(config->uart_dev)) {
-        LOG_ERR("UART device %s is not ready", config->uart_dev->name);
-        return -ENODEV;
+    for (uint8_t seq = arq->tx_base; !pending && seq != arq->tx_next; ++seq) {
+        pending = arq->tx[arq_slot(seq)].retransmit;
     }
-    data->rx_timeout = K_USEC(config->rx_timeout_usec);
-
-    k_work_init(&data->free_tx_work, free_tx_work_handler);
-    k_sem_init(&data->tx_semaphore, 1, 1);
-    return 0;
+    k_spin_unlock(&arq->lock, key);
+    return pending;
 }
 
-static inline int receive_frame(struct backend_endpoint *endpoint, struct uart_ipc_frame *frame, k_timeout_t rx_timeout) {
-    if (endpoint->cfg.cb.received == NULL) {
-        LOG_INF("Received data but no receive callback registered");
-        return -EINVAL;
-    }
+/* A bare acknowledgement is due, as nothing picked it up within the acknowledgement delay */
+static bool arq_ack_pending(struct arq_state *arq) {
+    k_spinlock_key_t key = k_spin_lock(&arq->lock);
+    bool pending = arq->ack_due && arq->ack_delay_expired;
+    k_spin_unlock(&arq->lock, key);
+    return pending;
+}
 
-    if (!K_TIMEOUT_EQ(rx_timeout, K_FOREVER)) {
+/**
+ * @brief Takes the next data frame in reliable mode: the oldest frame waiting to be retransmitted, otherwise a
+ * new frame if the window is open. Only called while holding tx_busy.
+ *
+ * @param frame Buffer the frame will be encoded into, for the TX latency statistics.
+ *
+ * @return true if a frame was taken, false if there is nothing to send.
+ */
+static bool arq_take_frame(const struct device *instance, struct frame_info *info, struct tx_frame_buf *frame) {
+    const struct backend_config *config = instance->config;
+    struct backend_data *instance_data = instance->data;
+    struct arq_state *arq = config->arq;
+    struct arq_tx_slot *slot = NULL;
+
+    k_spinlock_key_t key = k_spin_lock(&arq->lock);
+    for (uint8_t seq = arq->tx_base; seq != arq->tx_next; ++seq) {
+        if (arq->tx[arq_slot(seq)].retransmit) {
+            slot = &arq->tx[arq_slot(seq)];
+            slot->retransmit = false;
+            info->arq.seq = seq;
+            STATS_INC(instance_data, retransmissions);
+            break;
+        }
+    }
+
+    struct tx_request *request;
+    if (slot == NULL && (uint8_t)(arq->tx_next - arq->tx_base) < ARQ_WINDOW && (request = tx_next_request(instance_data)) != NULL) {
+        struct frame_info frag = {0};
+        tx_request_take_frame(request, &frag, instance_data->tx_frag_size);
+
+        info->arq.seq = arq->tx_next++;
+        slot = &arq->tx[arq_slot(info->arq.seq)];
+        slot->frame.flags = frag.flags;
+        slot->frame.addr = frag.addr;
+        slot->frame.total_data_length = frag.total_data_length;
+        slot->frame.frag_start = frag.frag_start;
+        slot->frame.frag_len = frag.frag_len;
+        memcpy(slot->frame.frag, frag.frag, frag.frag_len);
+        slot->acked = false;
+        slot->retransmit = false;
+        slot->fast_retransmitted = false;
+
+        if (request->sent >= request->len) {
+            stats_tx_last_frame(frame, request);
+            tx_request_free(instance, request);
+        }
+    }
+    k_spin_unlock(&arq->lock, key);
+
+    if (slot == NULL) {
+        return false;
+    }
+
+    /* A slot is only reused after it has been acknowledged, so it can be read without the lock */
+    info->flags |= slot->frame.flags;
+    info->addr = slot->frame.addr;
+    info->total_data_length = slot->frame.total_data_length;
+    info->frag_start = slot->frame.frag_start;
+    info->frag = slot->frame.frag;
+    info->frag_len = slot->frame.frag_len;
+    k_work_schedule(&arq->rto_work, K_MSEC(CONFIG_IPC_BACKEND_UART_ARQ_RTO_MS));
+    return true;
+}
+
+/* Adds the current acknowledgement state to a frame. Every frame sent in reliable mode carries it */
+static void arq_add_ack(struct arq_state *arq, struct frame_info *info) {
+    info->flags |= COBS_FLAG_ARQ;
+
+    k_spinlock_key_t key = k_spin_lock(&arq->lock);
+    info->arq.ack = arq->rx_expected;
+    info->arq.sack = sys_cpu_to_le32(arq->rx_sack);
+    arq->ack_due = false;
+    arq->ack_delay_expired = false;
+    k_spin_unlock(&arq->lock, key);
+}
+
+/* The peer has credit left for another data frame */
+static bool credit_left(const struct device *instance) {
+    const struct backend_config *config = instance->config;
+    struct backend_data *instance_data = instance->data;
+
+    if (!config->flow_control) {
+        return true;
+    }
+    k_spinlock_key_t key = k_spin_lock(&instance_data->credit_lock);
+    bool left = (int8_t)(instance_data->tx_credit_limit - instance_data->tx_credit_count) > 0;
+    k_spin_unlock(&instance_data->credit_lock, key);
+    return left;
+}
+
+/**
+ * @brief Data frames the peer may send ahead of the frames processed here: at most rx_credits, and no more than
+ * the free RX buffers and, with CONFIG_IPC_BACKEND_UART_STATIC_ALLOC, the free reassembly buffers can take. One
+ * frame is always granted, as the RX buffer the UART is filling has room for it.
+ */
+static uint8_t credit_window(const struct device *instance) {
+    const struct backend_config *config = instance->config;
+    uint32_t frames_per_buf = MAX(config->rx_slab->block_size / TX_FRAME_MAX_LEN, 1);
+    uint32_t window = MIN(config->rx_credits, k_mem_slab_num_free_get(config->rx_slab) * frames_per_buf);
+
+#ifdef CONFIG_IPC_BACKEND_UART_STATIC_ALLOC
+    uint32_t frames_per_msg = DIV_ROUND_UP(config->rx_msg_pool->block_size, FRAME_FRAG_SIZE);
+    window = MIN(window, k_mem_slab_num_free_get(config->rx_msg_pool) * frames_per_msg);
+#endif
+    return MAX(window, 1);
+}
+
+static bool credit_update_pending(const struct device *instance) {
+    const struct backend_config *config = instance->config;
+    struct backend_data *instance_data = instance->data;
+
+    return config->flow_control && (atomic_get(&instance_data->credit_due) || atomic_get(&instance_data->credit_probe));
+}
+
+/* Adds the flow control state to a frame. Data frames use up one credit */
+static void credit_add(const struct device *instance, struct frame_info *info) {
+    struct backend_data *instance_data = instance->data;
+    uint8_t window = credit_window(instance);
+
+    atomic_clear(&instance_data->credit_due);
+    k_spinlock_key_t key = k_spin_lock(&instance_data->credit_lock);
+    if (!(info->flags & COBS_FLAG_NO_DATA)) {
+        instance_data->tx_credit_count++;
+    }
+    instance_data->rx_credit_limit = instance_data->rx_credit_count + window;
+
+    info->flags |= COBS_FLAG_CREDIT;
+    info->credit.count = instance_data->tx_credit_count;
+    info->credit.limit = instance_data->rx_credit_limit;
+    k_spin_unlock(&instance_data->credit_lock, key);
+}
+
+/* A baud rate change is in progress. Frames other than link messages would be garbled by the switch */
+static bool rate_busy(struct backend_data *instance_data) {
+    k_spinlock_key_t key = k_spin_lock(&instance_data->rate.lock);
+    bool busy = instance_data->rate.step != RATE_IDLE;
+    k_spin_unlock(&instance_data->rate.lock, key);
+    return busy;
+}
+
+static bool tx_sendable(const struct device *instance) {
+    const struct backend_config *config = instance->config;
+    struct backend_data *instance_data = instance->data;
+
+    if (atomic_get(&instance_data->link_due)) {
+        return true;
+    }
+    if (rate_busy(instance_data)) {
+        return false;
+    }
+
+    bool data_pending = config->arq != NULL ? arq_data_pending(config->arq, instance_data) : tx_pending(instance_data);
+
+    if (data_pending && !credit_left(instance)) {
+        data_pending = false;
+        k_work_schedule(&instance_data->credit_probe_work, K_MSEC(CONFIG_IPC_BACKEND_UART_CREDIT_PROBE_MS));
+    }
+    return data_pending || (config->arq != NULL && arq_ack_pending(config->arq)) || credit_update_pending(instance);
+}
+
+/* Capabilities sent in hellos. They change what every frame carries, so both sides must have the same */
+static uint8_t link_capabilities(const struct backend_config *config) {
+    return (config->arq != NULL ? UART_IPC_CAP_RELIABLE : 0) | (config->flow_control ? UART_IPC_CAP_FLOW_CONTROL : 0) |
+           (config->fec ? UART_IPC_CAP_FEC : 0) | UART_IPC_CAP_PRIO_COUNT(CONFIG_IPC_BACKEND_UART_TX_PRIO_COUNT);
+}
+
+/* The instance has baud rates to step up to, and knows the rate it started from */
+static bool rate_enabled(const struct device *instance) {
+    const struct backend_config *config = instance->config;
+    struct backend_data *instance_data = instance->data;
+
+    return config->baud_rate_count > 0 && instance_data->rate.default_rate != 0;
+}
+
+/* Writes a hello into a link message */
+static size_t link_write_hello(const struct device *instance, uint8_t *msg) {
+    const struct backend_config *config = instance->config;
+    struct backend_data *instance_data = instance->data;
+    const struct uart_ipc_hello hello = {
+        .version = UART_IPC_PROTOCOL_VERSION,
+        .capabilities = link_capabilities(config),
+        .flags = (atomic_get(&instance_data->link_up) ? UART_IPC_HELLO_FLAG_UP : 0) |
+                 (rate_enabled(instance) ? UART_IPC_HELLO_FLAG_RATES : 0),
+        .frag_size = config->frag_size,
+        .session = sys_cpu_to_le32(instance_data->link_session),
+        .peer_session = sys_cpu_to_le32(instance_data->link_peer_session),
+    };
+
+    memcpy(msg, &hello, sizeof(hello));
+    return sizeof(hello);
+}
+
+/* Writes a baud rate negotiation message of the given type into a link message */
+static size_t link_write_rate(struct rate_state *rate, uint8_t type, uint8_t *msg) {
+    struct uart_ipc_rate rate_msg = {0};
+
+    k_spinlock_key_t key = k_spin_lock(&rate->lock);
+    if (type == UART_IPC_LINK_RATE_ACK) {
+        rate_msg.baudrate = sys_cpu_to_le32(rate->ack_rate);
+        rate_msg.accepted = rate->ack_accepted;
+    } else {
+        rate_msg.baudrate = sys_cpu_to_le32(type == UART_IPC_LINK_RATE_DONE ? rate->rate : rate->trial);
+    }
+    k_spin_unlock(&rate->lock, key);
+
+    memcpy(msg, &rate_msg, sizeof(rate_msg));
+    if (type != UART_IPC_LINK_RATE_TEST) {
+        return sizeof(rate_msg);
+    }
+    memcpy(msg + sizeof(rate_msg), rate_test_pattern, sizeof(rate_test_pattern));
+    return sizeof(rate_msg) + sizeof(rate_test_pattern);
+}
+
+/* Encodes a link message into a frame buffer. Link messages carry no reliable mode or flow control state */
+static size_t tx_encode_link(const struct device *instance, struct tx_frame_buf *frame, uint8_t type) {
+    const struct backend_config *config = instance->config;
+    struct backend_data *instance_data = instance->data;
+    uint8_t msg[FRAME_FRAG_SIZE];
+    struct uart_ipc_link_header *header = (struct uart_ipc_link_header *)msg;
+    size_t len = sizeof(*header);
+
+    header->type = type;
+    if (type == UART_IPC_LINK_HELLO) {
+        len += link_write_hello(instance, msg + len);
+    } else if (type == UART_IPC_LINK_FRAG_SIZE) {
+        const struct uart_ipc_frag_size frag_msg = {.frag_size = instance_data->frag.rx_size};
+        memcpy(msg + len, &frag_msg, sizeof(frag_msg));
+        len += sizeof(frag_msg);
+    } else {
+        len += link_write_rate(&instance_data->rate, type, msg + len);
+    }
+
+    const struct frame_info info = {
+        .addr = UART_IPC_ADDR_LINK,
+        .total_data_length = len,
+        .frag = msg,
+        .frag_len = len,
+    };
+    frame->encoded = frame->data;
+    frame->len = encode_frame(config, frame->encoded, &info);
+    return frame->len;
+}
+
+/**
+ * @brief Returns where the last frame of a message queued in a TX buffer can be encoded in place, around its
+ * fragment. Earlier frames of the message have already been copied out, so its header may overwrite their
+ * fragments. Reliable mode keeps a copy of every fragment for retransmission, so its frames are always copied.
+ *
+ * @return Start of the frame in the TX buffer, or NULL if the frame has to be encoded into a frame buffer.
+ */
+static uint8_t *tx_frame_in_place(const struct backend_config *config, const struct tx_request *request, const struct frame_info *info) {
+    if (config->arq != NULL || request->pool_buf == NULL || request->sent < request->len) {
+        return NULL;
+    }
+
+    uint8_t *frag = (uint8_t *)info->frag;
+    if (config->framing == UART_IPC_FRAMING_COBS) {
+        return frag - 1 - sizeof(struct uart_ipc_cobs_header) - (config->flow_control ? sizeof(struct uart_ipc_credit_header) : 0);
+    }
+
+    /* Fixed frames are padded to a full fragment, which has to fit in the buffer too */
+    uint8_t *start = frag - offsetof(struct uart_ipc_frame, frag);
+    uint8_t *end = start + sizeof(struct uart_ipc_frame) + (config->fec ? UART_IPC_FEC_PARITY_LEN : 0);
+    if ((uintptr_t)start % __alignof__(struct uart_ipc_frame) != 0 || end > (uint8_t *)(request->pool_buf + 1)) {
+        return NULL;
+    }
+    return start;
+}
+
+/**
+ * @brief Encodes the next frame to transmit into a frame buffer: a link message if one is due, then the next
+ * data frame if the peer has credit left, otherwise a frame carrying only link state if an acknowledgement or a
+ * credit update is due. Only link messages are sent while the baud rate changes. Only called while holding
+ * tx_busy.
+ *
+ * @param frame Free buffer to encode the frame into.
+ * @param prev Frame on the line that this frame will follow, NULL if the line is idle.
+ *
+ * @return Number of bytes to transmit, 0 if there is nothing to send.
+ */
+static size_t tx_encode_next(const struct device *instance, struct tx_frame_buf *frame, struct tx_frame_buf *prev) {
+    const struct backend_config *config = instance->config;
+    struct backend_data *instance_data = instance->data;
+    struct frame_info info = {0};
+    struct tx_request *request = NULL;
+    bool has_data = false;
+
+    frame->request = NULL;
+    frame->endpoint = NULL;
+    frame->follows_prev = false;
+    frame->encoded = frame->data;
+
+    atomic_val_t link_due = atomic_get(&instance_data->link_due);
+    if (link_due != 0) {
+        uint8_t type = __builtin_ctz(link_due);
+        atomic_and(&instance_data->link_due, ~BIT(type));
+        return tx_encode_link(instance, frame, type);
+    }
+    if (rate_busy(instance_data)) {
+        return 0;
+    }
+    if (atomic_cas(&instance_data->tx_drop_partial, 1, 0)) {
+        tx_drop_partial(instance, prev);
+    }
+    if (credit_left(instance)) {
+        if (config->arq != NULL) {
+            has_data = arq_take_frame(instance, &info, frame);  // Lost frames are retransmitted, so there is nothing to drop
+        } else if ((request = tx_next_request(instance_data)) != NULL) {
+            tx_request_take_frame(request, &info, instance_data->tx_frag_size);
+            has_data = true;
+        }
+    }
+
+    if (!has_data) {
+        if (!(config->arq != NULL && arq_ack_pending(config->arq)) && !credit_update_pending(instance)) {
+            return 0;
+        }
+        info.flags = COBS_FLAG_NO_DATA;
+        info.addr = UART_IPC_ADDR_CONTROL;
+        info.frag_start = atomic_cas(&instance_data->credit_probe, 1, 0) ? UART_IPC_CREDIT_PROBE : 0;
+    }
+    if (config->arq != NULL) {
+        arq_add_ack(config->arq, &info);
+    }
+    if (config->flow_control) {
+        credit_add(instance, &info);
+    }
+
+    uint8_t *in_place = request != NULL ? tx_frame_in_place(config, request, &info) : NULL;
+    if (in_place != NULL) {
+        frame->encoded = in_place;
+        frame->pool_buf = request->pool_buf;
+    }
+    frame->len = encode_frame(config, frame->encoded, &info);
+
+    if (request != NULL) {
+        frame->endpoint = request->endpoint;
+        if (prev != NULL && prev->request == request) {
+            /* The rest of the message now belongs to this frame, which is dropped too if the frame on the line is */
+            prev->request = NULL;
+            frame->follows_prev = true;
+        }
+        if (request->sent >= request->len) {
+            stats_tx_last_frame(frame, request);
+            if (frame->pool_buf != NULL) {
+                request->data = NULL;  // The buffer now belongs to the frame
+            } else {
+                tx_request_free(instance, request);
+            }
+        } else {
+            frame->request = request;
+        }
+    }
+    return frame->len;
+}
+
+static void tx_frame_release(struct backend_data *instance_data, struct tx_frame_buf *frame) {
+    if (frame->pool_buf != NULL) {
+        k_mem_slab_free(instance_data->tx_slab, (void **)&frame->pool_buf);
+        frame->pool_buf = NULL;
+    }
+    frame->len = 0;
+    frame->request = NULL;
+    frame->endpoint = NULL;
+    frame->follows_prev = false;
+}
+
+/**
+ * @brief Drops the rest of the message whose frame on the line could not be sent, as the receiver cannot
+ * reassemble it, and notifies its endpoint. The frame encoded to follow it is dropped as well if it is part of
+ * the same message.
+ */
+static void tx_drop_line(const struct device *instance, const char *message) {
+    struct backend_data *instance_data = instance->data;
+    struct tx_frame_buf *line = &instance_data->tx_frames[instance_data->tx_line];
+    struct tx_frame_buf *next = &instance_data->tx_frames[instance_data->tx_line ^ 1];
+    struct backend_endpoint *endpoint = line->endpoint;
+
+    if (endpoint != NULL && endpoint->cfg.cb.error != NULL) {
+        endpoint->cfg.cb.error(message, endpoint->cfg.priv);
+    }
+    if (line->request != NULL) {
+        tx_request_free(instance, line->request);
+    }
+    if (next->len > 0 && next->follows_prev) {
+        if (next->request != NULL) {
+            tx_request_free(instance, next->request);
+        }
+        stats_tx_done(instance_data, next, true);
+        tx_frame_release(instance_data, next);
+    }
+    tx_frame_release(instance_data, line);
+}
+
+/**
+ * @brief Hands the frame on the line to the UART. Only called while holding tx_busy.
+ *
+ * @return 0 on success, otherwise the error of uart_tx. The frame has then been dropped.
+ */
+static int tx_transmit(const struct device *instance) {
+    struct backend_data *instance_data = instance->data;
+    const struct backend_config *instance_config = instance->config;
+    struct tx_frame_buf *line = &instance_data->tx_frames[instance_data->tx_line];
+    size_t len = line->len;  // The frame may already be done when uart_tx returns
+
+    int err = uart_tx(instance_config->uart_dev, line->encoded, len, SYS_FOREVER_US);
+    if (err == 0) {
+        STATS_INC(instance_data, tx_frames);
+        STATS_ADD(instance_data, tx_bytes, len);
+        return 0;
+    }
+
+    LOG_ERR("UART TX failed %d", err);
+    STATS_INC(instance_data, tx_errors);
+    stats_tx_done(instance_data, line, true);
+    tx_drop_line(instance, "UART TX failed");
+    return err;
+}
+
+/**
+ * @brief Starts transmitting the next frame unless a transfer is already in progress. Safe to call from any
+ * context, including the UART callback.
+ *
+ * @return true if this call started a transfer.
+ */
+static bool tx_start_next(const struct device *instance) {
+    struct backend_data *instance_data = instance->data;
+
+    while (tx_sendable(instance) && atomic_cas(&instance_data->tx_busy, 0, 1)) {
+        if (tx_encode_next(instance, &instance_data->tx_frames[instance_data->tx_line], NULL) > 0 && tx_transmit(instance) == 0) {
+            return true;
+        }
+        atomic_clear(&instance_data->tx_busy);
+    }
+    return false;
+}
+
+/**
+ * @brief Encodes the frame to follow the one on the line, so that it can be handed to the UART as soon as the
+ * transfer is done. Frames are still encoded one at a time from the queued messages, so a message of a more
+ * urgent priority level overtakes a long message one frame later. Only called from the UART callback while
+ * holding tx_busy: the TX done event of the frame on the line cannot run before it returns.
+ */
+static void tx_prepare_next(const struct device *instance) {
+    struct backend_data *instance_data = instance->data;
+
+    if (tx_sendable(instance)) {
+        tx_encode_next(instance, &instance_data->tx_frames[instance_data->tx_line ^ 1],
+                       &instance_data->tx_frames[instance_data->tx_line]);
+    }
+}
+
+/**
+ * @brief Called from the UART callback once the frame on the line has been sent or was aborted. The frame
+ * prepared while it was sent goes out right away, and the one after it is encoded while that is on the line.
+ */
+static void tx_done(const struct device *instance, bool aborted) {
+    struct backend_data *instance_data = instance->data;
+    struct tx_frame_buf *line = &instance_data->tx_frames[instance_data->tx_line];
+
+    if (aborted) {
+        STATS_INC(instance_data, tx_aborts);
+    }
+    stats_tx_done(instance_data, line, aborted);
+    if (aborted) {
+        tx_drop_line(instance, "Sending data was aborted");
+    }
+    tx_frame_release(instance_data, line);
+
+    instance_data->tx_line ^= 1;
+    if (instance_data->tx_frames[instance_data->tx_line].len > 0 && tx_transmit(instance) == 0) {
+        tx_prepare_next(instance);
+        return;
+    }
+    atomic_clear(&instance_data->tx_busy);
+    if (tx_start_next(instance)) {
+        tx_prepare_next(instance);
+    }
+}
+
+/**
+ * @brief Processes the flow control state of a valid frame from the peer, after the frame has been processed.
+ * The credit handed back to the peer therefore never exceeds the frames that can be buffered here. A new limit
+ * is advertised once the peer has used up half of the credit that can be granted now, or when it asks for one
+ * with a probe.
+ */
+static void credit_receive(const struct device *instance, const struct frame_info *info) {
+    struct backend_data *instance_data = instance->data;
+    uint8_t window = credit_window(instance);
+
+    k_spinlock_key_t key = k_spin_lock(&instance_data->credit_lock);
+    instance_data->tx_credit_limit = info->credit.limit;
+    instance_data->rx_credit_count = info->credit.count;
+    bool used_up = (int8_t)(info->credit.count + window - instance_data->rx_credit_limit) >= MAX(window / 2, 1);
+    k_spin_unlock(&instance_data->credit_lock, key);
+
+    if (info->flags & COBS_FLAG_NO_DATA) {
+        if (info->frag_start == UART_IPC_CREDIT_PROBE) {
+            atomic_set(&instance_data->credit_due, 1);
+        }
+    } else if (used_up) {
+        atomic_set(&instance_data->credit_due, 1);
+    }
+
+    if (credit_left(instance)) {
+        k_work_cancel_delayable(&instance_data->credit_probe_work);
+    }
+    tx_start_next(instance);
+}
+
+/* Asks the peer for a credit update when it has not granted any for a while, in case an update was lost */
+static void credit_probe_handler(struct k_work *work) {
+    struct backend_data *instance_data = CONTAINER_OF(k_work_delayable_from_work(work), struct backend_data, credit_probe_work);
+
+    atomic_set(&instance_data->credit_probe, 1);
+    tx_start_next(instance_data->control.instance);
+}
+
+/* Starts counting frames from scratch, as the peer does when it starts */
+static void credit_reset(const struct device *instance) {
+    const struct backend_config *config = instance->config;
+    struct backend_data *instance_data = instance->data;
+
+    k_spinlock_key_t key = k_spin_lock(&instance_data->credit_lock);
+    instance_data->tx_credit_count = 0;
+    instance_data->tx_credit_limit = config->rx_credits;  // Until the peer advertises its own
+    instance_data->rx_credit_count = 0;
+    instance_data->rx_credit_limit = config->rx_credits;
+    k_spin_unlock(&instance_data->credit_lock, key);
+    atomic_clear(&instance_data->credit_due);
+    atomic_clear(&instance_data->credit_probe);
+}
+
+static void credit_init(const struct device *instance) {
+    struct backend_data *instance_data = instance->data;
+
+    credit_reset(instance);
+    k_work_init_delayable(&instance_data->credit_probe_work, credit_probe_handler);
+}
+
+/**
+ * @brief Processes the acknowledgement state carried by a frame from the peer. The link does not reorder
+ * frames, so frames the peer reports missing while later ones arrived were lost. They are retransmitted right
+ * away instead of waiting for the retransmission timeout.
+ */
+static void arq_receive_ack(const struct device *instance, uint8_t ack, uint32_t sack) {
+    const struct backend_config *config = instance->config;
+    struct arq_state *arq = config->arq;
+
+    k_spinlock_key_t key = k_spin_lock(&arq->lock);
+    uint8_t in_flight = arq->tx_next - arq->tx_base;
+    if ((uint8_t)(ack - arq->tx_base) > in_flight) {
+        k_spin_unlock(&arq->lock, key);
+        LOG_DBG("Ignoring stale acknowledgement %d", ack);
+        return;
+    }
+
+    for (uint8_t seq = arq->tx_base; seq != ack; ++seq) {
+        arq->tx[arq_slot(seq)].acked = true;
+    }
+
+    uint8_t sacked_end = ack;  // One past the newest frame received out of order
+    for (uint8_t seq = ack + 1; seq != arq->tx_next && (uint8_t)(seq - ack - 1) < 32; ++seq) {
+        if (sack & BIT((uint8_t)(seq - ack - 1))) {
+            arq->tx[arq_slot(seq)].acked = true;
+            sacked_end = seq + 1;
+        }
+    }
+
+    for (uint8_t seq = ack; seq != sacked_end; ++seq) {
+        struct arq_tx_slot *slot = &arq->tx[arq_slot(seq)];
+        if (!slot->acked && !slot->fast_retransmitted) {
+            slot->retransmit = true;
+            slot->fast_retransmitted = true;
+        }
+    }
+
+    bool progress = false;
+    while (arq->tx_base != arq->tx_next && arq->tx[arq_slot(arq->tx_base)].acked) {
+        arq->tx[arq_slot(arq->tx_base)].retransmit = false;
+        arq->tx_base++;
+        progress = true;
+    }
+    bool idle = arq->tx_base == arq->tx_next;
+    if (progress) {
+        arq->timeouts = 0;
+    }
+    k_spin_unlock(&arq->lock, key);
+
+    if (idle) {
+        k_work_cancel_delayable(&arq->rto_work);
+    } else if (progress) {
+        k_work_reschedule(&arq->rto_work, K_MSEC(CONFIG_IPC_BACKEND_UART_ARQ_RTO_MS));
+    }
+    tx_start_next(instance);
+}
+
+/* Retransmits every unacknowledged frame when the peer has not acknowledged anything for a while */
+static void arq_rto_handler(struct k_work *work) {
+    struct arq_state *arq = CONTAINER_OF(k_work_delayable_from_work(work), struct arq_state, rto_work);
+
+    k_spinlock_key_t key = k_spin_lock(&arq->lock);
+    if (arq->tx_base == arq->tx_next) {
+        k_spin_unlock(&arq->lock, key);
+        return;
+    }
+    for (uint8_t seq = arq->tx_base; seq != arq->tx_next; ++seq) {
+        struct arq_tx_slot *slot = &arq->tx[arq_slot(seq)];
+        if (!slot->acked) {
+            slot->retransmit = true;
+            slot->fast_retransmitted = false;
+        }
+    }
+    if (arq->timeouts < UINT8_MAX) {
+        arq->timeouts++;
+    }
+    bool peer_lost = arq->timeouts == CONFIG_IPC_BACKEND_UART_ARQ_MAX_TIMEOUTS;
+    k_spin_unlock(&arq->lock, key);
+
+    if (peer_lost) {
+        LOG_ERR("No acknowledgement after %d retransmissions", CONFIG_IPC_BACKEND_UART_ARQ_MAX_TIMEOUTS);
+        report_error(arq->instance, "Peer stopped acknowledging frames, retransmitting");
+    }
+    k_work_schedule(&arq->rto_work, K_MSEC(CONFIG_IPC_BACKEND_UART_ARQ_RTO_MS));
+    tx_start_next(arq->instance);
+}
+
+/* Sends a bare acknowledgement if no frame to the peer picked it up within the acknowledgement delay */
+static void arq_ack_handler(struct k_work *work) {
+    struct arq_state *arq = CONTAINER_OF(k_work_delayable_from_work(work), struct arq_state, ack_work);
+
+    k_spinlock_key_t key = k_spin_lock(&arq->lock);
+    arq->ack_delay_expired = arq->ack_due;
+    k_spin_unlock(&arq->lock, key);
+    tx_start_next(arq->instance);
+}
+
+/**
+ * @brief Forgets the frames exchanged with a peer that restarted, as its sequence numbers start over. Frames not
+ * yet acknowledged are dropped with it. Only called from the RX context.
+ */
+static void arq_reset(const struct device *instance) {
+    const struct backend_config *config = instance->config;
+    struct arq_state *arq = config->arq;
+
+    if (arq == NULL) {
+        return;
+    }
+    k_spinlock_key_t key = k_spin_lock(&arq->lock);
+    arq->tx_base = 0;
+    arq->tx_next = 0;
+    arq->timeouts = 0;
+    arq->rx_expected = 0;
+    arq->rx_sack = 0;
+    arq->ack_due = false;
+    arq->ack_delay_expired = false;
+    k_spin_unlock(&arq->lock, key);
+    k_work_cancel_delayable(&arq->rto_work);
+    k_work_cancel_delayable(&arq->ack_work);
+}
+
+static void arq_init(const struct device *instance) {
+    const struct backend_config *config = instance->config;
+    struct arq_state *arq = config->arq;
+
+    if (arq == NULL) {
+        return;
+    }
+    memset(arq, 0, sizeof(*arq));
+    arq->instance = instance;
+    k_work_init_delayable(&arq->ack_work, arq_ack_handler);
+    k_work_init_delayable(&arq->rto_work, arq_rto_handler);
+}
+
+/* The caller is the receive path of an instance, which frames waiting for credit or acknowledgements depend on */
+static bool in_rx_context(struct backend_data *instance_data) {
+#ifdef CONFIG_IPC_BACKEND_UART_RX_THREAD
+    if (k_current_get() == &instance_data->rx_thread) {
+        return true;
+    }
+#endif
+    return k_is_in_isr();
+}
+
+/* Time to wait for a TX buffer or queue slot. The receive path never waits, as it frees them */
+static inline k_timeout_t tx_timeout(struct backend_data *instance_data) {
+    if (in_rx_context(instance_data)) {
+        return K_NO_WAIT;
+    }
+    return CONFIG_IPC_BACKEND_UART_TX_TIMEOUT_MS < 0 ? K_FOREVER : K_MSEC(CONFIG_IPC_BACKEND_UART_TX_TIMEOUT_MS);
+}
+
+/**
+ * @brief Queues the open batch of a priority level as one message. Called with tx_batch_lock held.
+ *
+ * @return 0 on success or if no batch is open, -EAGAIN if the TX queue is full.
+ */
+static int tx_batch_queue(struct backend_data *instance_data, size_t prio) {
+    struct tx_batch *batch = &instance_data->tx_batches[prio];
+
+    if (batch->buf == NULL) {
+        return 0;
+    }
+
+    struct tx_request request = {
+        .data = batch->buf->data,
+        .len = batch->len,
+        .pool_buf = batch->buf,
+        .endpoint = &instance_data->batches[prio],
+        .queued_at = batch->opened_at,
+    };
+    if (k_msgq_put(&instance_data->tx_queues[prio], &request, K_NO_WAIT) != 0) {
+        return -EAGAIN;
+    }
+    stats_queue_level(instance_data, prio);
+    batch->buf = NULL;
+    batch->len = 0;
+    return 0;
+}
+
+/* Queues the open batch of a priority level, so that messages sent after it do not overtake it */
+static int tx_batch_flush(const struct device *instance, size_t prio) {
+    const struct backend_config *config = instance->config;
+    struct backend_data *instance_data = instance->data;
+
+    if (config->coalesce_window_usec == 0) {
+        return 0;
+    }
+
+    k_spinlock_key_t key = k_spin_lock(&instance_data->tx_batch_lock);
+    int err = tx_batch_queue(instance_data, prio);
+    k_spin_unlock(&instance_data->tx_batch_lock, key);
+    return err;
+}
+
+/* Queues every open batch once the coalescing window has passed */
+static void tx_batch_handler(struct k_work *work) {
+    struct k_work_delayable *dwork = k_work_delayable_from_work(work);
+    struct backend_data *instance_data = CONTAINER_OF(dwork, struct backend_data, tx_batch_work);
+    const struct device *instance = instance_data->control.instance;
+    const struct backend_config *config = instance->config;
+    bool queued = true;
+
+    k_spinlock_key_t key = k_spin_lock(&instance_data->tx_batch_lock);
+    for (size_t prio = 0; prio < CONFIG_IPC_BACKEND_UART_TX_PRIO_COUNT; ++prio) {
+        queued = tx_batch_queue(instance_data, prio) == 0 && queued;
+    }
+    k_spin_unlock(&instance_data->tx_batch_lock, key);
+
+    if (!queued) {
+        k_work_schedule(dwork, K_USEC(config->coalesce_window_usec));  // TX queue full, try again later
+    }
+    tx_start_next(instance);
+}
+
+/* Small messages are coalesced if coalescing is enabled and their record fits in a batch */
+static bool tx_batch_fits(const struct device *instance, size_t len) {
+    const struct backend_config *config = instance->config;
+
+    return config->coalesce_window_usec > 0 && len <= UINT8_MAX &&
+           sizeof(struct uart_ipc_batch_record) + len <= config->coalesce_threshold;
+}
+
+/**
+ * @brief Appends a small message to the open batch of its priority level, opening a batch if there is none.
+ * The batch is queued as one message once it holds coalesce_threshold bytes, or at the latest
+ * coalesce_window microseconds after it was opened.
+ *
+ * @return 0 on success, -ENOBUFS if no TX buffer was free to open a batch, -EAGAIN if a full batch could not
+ * be queued.
+ */
+static int tx_batch_add(const struct device *instance, struct backend_endpoint *endpoint, const void *data, size_t len) {
+    const struct backend_config *config = instance->config;
+    struct backend_data *instance_data = instance->data;
+    struct tx_batch *batch = &instance_data->tx_batches[endpoint->tx_prio];
+    const size_t record_len = sizeof(struct uart_ipc_batch_record) + len;
+    int err = 0;
+
+    k_spinlock_key_t key = k_spin_lock(&instance_data->tx_batch_lock);
+    if (batch->buf != NULL && batch->len + record_len > config->coalesce_threshold) {
+        err = tx_batch_queue(instance_data, endpoint->tx_prio);
+    }
+    if (err == 0 && batch->buf == NULL) {
+        if (k_mem_slab_alloc(instance_data->tx_slab, (void **)&batch->buf, K_NO_WAIT) != 0) {
+            batch->buf = NULL;
+            err = -ENOBUFS;
+        } else {
+            batch->len = 0;
+            batch->opened_at = STATS_TIMESTAMP();
+            k_work_schedule(&instance_data->tx_batch_work, K_USEC(config->coalesce_window_usec));
+        }
+    }
+    if (err == 0) {
+        struct uart_ipc_batch_record *record = (struct uart_ipc_batch_record *)(batch->buf->data + batch->len);
+        record->addr = endpoint->addr;
+        record->len = len;
+        memcpy(batch->buf->data + batch->len + sizeof(*record), data, len);
+        batch->len += record_len;
+
+        if (batch->len + sizeof(*record) >= config->coalesce_threshold) {
+            tx_batch_queue(instance_data, endpoint->tx_prio);  // Full. If the queue is full the window work retries
+        }
+    }
+    k_spin_unlock(&instance_data->tx_batch_lock, key);
+
+    tx_start_next(instance);
+    return err;
+}
+
+/**
+ * @brief Queues a message at the priority level of its endpoint and starts transmitting if the line is idle.
+ *
+ * @return 0 on success, -EAGAIN if the TX queue stayed full for the configured timeout.
+ */
+static int tx_enqueue(const struct device *instance, struct tx_request *request) {
+    struct backend_data *instance_data = instance->data;
+
+    request->queued_at = STATS_TIMESTAMP();
+    if (tx_batch_flush(instance, request->endpoint->tx_prio) != 0 ||
+        k_msgq_put(&instance_data->tx_queues[request->endpoint->tx_prio], request, tx_timeout(instance_data)) != 0) {
+        LOG_ERR("TX queue full");
+        STATS_INC(instance_data, tx_queue_full);
+        return -EAGAIN;
+    }
+    stats_queue_level(instance_data, request->endpoint->tx_prio);
+
+    tx_start_next(instance);
+    return 0;
+}
+
+/**
+ * @brief Copies a message to be sent, compressed if the instance compresses messages and that makes it smaller.
+ * Incompressible messages are copied as they are.
+ *
+ * @param dest Destination
+ * @param size Size of the destination
+ * @param flags Set to COBS_FLAG_COMPRESSED if the message was compressed, 0 otherwise
+ * @return Length of the copy, 0 if the message does not fit in the destination even compressed
+ */
+static size_t tx_copy_message(const struct device *instance, uint8_t *dest, size_t size, const void *data, size_t len, uint8_t *flags) {
+    const struct backend_config *config = instance->config;
+    const size_t header_len = sizeof(struct uart_ipc_compressed_header);
+
+    *flags = 0;
+    if (config->compression && len > header_len + 1) {
+        int compressed_len = uart_ipc_lz_compress(dest + header_len, MIN(size, len - 1) - header_len, data, len);
+        if (compressed_len > 0) {
+            sys_put_le16(len, dest);
+            *flags = COBS_FLAG_COMPRESSED;
+            return header_len + compressed_len;
+        }
+    }
+    if (len > size) {
+        return 0;
+    }
+    memcpy(dest, data, len);
+    return len;
+}
+
+/**
+ * @brief Withdraws a message framed from the buffer of its sender whose frames have not all been encoded, so
+ * that the sender can return. The peer drops the transfer if some frames were already sent. Waits for the
+ * frame on the line, as nothing else is encoded while the message is looked up.
+ *
+ * @return true if the message was withdrawn, false if it was framed or dropped in the meantime.
+ */
+static bool tx_withdraw(const struct device *instance, const struct tx_request *request) {
+    struct backend_data *instance_data = instance->data;
+    struct k_msgq *queue = &instance_data->tx_queues[request->endpoint->tx_prio];
+    struct tx_request *active = &instance_data->tx_active[request->endpoint->tx_prio];
+    bool withdrawn = false;
+
+    while (!atomic_cas(&instance_data->tx_busy, 0, 1)) {
+        if (k_sem_count_get(&request->done->sem) > 0) {
+            return false;
+        }
+        k_sleep(K_MSEC(1));
+    }
+
+    if (active->data != NULL && active->done == request->done) {
+        active->data = NULL;
+        withdrawn = true;
+    } else {
+        unsigned int key = irq_lock();  // Keep the order of messages queued meanwhile
+        for (uint32_t count = k_msgq_num_used_get(queue); count > 0; --count) {
+            struct tx_request queued;
+            k_msgq_get(queue, &queued, K_NO_WAIT);
+            if (queued.done == request->done) {
+                withdrawn = true;
+            } else {
+                k_msgq_put(queue, &queued, K_NO_WAIT);
+            }
+        }
+        irq_unlock(key);
+    }
+    atomic_clear(&instance_data->tx_busy);
+    tx_start_next(instance);
+    return withdrawn;
+}
+
+/* Rate assumed when the UART rate could not be read, the slowest in common use so that waits are not cut short */
+#define SEND_LARGE_FALLBACK_BAUDRATE 9600
+
+/* Time send_large waits for a message to be framed: the TX timeout plus the time its frames take on the line */
+static k_timeout_t send_large_timeout(const struct device *instance, size_t len) {
+    struct backend_data *instance_data = instance->data;
+
+    if (CONFIG_IPC_BACKEND_UART_TX_TIMEOUT_MS < 0) {
+        return K_FOREVER;
+    }
+    k_spinlock_key_t key = k_spin_lock(&instance_data->rate.lock);
+    uint32_t baudrate = instance_data->rate.rate;
+    k_spin_unlock(&instance_data->rate.lock, key);
+
+    uint64_t bits = (uint64_t)DIV_ROUND_UP(len, MAX(instance_data->tx_frag_size, 1)) * TX_FRAME_MAX_LEN * 10;
+    uint64_t line_us = bits * USEC_PER_SEC / (baudrate > 0 ? baudrate : SEND_LARGE_FALLBACK_BAUDRATE);
+    return K_USEC(line_us + CONFIG_IPC_BACKEND_UART_TX_TIMEOUT_MS * USEC_PER_MSEC);
+}
+
+/**
+ * @brief Sends a message that does not fit in a TX buffer. Its frames are encoded straight from the buffer of
+ * the caller, which blocks until the last one has been encoded, at most for send_large_timeout. The receive
+ * path cannot wait for that, as the frames may be waiting for the credit or acknowledgements it processes.
+ *
+ * @return 0 on success, -EMSGSIZE if called from the UART callback or the RX thread, -EAGAIN if the TX queue
+ * stayed full or the message was not framed within the configured timeout, -ECONNRESET if the message was
+ * dropped, because a frame could not be sent or the peer restarted.
+ */
+static int send_large(const struct device *instance, struct backend_endpoint *endpoint, const void *data, size_t len) {
+    if (in_rx_context(instance->data)) {
+        LOG_ERR("Messages of %d bytes cannot be sent from the receive path", len);
+        return -EMSGSIZE;
+    }
+
+    struct tx_done done;
+    k_sem_init(&done.sem, 0, 1);
+    struct tx_request request = {
+        .data = data,
+        .len = len,
+        .done = &done,
+        .endpoint = endpoint,
+    };
+    int err = tx_enqueue(instance, &request);
+    if (err) {
+        return err;
+    }
+    if (k_sem_take(&done.sem, send_large_timeout(instance, len)) != 0) {
+        if (tx_withdraw(instance, &request)) {
+            LOG_ERR("Message of %d bytes not sent within the TX timeout", len);
+            return -EAGAIN;
+        }
+        k_sem_take(&done.sem, K_FOREVER);  // Framed or dropped while it was looked up
+    }
+    return done.result;
+}
+
+/* Copies a message into a TX buffer and queues it. Messages that do not fit, even compressed, go to send_large */
+static int tx_send(const struct device *instance, struct backend_endpoint *endpoint, const void *data, size_t len) {
+    const struct backend_config *instance_config = instance->config;
+    const size_t buf_size = sizeof(((struct uart_ipc_tx_buf *)0)->data);
+
+    if (len > buf_size && !instance_config->compression) {
+        return send_large(instance, endpoint, data, len);
+    }
+
+    struct uart_ipc_tx_buf *tx_buf;
+    if (k_mem_slab_alloc(instance_config->tx_slab, (void **)&tx_buf, tx_timeout(instance->data)) != 0) {
+        LOG_ERR("No free TX buffers");
+        STATS_INC((struct backend_data *)instance->data, tx_slab_failures);
+        return -EAGAIN;
+    }
+    struct tx_request request = {
+        .data = tx_buf->data,
+        .pool_buf = tx_buf,
+        .endpoint = endpoint,
+    };
+    request.len = tx_copy_message(instance, tx_buf->data, buf_size, data, len, &request.flags);
+    if (request.len == 0) {
+        k_mem_slab_free(instance_config->tx_slab, (void **)&tx_buf);
+        return send_large(instance, endpoint, data, len);
+    }
+    int err = tx_enqueue(instance, &request);
+    if (err) {
+        k_mem_slab_free(instance_config->tx_slab, (void **)&tx_buf);
+    }
+    return err;
+}
+
+static int send(const struct device *instance, void *token, const void *data, size_t len) {
+    const struct backend_config *config = instance->config;
+    struct backend_data *instance_data = instance->data;
+    struct backend_endpoint *endpoint = (struct backend_endpoint *)token;
+
+    if (!instance_data->is_opened) {
+        LOG_ERR("UART backend not opened");
+        return -EIO;
+    }
+
+    if (len == 0) {
+        return -EBADMSG;
+    }
+
+    /* The peer reassembles messages in buffers of the same max_message_size in the heap-free mode */
+    if (len > UINT16_MAX || !msg_fits(config->rx_msg_pool, len)) {
+        return -EMSGSIZE;
+    }
+
+    if (tx_batch_fits(instance, len)) {
+        int err = tx_batch_add(instance, endpoint, data, len);
+        if (err != -ENOBUFS) {
+            return err;
+        }
+        /* No batch is open at this level, so the message can be sent on its own without reordering */
+    }
+    return tx_send(instance, endpoint, data, len);
+}
+
+/**
+ * @brief Hands out the data area of a preallocated TX buffer. The caller serializes directly into it and
+ * passes it to send_nocopy, so the message is framed straight from the buffer without being copied first.
+ */
+static int get_tx_buffer(const struct device *instance, void *token, void **data, uint32_t *len, k_timeout_t wait) {
+    struct backend_data *instance_data = instance->data;
+    const struct backend_config *instance_config = instance->config;
+    const uint32_t buf_size = sizeof(((struct uart_ipc_tx_buf *)0)->data);
+
+    if (data == NULL || len == NULL) {
+        return -EINVAL;
+    }
+
+    if (!instance_data->is_opened) {
+        LOG_ERR("UART backend not opened");
+        return -EIO;
+    }
+
+    if (*len > buf_size) {
+        *len = buf_size;
+        return -ENOMEM;
+    }
+
+    struct uart_ipc_tx_buf *tx_buf;
+    if (k_mem_slab_alloc(instance_config->tx_slab, (void **)&tx_buf, wait) != 0) {
+        STATS_INC(instance_data, tx_slab_failures);
+        return -ENOBUFS;
+    }
+    *data = tx_buf->data;
+    *len = buf_size;
+    return 0;
+}
+
+static int drop_tx_buffer(const struct device *instance, void *token, const void *data) {
+    const struct backend_config *instance_config = instance->config;
+
+    struct uart_ipc_tx_buf *tx_buf = tx_buf_from_payload(instance_config, data);
+    if (tx_buf == NULL) {
+        return -ENXIO;
+    }
+
+    k_mem_slab_free(instance_config->tx_slab, (void **)&tx_buf);
+    return 0;
+}
+
+static int send_nocopy(const struct device *instance, void *token, const void *data, size_t len) {
+    struct backend_data *instance_data = instance->data;
+    const struct backend_config *instance_config = instance->config;
+    struct backend_endpoint *endpoint = (struct backend_endpoint *)token;
+
+    if (!instance_data->is_opened) {
+        LOG_ERR("UART backend not opened");
+        return -EIO;
+    }
+
+    struct uart_ipc_tx_buf *tx_buf = tx_buf_from_payload(instance_config, data);
+    if (tx_buf == NULL || data != tx_buf->data) {
+        return -ENXIO;
+    }
+
+    if (len == 0) {
+        return -EBADMSG;
+    }
+
+    if (len > sizeof(tx_buf->data)) {
+        return -EMSGSIZE;
+    }
+
+    if (tx_batch_fits(instance, len)) {
+        int err = tx_batch_add(instance, endpoint, data, len);
+        if (err == 0) {
+            k_mem_slab_free(instance_config->tx_slab, (void **)&tx_buf);
+        }
+        if (err != -ENOBUFS) {
+            return err;
+        }
+    }
+
+    struct tx_request request = {
+        .data = tx_buf->data,
+        .len = len,
+        .pool_buf = tx_buf,
+        .endpoint = endpoint,
+    };
+    return tx_enqueue(instance, &request);
+}
+
+/**
+ * @brief Announces a local endpoint to the peer on the control channel.
+ *
+ * @param type UART_IPC_CONTROL_BIND_REQ or UART_IPC_CONTROL_BIND_RSP
+ */
+static int send_bind(const struct device *instance, struct backend_endpoint *endpoint, uint8_t type) {
+    struct backend_data *instance_data = instance->data;
+    size_t name_len = strlen(endpoint->cfg.name);
+    uint8_t msg[FRAME_FRAG_SIZE];
+
+    struct uart_ipc_control_header *header = (struct uart_ipc_control_header *)msg;
+    header->type = type;
+    header->addr = endpoint->addr;
+    memcpy(msg + sizeof(*header), endpoint->cfg.name, name_len);
+
+    int err = tx_send(instance, &instance_data->control, msg, sizeof(*header) + name_len);
+    if (err) {
+        LOG_ERR("Could not bind endpoint \"%s\": %d", endpoint->cfg.name, err);
+    }
+    return err;
+}
+
+/**
+ * @brief Binds the local endpoint with the same name as a peer endpoint, so that frames from the peer address
+ * are delivered to it. Answers requests, so that a peer that registered first or rebooted binds as well.
+ */
+static void receive_bind(const struct device *instance, const struct uart_ipc_control_header *header, const char *name, size_t name_len) {
+    const struct backend_config *config = instance->config;
+    struct backend_data *instance_data = instance->data;
+    struct backend_endpoint *endpoint = NULL;
+
+    if (!atomic_get(&instance_data->link_up)) {
+        LOG_DBG("Peer endpoint \"%.*s\" announced before the link is up", (int)name_len, name);
+        return;  // Both sides announce their endpoints again once it is
+    }
+
+    for (size_t i = 0; i < config->endpoint_count; ++i) {
+        struct backend_endpoint *candidate = &config->endpoints[i];
+        if (candidate->is_registered && strlen(candidate->cfg.name) == name_len && memcmp(candidate->cfg.name, name, name_len) == 0) {
+            endpoint = candidate;
+        } else if (candidate->is_bound && candidate->remote_addr == header->addr) {
+            candidate->is_bound = false;  // Peer address was reassigned, the peer will announce the endpoint again
+        }
+    }
+
+    if (endpoint == NULL) {
+        LOG_DBG("Peer endpoint \"%.*s\" is not registered locally", (int)name_len, name);
+        return;
+    }
+
+    bool was_bound = endpoint->is_bound;
+    endpoint->remote_addr = header->addr;
+    endpoint->is_bound = true;
+    LOG_DBG("Endpoint \"%s\" bound to peer address %d", endpoint->cfg.name, header->addr);
+
+    if (header->type == UART_IPC_CONTROL_BIND_REQ) {
+        send_bind(instance, endpoint, UART_IPC_CONTROL_BIND_RSP);
+    }
+    if (!was_bound && endpoint->cfg.cb.bound != NULL) {
+        endpoint->cfg.cb.bound(endpoint->cfg.priv);
+    }
+}
+
+/* Receive callback of the control channel */
+static void receive_control(const void *msg, size_t len, void *priv) {
+    const struct device *instance = priv;
+    const struct uart_ipc_control_header *header = msg;
+
+    if (len < sizeof(*header)) {
+        LOG_ERR("Malformed control message");
+        return;
+    }
+
+    switch (header->type) {
+        case UART_IPC_CONTROL_BIND_REQ:
+        case UART_IPC_CONTROL_BIND_RSP:
+            receive_bind(instance, header, (const char *)msg + sizeof(*header), len - sizeof(*header));
+            break;
+        default:
+            LOG_WRN("Unknown control message type %d", header->type);
+            break;
+    }
+}
+
+/* Queues a link message, which is sent ahead of any other frame */
+static void link_send(const struct device *instance, uint8_t type) {
+    struct backend_data *instance_data = instance->data;
+
+    atomic_or(&instance_data->link_due, BIT(type));
+    tx_start_next(instance);
+}
+
+/* Repeats the hello until the peer has answered, then the announcements of the endpoints it has not bound yet */
+static void hello_handler(struct k_work *work) {
+    struct backend_data *instance_data = CONTAINER_OF(k_work_delayable_from_work(work), struct backend_data, hello_work);
+    const struct device *instance = instance_data->control.instance;
+
+    if (!atomic_get(&instance_data->link_up)) {
+        link_send(instance, UART_IPC_LINK_HELLO);
+        k_work_schedule(&instance_data->hello_work, K_MSEC(CONFIG_IPC_BACKEND_UART_HELLO_INTERVAL_MS));
+    } else if (link_ready(instance)) {
+        link_announce(instance);
+    }
+}
+
+/* The link is up and the baud rate settled, so endpoints can be announced */
+static bool link_ready(const struct device *instance) {
+    struct backend_data *instance_data = instance->data;
+
+    k_spinlock_key_t key = k_spin_lock(&instance_data->rate.lock);
+    bool negotiating = instance_data->rate.negotiating;
+    k_spin_unlock(&instance_data->rate.lock, key);
+    return atomic_get(&instance_data->link_up) && !negotiating;
+}
+
+/**
+ * @brief Announces every registered endpoint the peer has not bound yet. Repeated from the hello work until the
+ * peer has bound them all, as a request or its answer may be lost on the line or not fit in the TX queue.
+ */
+static void link_announce(const struct device *instance) {
+    const struct backend_config *config = instance->config;
+    struct backend_data *instance_data = instance->data;
+    bool unbound = false;
+
+    for (size_t i = 0; i < config->endpoint_count; ++i) {
+        struct backend_endpoint *endpoint = &config->endpoints[i];
+        if (endpoint->is_registered && !endpoint->is_bound) {
+            send_bind(instance, endpoint, UART_IPC_CONTROL_BIND_REQ);
+            unbound = true;
+        }
+    }
+    if (unbound) {
+        k_work_schedule(&instance_data->hello_work, K_MSEC(CONFIG_IPC_BACKEND_UART_HELLO_INTERVAL_MS));
+    }
+}
+
+/* The side with the larger session leads the baud rate negotiation */
+static bool rate_leads(struct backend_data *instance_data) {
+    return instance_data->link_session > instance_data->link_peer_session;
+}
+
+/* Switches the UART to a baud rate */
+static int rate_apply(const struct device *instance, uint32_t baudrate) {
+    const struct backend_config *config = instance->config;
+    struct uart_config uart_cfg;
+
+    int err = uart_config_get(config->uart_dev, &uart_cfg);
+    if (err == 0 && uart_cfg.baudrate != baudrate) {
+        uart_cfg.baudrate = baudrate;
+        err = uart_configure(config->uart_dev, &uart_cfg);
+    }
+    if (err) {
+        LOG_ERR("Could not switch to %u baud %d", baudrate, err);
+    }
+    return err;
+}
+
+/* The rate is one of the candidate rates of the instance */
+static bool rate_is_candidate(const struct backend_config *config, uint32_t baudrate) {
+    for (size_t i = 0; i < config->baud_rate_count; ++i) {
+        if (config->baud_rates[i] == baudrate) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/* Keeps the rate being tried. Called with the rate lock held */
+static void rate_commit(struct rate_state *rate) {
+    rate->rate = rate->trial;
+    rate->step = RATE_IDLE;
+    rate->errors = 0;
+    rate->errors_since = k_uptime_get_32();
+    LOG_INF("Switched to %u baud", rate->rate);
+}
+
+/**
+ * @brief Leader: asks the peer to try the slowest candidate rate above the rates tried so far and below the
+ * lowest rate that failed. Once there is none, the rate is settled and endpoints are announced.
+ */
+static void rate_step_up(const struct device *instance) {
+    const struct backend_config *config = instance->config;
+    struct backend_data *instance_data = instance->data;
+    struct rate_state *rate = &instance_data->rate;
+    uint32_t next = 0;
+    bool settled = false;
+
+    k_spinlock_key_t key = k_spin_lock(&rate->lock);
+    for (size_t i = 0; i < config->baud_rate_count; ++i) {
+        uint32_t candidate = config->baud_rates[i];
+        if (candidate > MAX(rate->rate, rate->tried) && candidate < rate->ceiling && (next == 0 || candidate < next)) {
+            next = candidate;
+        }
+    }
+    if (next != 0) {
+        rate->trial = next;
+        rate->tried = next;
+        rate->step = RATE_REQUESTED;
+    } else if (rate->negotiating) {
+        rate->negotiating = false;
+        settled = true;
+    }
+    uint32_t baudrate = rate->rate;
+    k_spin_unlock(&rate->lock, key);
+
+    if (next != 0) {
+        k_work_reschedule(&rate->work, K_MSEC(CONFIG_IPC_BACKEND_UART_RATE_TEST_TIMEOUT_MS));
+        link_send(instance, UART_IPC_LINK_RATE_REQ);
+    } else if (settled) {
+        LOG_INF("Link runs at %u baud", baudrate);
+        link_send(instance, UART_IPC_LINK_RATE_DONE);
+        link_announce(instance);
+    }
+}
+
+/**
+ * @brief Starts the baud rate negotiation once the link is up, if both sides have rates to step up to. The
+ * follower waits for the leader to settle, or to go quiet for twice the test timeout.
+ *
+ * @return true if endpoints are announced once the negotiation is done.
+ */
+static bool rate_negotiate(const struct device *instance, bool peer_has_rates) {
+    struct backend_data *instance_data = instance->data;
+    struct rate_state *rate = &instance_data->rate;
+
+    if (!peer_has_rates || !rate_enabled(instance)) {
+        return false;
+    }
+
+    k_spinlock_key_t key = k_spin_lock(&rate->lock);
+    rate->negotiating = true;
+    rate->tried = 0;
+    k_spin_unlock(&rate->lock, key);
+
+    if (rate_leads(instance_data)) {
+        rate_step_up(instance);
+    } else {
+        k_work_reschedule(&rate->work, K_MSEC(2 * CONFIG_IPC_BACKEND_UART_RATE_TEST_TIMEOUT_MS));
+    }
+    return true;
+}
+
+/**
+ * @brief Takes the next step of a baud rate change: switches to the accepted rate and starts the test, or gives
+ * up on a rate whose request or test timed out, or falls back to the default rate after too many errors.
+ */
+static void rate_handler(struct k_work *work) {
+    struct rate_state *rate = CONTAINER_OF(k_work_delayable_from_work(work), struct rate_state, work);
+    struct backend_data *instance_data = CONTAINER_OF(rate, struct backend_data, rate);
+    const struct device *instance = instance_data->control.instance;
+    bool leader = rate_leads(instance_data);
+    uint32_t apply = 0;
+    bool settled = false;
+
+    k_spinlock_key_t key = k_spin_lock(&rate->lock);
+    enum rate_step step = rate->step;
+    uint32_t trial = rate->trial;
+    switch (step) {
+        case RATE_SWITCHING:
+            rate->step = RATE_TESTING;
+            apply = rate->trial;
+            break;
+        case RATE_REQUESTED:
+        case RATE_TESTING:
+            rate->ceiling = rate->trial;
+            rate->step = RATE_IDLE;
+            apply = step == RATE_TESTING ? rate->rate : 0;
+            break;
+        case RATE_FALLBACK:
+            rate->ceiling = rate->rate;
+            rate->rate = rate->default_rate;
+            rate->step = RATE_IDLE;
+            rate->negotiating = false;
+            apply = rate->default_rate;
+            break;
+        case RATE_IDLE:
+            settled = rate->negotiating;  // Follower, the leader went quiet
+            rate->negotiating = false;
+            break;
+    }
+    bool negotiating = rate->negotiating;
+    k_spin_unlock(&rate->lock, key);
+
+    if (apply != 0) {
+        rate_apply(instance, apply);
+    }
+
+    switch (step) {
+        case RATE_SWITCHING:
+            k_work_schedule(&rate->work, K_MSEC(CONFIG_IPC_BACKEND_UART_RATE_TEST_TIMEOUT_MS));
+            if (leader) {
+                link_send(instance, UART_IPC_LINK_RATE_TEST);
+            }
+            break;
+        case RATE_REQUESTED:
+        case RATE_TESTING:
+            LOG_WRN("%u baud failed", trial);
+            if (leader) {
+                rate_step_up(instance);
+            } else if (negotiating) {
+                k_work_schedule(&rate->work, K_MSEC(2 * CONFIG_IPC_BACKEND_UART_RATE_TEST_TIMEOUT_MS));
+            }
+            tx_start_next(instance);  // Releases the held data frames
+            break;
+        case RATE_FALLBACK:
+            LOG_WRN("Too many errors, falling back to %u baud", apply);
+            STATS_INC(instance_data, baud_fallbacks);
+            atomic_clear(&instance_data->link_up);  // Both sides negotiate again below the failed rate
+            k_work_reschedule(&instance_data->hello_work, K_NO_WAIT);
+            tx_start_next(instance);
+            break;
+        case RATE_IDLE:
+            if (settled) {
+                LOG_WRN("Leader stopped negotiating the baud rate");
+                link_announce(instance);
+            }
+            break;
+    }
+}
+
+/**
+ * @brief Processes a baud rate negotiation message from the peer. Only called from the RX context.
+ *
+ * @param pattern_ok The message carried an intact test pattern, only checked for RATE_TEST.
+ */
+static void receive_rate(const struct device *instance, uint8_t type, const struct uart_ipc_rate *msg, bool pattern_ok) {
+    const struct backend_config *config = instance->config;
+    struct backend_data *instance_data = instance->data;
+    struct rate_state *rate = &instance_data->rate;
+    uint32_t baudrate = sys_le32_to_cpu(msg->baudrate);
+    uint32_t send = 0;              // BIT(enum uart_ipc_link_type) of the answers
+    k_timeout_t delay = K_FOREVER;  // Next step of the rate work
+    bool step_up = false;
+    bool settled = false;
+
+    k_spinlock_key_t key = k_spin_lock(&rate->lock);
+    switch (type) {
+        case UART_IPC_LINK_RATE_REQ:
+            if (rate->step == RATE_TESTING) {
+                rate_commit(rate);  // The leader moved on, so the test passed
+            }
+            rate->ack_rate = baudrate;
+            rate->ack_accepted = rate->step == RATE_IDLE && baudrate > rate->rate && baudrate < rate->ceiling &&
+                                 rate_is_candidate(config, baudrate);
+            if (rate->ack_accepted) {
+                rate->trial = baudrate;
+                rate->step = RATE_SWITCHING;
+                delay = K_MSEC(CONFIG_IPC_BACKEND_UART_RATE_SWITCH_DELAY_MS);
+            } else if (rate->negotiating) {
+                delay = K_MSEC(2 * CONFIG_IPC_BACKEND_UART_RATE_TEST_TIMEOUT_MS);
+            }
+            send = BIT(UART_IPC_LINK_RATE_ACK);
+            break;
+        case UART_IPC_LINK_RATE_ACK:
+            if (rate->step != RATE_REQUESTED || baudrate != rate->trial) {
+                break;  // Answer to a request that timed out
+            }
+            if (msg->accepted) {
+                rate->step = RATE_SWITCHING;
+                delay = K_MSEC(CONFIG_IPC_BACKEND_UART_RATE_SWITCH_DELAY_MS);
+            } else {
+                rate->step = RATE_IDLE;
+                step_up = true;
+            }
+            break;
+        case UART_IPC_LINK_RATE_TEST:
+            if (rate->step != RATE_TESTING || baudrate != rate->trial || !pattern_ok) {
+                break;
+            }
+            if (rate_leads(instance_data)) {
+                rate_commit(rate);
+                step_up = true;
+            } else {
+                send = BIT(UART_IPC_LINK_RATE_TEST);
+                delay = K_MSEC(CONFIG_IPC_BACKEND_UART_RATE_TEST_TIMEOUT_MS);
+            }
+            break;
+        case UART_IPC_LINK_RATE_DONE:
+            if (rate->step == RATE_TESTING && baudrate == rate->trial) {
+                rate_commit(rate);
+            }
+            settled = rate->negotiating;
+            rate->negotiating = false;
+            break;
+    }
+    k_spin_unlock(&rate->lock, key);
+
+    if (!K_TIMEOUT_EQ(delay, K_FOREVER)) {
+        k_work_reschedule(&rate->work, delay);
+    } else if (step_up || settled) {
+        k_work_cancel_delayable(&rate->work);
+    }
+    if (send != 0) {
+        atomic_or(&instance_data->link_due, send);
+    }
+    if (step_up) {
+        rate_step_up(instance);
+    }
+    if (settled) {
+        link_announce(instance);
+    }
+    tx_start_next(instance);
+}
+
+/**
+ * @brief Counts an RX error. Too many errors within CONFIG_IPC_BACKEND_UART_RATE_ERROR_WINDOW_MS at a negotiated
+ * rate fall back to the default rate, and the rate is negotiated again below the one that failed.
+ */
+static void rate_rx_error(const struct device *instance) {
+    struct backend_data *instance_data = instance->data;
+    struct rate_state *rate = &instance_data->rate;
+    uint32_t now = k_uptime_get_32();
+    bool fallback = false;
+
+    k_spinlock_key_t key = k_spin_lock(&rate->lock);
+    if (rate->step == RATE_IDLE && rate->rate != rate->default_rate) {
+        if (now - rate->errors_since > CONFIG_IPC_BACKEND_UART_RATE_ERROR_WINDOW_MS) {
+            rate->errors = 0;
+            rate->errors_since = now;
+        }
+        fallback = ++rate->errors >= CONFIG_IPC_BACKEND_UART_RATE_MAX_ERRORS;
+        if (fallback) {
+            rate->step = RATE_FALLBACK;
+        }
+    }
+    k_spin_unlock(&rate->lock, key);
+
+    if (fallback) {
+        k_work_reschedule(&rate->work, K_NO_WAIT);
+    }
+}
+
+/* Picks up the rate the UART was opened with, which both sides start from and fall back to */
+static void rate_open(const struct device *instance) {
+    const struct backend_config *config = instance->config;
+    struct backend_data *instance_data = instance->data;
+    struct uart_config uart_cfg;
+
+    int err = uart_config_get(config->uart_dev, &uart_cfg);
+    if (err) {
+        LOG_WRN("Could not read the baud rate, not negotiating one %d", err);
+        return;
+    }
+    instance_data->rate.default_rate = uart_cfg.baudrate;
+    instance_data->rate.rate = uart_cfg.baudrate;
+}
+
+/* Returns to the default rate and forgets the rates that failed, as a restarted peer starts over */
+static void rate_reset(const struct device *instance) {
+    struct backend_data *instance_data = instance->data;
+    struct rate_state *rate = &instance_data->rate;
+
+    k_work_cancel_delayable(&rate->work);
+    k_spinlock_key_t key = k_spin_lock(&rate->lock);
+    bool switched = rate->step == RATE_TESTING || rate->rate != rate->default_rate;
+    rate->rate = rate->default_rate;
+    rate->ceiling = UINT32_MAX;
+    rate->negotiating = false;
+    rate->step = RATE_IDLE;
+    k_spin_unlock(&rate->lock, key);
+
+    if (switched) {
+        rate_apply(instance, rate->default_rate);
+    }
+}
+
+static void rate_init(struct rate_state *rate) {
+    rate->default_rate = 0;
+    rate->rate = 0;
+    rate->ceiling = UINT32_MAX;
+    rate->negotiating = false;
+    rate->step = RATE_IDLE;
+    k_work_init_delayable(&rate->work, rate_handler);
+}
+
+/* Starts adapting from the largest fragment agreed in the hello exchange, which the peer starts with as well */
+static void frag_reset(struct backend_data *instance_data) {
+    instance_data->tx_frag_size = instance_data->frag_max;
+    instance_data->frag.rx_size = instance_data->frag_max;
+    instance_data->frag.rx_largest = 0;
+    instance_data->frag.window_frames = 0;
+    instance_data->frag.window_errors = 0;
+}
+
+/**
+ * @brief Counts a received frame for the adaptive fragment size, and asks the peer for another size at the end of
+ * a window if the error rate calls for it. The request is repeated if the peer sent larger fragments than asked,
+ * in case it was lost. Only called from the RX context.
+ *
+ * @param frag_len Length of the fragment of a valid frame, ignored for corrupted ones.
+ */
+static void frag_rx_count(const struct device *instance, bool corrupted, size_t frag_len) {
+    const struct backend_config *config = instance->config;
+    struct backend_data *instance_data = instance->data;
+    struct frag_state *frag = &instance_data->frag;
+
+    if (!config->adaptive_frag || !atomic_get(&instance_data->link_up)) {
+        return;
+    }
+    frag->window_frames++;
+    if (corrupted) {
+        frag->window_errors++;
+    } else {
+        frag->rx_largest = MAX(frag->rx_largest, frag_len);
+    }
+    if (frag->window_frames < CONFIG_IPC_BACKEND_UART_FRAG_WINDOW) {
+        return;
+    }
+
+    uint8_t size = frag->rx_size;
+    if (frag->window_errors >= CONFIG_IPC_BACKEND_UART_FRAG_SHRINK_ERRORS) {
+        size = MAX(size / 2, MIN(UART_IPC_FRAG_MIN_SIZE, instance_data->frag_max));
+    } else if (frag->window_errors == 0) {
+        size = MIN(size + UART_IPC_FRAG_GROW_STEP, instance_data->frag_max);
+    }
+    bool resend = frag->rx_largest > size;
+    frag->window_frames = 0;
+    frag->window_errors = 0;
+    frag->rx_largest = 0;
+
+    if (size != frag->rx_size) {
+        LOG_DBG("Asking for fragments of %d bytes", size);
+        STATS_INC(instance_data, frag_size_changes);
+        frag->rx_size = size;
+        resend = true;
+    }
+    if (resend) {
+        link_send(instance, UART_IPC_LINK_FRAG_SIZE);
+    }
+}
+
+/* Sends fragments of the size the peer asked for, within the size agreed in the hello exchange */
+static void receive_frag_size(const struct device *instance, const struct uart_ipc_frag_size *msg) {
+    struct backend_data *instance_data = instance->data;
+
+    if (msg->frag_size == 0) {
+        LOG_ERR("Peer asked for empty fragments");
+        return;
+    }
+    instance_data->tx_frag_size = MIN(msg->frag_size, instance_data->frag_max);
+    LOG_DBG("Sending fragments of %d bytes", instance_data->tx_frag_size);
+}
+
+/**
+ * @brief Starts the link over after the peer restarted. Its endpoints are unbound until it announces them again,
+ * and reliable mode, flow control and the baud rate start from scratch as they do on the peer. Transfers cut
+ * short by the restart are dropped in both directions. Only called from the RX context.
+ */
+static void link_reset(const struct device *instance) {
+    const struct backend_config *config = instance->config;
+    struct backend_data *instance_data = instance->data;
+
+    atomic_clear(&instance_data->link_up);
+    for (size_t i = 0; i < config->endpoint_count; ++i) {
+        config->endpoints[i].is_bound = false;
+        if (config->endpoints[i].is_registered) {
+            endpoint_rx_reset(&config->endpoints[i]);
+        }
+    }
+    endpoint_rx_reset(&instance_data->control);
+    for (size_t prio = 0; prio < CONFIG_IPC_BACKEND_UART_TX_PRIO_COUNT; ++prio) {
+        endpoint_rx_reset(&instance_data->batches[prio]);
+    }
+    atomic_set(&instance_data->tx_drop_partial, 1);
+    arq_reset(instance);
+    credit_reset(instance);
+    rate_reset(instance);
+    k_work_schedule(&instance_data->hello_work, K_MSEC(CONFIG_IPC_BACKEND_UART_HELLO_INTERVAL_MS));
+    report_error(instance, "Peer restarted, binding endpoints again");
+}
+
+/**
+ * @brief Processes a hello from the peer. A new session means the peer has started or restarted. The link is up
+ * once the peer echoes the local session, and hellos from a peer whose link is not up are answered, so that the
+ * handshake takes three hellos at most. Both sides send fragments of the smaller of their fragment sizes. Once
+ * the link is up the baud rate is negotiated, then endpoints are announced, and bind when the peer answers.
+ * Only called from the RX context.
+ */
+static void receive_hello(const struct device *instance, const uint8_t *msg, size_t len) {
+    const struct backend_config *config = instance->config;
+    struct backend_data *instance_data = instance->data;
+    struct uart_ipc_hello hello;
+
+    if (len < sizeof(hello)) {
+        LOG_ERR("Malformed hello");
+        return;
+    }
+    memcpy(&hello, msg, sizeof(hello));
+
+    if (hello.version != UART_IPC_PROTOCOL_VERSION) {
+        LOG_ERR("Peer uses protocol version %d, expected %d", hello.version, UART_IPC_PROTOCOL_VERSION);
+        return;
+    }
+    if (hello.capabilities != link_capabilities(config)) {
+        LOG_ERR("Peer capabilities 0x%02x do not match 0x%02x", hello.capabilities, link_capabilities(config));
+        return;
+    }
+    if (hello.frag_size == 0) {
+        LOG_ERR("Peer sends empty fragments");
+        return;
+    }
+
+    uint32_t session = sys_le32_to_cpu(hello.session);
+    if (session != instance_data->link_peer_session) {
+        if (instance_data->link_peer_session != 0) {
+            LOG_WRN("Peer restarted");
+            link_reset(instance);
+        }
+        instance_data->link_peer_session = session;
+    }
+    instance_data->frag_max = MIN(config->frag_size, hello.frag_size);
+
+    bool established = !atomic_get(&instance_data->link_up) && sys_le32_to_cpu(hello.peer_session) == instance_data->link_session;
+    if (established) {
+        frag_reset(instance_data);
+        atomic_set(&instance_data->link_up, 1);
+        k_work_cancel_delayable(&instance_data->hello_work);
+        STATS_INC(instance_data, link_ups);
+        LOG_INF("Link up, sending fragments of %d bytes", instance_data->tx_frag_size);
+    }
+    if (!(hello.flags & UART_IPC_HELLO_FLAG_UP)) {
+        link_send(instance, UART_IPC_LINK_HELLO);  // Goes out ahead of the rate negotiation and the endpoint announcements
+    }
+    if (established && !rate_negotiate(instance, hello.flags & UART_IPC_HELLO_FLAG_RATES)) {
+        link_announce(instance);
+    }
+}
+
+/* Processes a link management frame from the peer. Only called from the RX context */
+static void receive_link(const struct device *instance, const uint8_t *msg, size_t len) {
+    const struct uart_ipc_link_header *header = (const struct uart_ipc_link_header *)msg;
+
+    if (len < sizeof(*header)) {
+        LOG_ERR("Malformed link message");
+        return;
+    }
+    msg += sizeof(*header);
+    len -= sizeof(*header);
+
+    switch (header->type) {
+        case UART_IPC_LINK_HELLO:
+            receive_hello(instance, msg, len);
+            break;
+        case UART_IPC_LINK_RATE_REQ:
+        case UART_IPC_LINK_RATE_ACK:
+        case UART_IPC_LINK_RATE_TEST:
+        case UART_IPC_LINK_RATE_DONE: {
+            struct uart_ipc_rate rate_msg;
+            if (len < sizeof(rate_msg)) {
+                LOG_ERR("Malformed rate message");
+                return;
+            }
+            memcpy(&rate_msg, msg, sizeof(rate_msg));
+            bool pattern_ok = len == sizeof(rate_msg) + sizeof(rate_test_pattern) &&
+                              memcmp(msg + sizeof(rate_msg), rate_test_pattern, sizeof(rate_test_pattern)) == 0;
+            receive_rate(instance, header->type, &rate_msg, pattern_ok);
+            break;
+        }
+        case UART_IPC_LINK_FRAG_SIZE: {
+            struct uart_ipc_frag_size frag_msg;
+            if (len < sizeof(frag_msg)) {
+                LOG_ERR("Malformed fragment size message");
+                return;
+            }
+            memcpy(&frag_msg, msg, sizeof(frag_msg));
+            receive_frag_size(instance, &frag_msg);
+            break;
+        }
+        default:
+            LOG_WRN("Unknown link message type %d", header->type);
+            break;
+    }
+}
+
+static void control_init(const struct device *instance) {
+    struct backend_data *data = instance->data;
+
+    endpoint_init(&data->control, instance, UART_IPC_ADDR_CONTROL);
+    data->control.cfg.name = "";
+    data->control.cfg.cb.received = receive_control;
+    data->control.cfg.priv = (void *)instance;
+    data->control.remote_addr = UART_IPC_ADDR_CONTROL;
+    data->control.is_registered = true;
+    data->control.is_bound = true;
+
+    for (size_t prio = 0; prio < CONFIG_IPC_BACKEND_UART_TX_PRIO_COUNT; ++prio) {
+        struct backend_endpoint *batch = &data->batches[prio];
+        endpoint_init(batch, instance, UART_IPC_ADDR_BATCH + prio);
+        batch->cfg.name = "";
+        batch->cfg.cb.received = receive_batch;
+        batch->cfg.priv = (void *)instance;
+        batch->tx_prio = prio;
+        batch->remote_addr = UART_IPC_ADDR_BATCH + prio;
+        batch->is_registered = true;
+        batch->is_bound = true;
+    }
+
+    data->link_session = 0;
+    data->link_peer_session = 0;
+    atomic_clear(&data->link_up);
+    atomic_clear(&data->link_due);
+    k_work_init_delayable(&data->hello_work, hello_handler);
+    rate_init(&data->rate);
+    data->frag_max = ((const struct backend_config *)instance->config)->frag_size;
+    frag_reset(data);
+}
+
+/**
+ * @brief Keeps the reassembly buffer of the message being delivered after the receive callback returns.
+ * Must be called from within the receive callback. The buffer is later returned with release_rx_buffer.
+ */
+static int hold_rx_buffer(const struct device *instance, void *token, void *data) {
+    struct backend_endpoint *endpoint = (struct backend_endpoint *)token;
+
+    if (endpoint == NULL || data == NULL) {
+        return -EINVAL;
+    }
+
+    /* Only a completely received buffer that is currently being delivered can be held */
+    if (data != endpoint->rx_buffer || endpoint->bytes_received != endpoint->rx_buf_size) {
+        LOG_ERR("Buffer <%p> is not being delivered", data);
+        return -EINVAL;
+    }
+
+    if (endpoint->hold_rx_buf) {
+        return -EALREADY;
+    }
+
+    for (size_t i = 0; i < ARRAY_SIZE(endpoint->held_rx_bufs); i++) {
+        if (atomic_ptr_cas(&endpoint->held_rx_bufs[i], NULL, data)) {
+            endpoint->hold_rx_buf = true;
+            return 0;
+        }
+    }
+
+    LOG_ERR("Endpoint already holds %d rx buffers", CONFIG_IPC_BACKEND_UART_RX_HOLD_COUNT);
+    return -ENOMEM;
+}
+
+static int release_rx_buffer(const struct device *instance, void *token, void *data) {
+    const struct backend_config *config = instance->config;
+    struct backend_endpoint *endpoint = (struct backend_endpoint *)token;
+
+    if (endpoint == NULL || data == NULL) {
+        return -EINVAL;
+    }
+
+    /* Only buffers recorded by hold_rx_buffer for this endpoint are freed, each of them once */
+    for (size_t i = 0; i < ARRAY_SIZE(endpoint->held_rx_bufs); i++) {
+        if (atomic_ptr_cas(&endpoint->held_rx_bufs[i], data, NULL)) {
+            msg_free(config->rx_msg_pool, data);
+            return 0;
+        }
+    }
+
+    LOG_ERR("Buffer <%p> is not held by endpoint", data);
+    return -EINVAL;
+}
+
+const static struct ipc_service_backend backend_ops = {
+    .open_instance = open_instance,
+    .register_endpoint = register_endpoint,
+    .send = send,
+    .get_tx_buffer = get_tx_buffer,
+    .drop_tx_buffer = drop_tx_buffer,
+    .send_nocopy = send_nocopy,
+    .hold_rx_buffer = hold_rx_buffer,
+    .release_rx_buffer = release_rx_buffer,
+};
+
+int uart_ipc_stats_get(const struct device *instance, struct uart_ipc_stats *stats) {
+#ifdef CONFIG_IPC_BACKEND_UART_STATS
+    if (instance == NULL || stats == NULL || instance->api != &backend_ops) {
+        return -EINVAL;
+    }
+    struct backend_stats *instance_stats = &((struct backend_data *)instance->data)->stats;
+
+#define STATS_COUNTER_GET(name, description) stats->name = atomic_get(&instance_stats->counters[STATS_##name]);
+    UART_IPC_STATS_COUNTERS(STATS_COUNTER_GET)
+#undef STATS_COUNTER_GET
+    for (size_t i = 0; i < UART_IPC_STATS_HIST_BUCKETS; ++i) {
+        stats->tx_latency[i] = atomic_get(&instance_stats->tx_latency[i]);
+        stats->rx_reassembly[i] = atomic_get(&instance_stats->rx_reassembly[i]);
+    }
+    return 0;
+#else
+    return -ENOTSUP;
+#endif
+}
+
+int uart_ipc_stats_reset(const struct device *instance) {
+#ifdef CONFIG_IPC_BACKEND_UART_STATS
+    if (instance == NULL || instance->api != &backend_ops) {
+        return -EINVAL;
+    }
+    struct backend_stats *instance_stats = &((struct backend_data *)instance->data)->stats;
+
+    for (size_t i = 0; i < STATS_COUNTER_COUNT; ++i) {
+        atomic_clear(&instance_stats->counters[i]);
+    }
+    for (size_t i = 0; i < UART_IPC_STATS_HIST_BUCKETS; ++i) {
+        atomic_clear(&instance_stats->tx_latency[i]);
+        atomic_clear(&instance_stats->rx_reassembly[i]);
+    }
+    return 0;
+#else
+    return -ENOTSUP;
+#endif
+}
+
+static void tx_queues_init(struct backend_data *data, char *queue_buf) {
+    const size_t queue_size = CONFIG_IPC_BACKEND_UART_TX_QUEUE_SIZE * sizeof(struct tx_request);
+
+    for (size_t prio = 0; prio < CONFIG_IPC_BACKEND_UART_TX_PRIO_COUNT; ++prio) {
+        k_msgq_init(&data->tx_queues[prio], queue_buf + prio * queue_size, sizeof(struct tx_request), CONFIG_IPC_BACKEND_UART_TX_QUEUE_SIZE);
+        data->tx_active[prio].data = NULL;
+    }
+    memset(data->tx_frames, 0, sizeof(data->tx_frames));
+    data->tx_line = 0;
+    atomic_clear(&data->tx_busy);
+
+    for (size_t prio = 0; prio < CONFIG_IPC_BACKEND_UART_TX_PRIO_COUNT; ++prio) {
+        data->tx_batches[prio].buf = NULL;
+        data->tx_batches[prio].len = 0;
+    }
+    k_work_init_delayable(&data->tx_batch_work, tx_batch_handler);
+}
+
+static int backend_init(const struct device *dev) {
+    const struct backend_config *config = dev->config;
+    struct backend_data *data = dev->data;
+    data->is_opened = false;
+
+    if (!device_is_ready(config->uart_dev)) {
+        LOG_ERR("UART device %s is not ready", config->uart_dev->name);
+        return -ENODEV;
+    }
+    data->rx_timeout = K_USEC(config->rx_timeout_usec);
+    data->tx_slab = config->tx_slab;
+    data->rx_slab = config->rx_slab;
+    control_init(dev);
+
+    tx_queues_init(data, config->tx_queue_buf);
+    arq_init(dev);
+    credit_init(dev);
+#ifdef CONFIG_IPC_BACKEND_UART_RX_THREAD
+    k_sem_init(&data->rx_sem, 0, 1);
+    k_thread_create(&data->rx_thread, config->rx_stack, CONFIG_IPC_BACKEND_UART_RX_THREAD_STACK_SIZE,
+                    rx_thread_entry, (void *)dev, NULL, NULL,
+                    CONFIG_IPC_BACKEND_UART_RX_THREAD_PRIORITY, 0, K_NO_WAIT);
+    k_thread_name_set(&data->rx_thread, dev->name);
+#endif
+    return 0;
+}
+
+/**
+ * @brief Prepares the reassembly buffer of an endpoint for a new fragment, allocating it for the first one.
+ *
+ * @return 0 on success, -EINVAL if the fragment cannot start a new transfer, -EMSGSIZE if the message is larger
+ * than a reassembly buffer, -ENOMEM if allocation fails.
+ */
+static int rx_buffer_start(struct backend_endpoint *endpoint, uint16_t total_data_length, uint16_t frag_start, bool compressed,
+                           k_timeout_t rx_timeout) {
+    if (endpoint->cfg.cb.received == NULL) {
+        LOG_INF("Received data but no receive callback registered");
+        return -EINVAL;
+    }
+
+    if (!K_TIMEOUT_EQ(rx_timeout, K_FOREVER)) {
         k_work_cancel_delayable(&endpoint->rx_timeout_work); /* New frame received, cancel timeout */
     }
 
-    if (endpoint->rx_buffer == NULL) {
-        if (frame->frag_start != 0) {
-            LOG_ERR("New buffer started, but fragment starts at byte %d", frame->frag_start);
-            return -EINVAL;
+    /* A fragment that does not continue the transfer means that fragments were lost, the transfer cannot complete */
+    if (endpoint->rx_buffer != NULL &&
+        (frag_start == 0 || total_data_length != endpoint->rx_buf_size || frag_start != endpoint->bytes_received)) {
+        LOG_WRN("Dropping incomplete transfer, %zu of %zu bytes received", endpoint->bytes_received, endpoint->rx_buf_size);
+        endpoint_rx_drop(endpoint);
+    }
+
+    if (endpoint->rx_buffer == NULL) {
+        if (frag_start != 0) {
+            LOG_ERR("New buffer started, but fragment starts at byte %d", frag_start);
+            return -EINVAL;
+        }
+        if (!msg_fits(rx_msg_pool(endpoint), total_data_length)) {
+            LOG_ERR("Message of %d bytes is larger than max_message_size", total_data_length);
+            return -EMSGSIZE;
+        }
+        endpoint->bytes_received = 0;
+        endpoint->rx_buffer = msg_alloc(rx_msg_pool(endpoint), total_data_length);
+        if (endpoint->rx_buffer == NULL) {
+            LOG_ERR("Failed to allocate memory for rx buffer");
+            STATS_INC((struct backend_data *)endpoint->instance->data, heap_failures);
+            return -ENOMEM;
+        }
+        endpoint->rx_started_at = STATS_TIMESTAMP();
+        endpoint->rx_buf_size = total_data_length;
+        endpoint->rx_compressed = compressed;
+    }
+    return 0;
+}
+
+/**
+ * @brief Replaces the reassembled compressed message of an endpoint with the decompressed message.
+ *
+ * @return 0 on success, -EINVAL if the message is malformed, -EMSGSIZE if it decompresses to more than a
+ * reassembly buffer, -ENOMEM if allocation fails.
+ */
+static int rx_decompress(struct backend_endpoint *endpoint) {
+    const size_t header_len = sizeof(struct uart_ipc_compressed_header);
+
+    if (endpoint->rx_buf_size <= header_len) {
+        return -EINVAL;
+    }
+    size_t len = sys_get_le16(endpoint->rx_buffer);
+    if (len == 0) {
+        return -EINVAL;
+    }
+    if (!msg_fits(rx_msg_pool(endpoint), len)) {
+        return -EMSGSIZE;
+    }
+
+    uint8_t *buf = msg_alloc(rx_msg_pool(endpoint), len);
+    if (buf == NULL) {
+        STATS_INC((struct backend_data *)endpoint->instance->data, heap_failures);
+        return -ENOMEM;
+    }
+    int decompressed_len = uart_ipc_lz_decompress(buf, len, endpoint->rx_buffer + header_len, endpoint->rx_buf_size - header_len);
+    if (decompressed_len != (int)len) {
+        msg_free(rx_msg_pool(endpoint), buf);
+        return -EINVAL;
+    }
+
+    msg_free(rx_msg_pool(endpoint), endpoint->rx_buffer);
+    endpoint->rx_buffer = buf;
+    endpoint->rx_buf_size = len;
+    endpoint->bytes_received = len;
+    return 0;
+}
+
+/**
+ * @brief Accounts for a fragment written to the reassembly buffer. Delivers the data once the transfer is
+ * complete, otherwise starts the timeout for the next frame.
+ */
+static void rx_fragment_added(struct backend_endpoint *endpoint, size_t fragment_size, k_timeout_t rx_timeout) {
+    endpoint->bytes_received += fragment_size;
+
+    if (endpoint->bytes_received == endpoint->rx_buf_size) {
+        if (endpoint->rx_compressed) {
+            int err = rx_decompress(endpoint);
+            if (err) {
+                LOG_ERR("Failed to decompress message %d", err);
+                endpoint_rx_drop(endpoint);
+                if (endpoint->cfg.cb.error != NULL) {
+                    endpoint->cfg.cb.error("Received message could not be decompressed", endpoint->cfg.priv);
+                }
+                return;
+            }
         }
+        stats_rx_done(endpoint);
+        endpoint->hold_rx_buf = false;
+        endpoint->cfg.cb.received(endpoint->rx_buffer, endpoint->bytes_received, endpoint->cfg.priv);
+        if (!endpoint->hold_rx_buf) {
+            msg_free(rx_msg_pool(endpoint), endpoint->rx_buffer);
+        }
+        /* A held buffer now belongs to the receiver, reassembly continues in a new buffer */
+        endpoint->hold_rx_buf = false;
         endpoint->bytes_received = 0;
-        endpoint->rx_buffer = k_malloc(frame->total_data_length);
-        if (endpoint->rx_buffer == NULL) {
-            LOG_ERR("Failed to allocate memory for rx buffer");
-            return -ENOMEM;
+        endpoint->rx_buffer = NULL;
+        return;
+    }
+    k_work_reschedule(&endpoint->rx_timeout_work, rx_timeout); /* Start timeout for next frame */
+}
+
+/* Endpoint receiving the frames sent from a peer address, NULL if no local endpoint is bound to it */
+static struct backend_endpoint *endpoint_by_remote_addr(const struct device *instance, uint8_t addr) {
+    const struct backend_config *config = instance->config;
+    struct backend_data *data = instance->data;
+
+    if (addr == UART_IPC_ADDR_CONTROL) {
+        return &data->control;
+    }
+    if (addr >= UART_IPC_ADDR_BATCH && addr < UART_IPC_ADDR_BATCH + CONFIG_IPC_BACKEND_UART_TX_PRIO_COUNT) {
+        return &data->batches[addr - UART_IPC_ADDR_BATCH];
+    }
+    for (size_t i = 0; i < config->endpoint_count; ++i) {
+        struct backend_endpoint *endpoint = &config->endpoints[i];
+        if (endpoint->is_registered && endpoint->is_bound && endpoint->remote_addr == addr) {
+            return endpoint;
+        }
+    }
+    LOG_WRN("Dropping frame from unbound peer address %d", addr);
+    return NULL;
+}
+
+/**
+ * @brief Receive callback of the batch channel. Delivers every record of a batch as a separate message to the
+ * endpoint bound to its address. Records point into the batch, so they cannot be held with hold_rx_buffer.
+ */
+static void receive_batch(const void *msg, size_t len, void *priv) {
+    const struct device *instance = priv;
+    const uint8_t *pos = msg;
+    const uint8_t *end = pos + len;
+
+    while (pos < end) {
+        const struct uart_ipc_batch_record *record = (const struct uart_ipc_batch_record *)pos;
+        if ((size_t)(end - pos) < sizeof(*record) || (size_t)(end - pos) - sizeof(*record) < record->len) {
+            LOG_ERR("Malformed batch");
+            return;
+        }
+        pos += sizeof(*record);
+
+        struct backend_endpoint *endpoint = record->addr < UART_IPC_ADDR_BATCH ? endpoint_by_remote_addr(instance, record->addr) : NULL;
+        if (endpoint != NULL && endpoint->cfg.cb.received != NULL) {
+            endpoint->cfg.cb.received(pos, record->len, endpoint->cfg.priv);
         }
-        endpoint->rx_buf_size = frame->total_data_length;
+        pos += record->len;
+    }
+}
+
+/* Adds the fragment of a valid fixed size frame to the reassembly buffer of the addressed endpoint */
+static int receive_frame_fragment(const struct device *instance, struct uart_ipc_frame *frame, k_timeout_t rx_timeout) {
+    struct backend_endpoint *endpoint = endpoint_by_remote_addr(instance, frame->addr);
+    if (endpoint == NULL) {
+        return 0;
+    }
+
+    int err = rx_buffer_start(endpoint, sys_le16_to_cpu(frame->total_data_length), sys_le16_to_cpu(frame->frag_start), false, rx_timeout);
+    if (err) {
+        return err;
     }
 
     size_t fragment_size = 0;
-    int err = unwrap_frame(endpoint->rx_buffer, endpoint->rx_buf_size, frame, &fragment_size);
+    err = unwrap_frame(endpoint->rx_buffer, endpoint->rx_buf_size, frame, &fragment_size);
     if (err) {
         return err;
     }
 
-    endpoint->bytes_received += fragment_size;
+    rx_fragment_added(endpoint, fragment_size, rx_timeout);
+    return 0;
+}
 
-    if (endpoint->bytes_received == frame->total_data_length) {
-        endpoint->cfg.cb.received(endpoint->rx_buffer, endpoint->bytes_received, endpoint->cfg.priv);
-        if (!endpoint->hold_rx_buf) {
-            k_free((void *)endpoint->rx_buffer);
+/**
+ * @brief Validates a fixed size frame and adds its fragment to the reassembly buffer of the addressed endpoint.
+ * Frames without a fragment only carry flow control state.
+ *
+ * @return 0 on success or if the frame was for an unbound address, -EBADMSG if the frame is corrupted or
+ * misaligned, other negative errno if a valid frame could not be received.
+ */
+static inline int receive_frame(const struct device *instance, struct uart_ipc_frame *frame, k_timeout_t rx_timeout) {
+    const struct backend_config *config = instance->config;
+
+    struct backend_data *instance_data = instance->data;
+
+    int err = check_frame(frame);
+    if (err) {
+        /* Candidates tried while resynchronizing are not counted, they mostly are not frame starts */
+        if (!instance_data->rx_resyncing &&
+            frame_header_plausible(sys_le16_to_cpu(frame->total_data_length), sys_le16_to_cpu(frame->frag_start), frame->frag_len)) {
+            STATS_INC(instance_data, crc_errors);
         }
-        endpoint->bytes_received = 0;
-        endpoint->rx_buffer = NULL;
+        return err;
+    }
+    STATS_INC(instance_data, rx_frames);
+
+    if (frame->addr == UART_IPC_ADDR_LINK) {
+        receive_link(instance, frame->frag, frame->frag_len);
         return 0;
     }
-    k_work_reschedule(&endpoint->rx_timeout_work, rx_timeout); /* Start timeout for next frame */
+    if (frame->frag_len > 0) {
+        err = receive_frame_fragment(instance, frame, rx_timeout);
+    }
+    if (config->flow_control) {
+        const struct frame_info info = {
+            .flags = frame->frag_len == 0 ? COBS_FLAG_NO_DATA : 0,
+            .frag_start = sys_le16_to_cpu(frame->frag_start),
+            .credit = {.count = frame->credit_count, .limit = frame->credit_limit},
+        };
+        credit_receive(instance, &info);
+    }
+    return err;
+}
+
+
+/**
+ * @brief Adds a fragment to the reassembly buffer of the endpoint bound to the sending address.
+ *
+ * @return 0 on success or if the fragment was for an unbound address, negative errno on failure: -EINVAL if
+ * the fragment cannot start a transfer, -EMSGSIZE if the message is larger than a reassembly buffer, -ENOMEM
+ * if it does not fit in the transfer or the reassembly buffer could not be allocated.
+ */
+static int receive_fragment(const struct device *instance, const struct frame_info *info, k_timeout_t rx_timeout) {
+    struct backend_endpoint *endpoint = endpoint_by_remote_addr(instance, info->addr);
+    if (endpoint == NULL) {
+        return 0;
+    }
+
+    int err = rx_buffer_start(endpoint, info->total_data_length, info->frag_start, info->flags & COBS_FLAG_COMPRESSED, rx_timeout);
+    if (err) {
+        return err;
+    }
+
+    if (info->frag_start + info->frag_len > endpoint->rx_buf_size) {
+        LOG_ERR("Frame overflows destination buffer");
+        return -ENOMEM;
+    }
+    memcpy(endpoint->rx_buffer + info->frag_start, info->frag, info->frag_len);
+
+    rx_fragment_added(endpoint, info->frag_len, rx_timeout);
     return 0;
 }
 
+/**
+ * @brief Delivers reliable mode frames in sequence order. Frames received after a lost one are kept until it
+ * has been retransmitted, duplicates are dropped. Every data frame is acknowledged, either with the next frame
+ * sent to the peer or with a bare acknowledgement after CONFIG_IPC_BACKEND_UART_ARQ_ACK_DELAY_MS. Only called
+ * from the RX context.
+ *
+ * @return 0 on success, the error of the last fragment that could not be received otherwise.
+ */
+static int arq_receive_frame(const struct device *instance, const struct frame_info *info, k_timeout_t rx_timeout) {
+    const struct backend_config *config = instance->config;
+    struct arq_state *arq = config->arq;
+    uint8_t distance = info->arq.seq - arq->rx_expected;  // rx_expected is only written from the RX context
+    int err = 0;
+
+    if (distance == 0) {
+        err = receive_fragment(instance, info, rx_timeout);
+
+        bool stored;
+        do {
+            k_spinlock_key_t key = k_spin_lock(&arq->lock);
+            arq->rx_expected++;
+            stored = arq->rx_sack & BIT(0);
+            arq->rx_sack >>= 1;
+            k_spin_unlock(&arq->lock, key);
+
+            if (stored) {
+                const struct arq_frame *frame = &arq->rx_frames[arq_slot(arq->rx_expected)];
+                const struct frame_info next = {
+                    .flags = frame->flags,
+                    .addr = frame->addr,
+                    .total_data_length = frame->total_data_length,
+                    .frag_start = frame->frag_start,
+                    .frag = frame->frag,
+                    .frag_len = frame->frag_len,
+                };
+                int next_err = receive_fragment(instance, &next, rx_timeout);
+                err = next_err ? next_err : err;
+            }
+        } while (stored);
+    } else if (distance < ARQ_WINDOW) {
+        if (!(arq->rx_sack & BIT(distance - 1))) {
+            struct arq_frame *frame = &arq->rx_frames[arq_slot(info->arq.seq)];
+            frame->flags = info->flags & COBS_FLAG_COMPRESSED;
+            frame->addr = info->addr;
+            frame->total_data_length = info->total_data_length;
+            frame->frag_start = info->frag_start;
+            frame->frag_len = info->frag_len;
+            memcpy(frame->frag, info->frag, info->frag_len);
+
+            k_spinlock_key_t key = k_spin_lock(&arq->lock);
+            arq->rx_sack |= BIT(distance - 1);
+            k_spin_unlock(&arq->lock, key);
+        }
+    } else {
+        LOG_DBG("Dropping duplicate frame %d", info->arq.seq);
+    }
+
+    k_spinlock_key_t key = k_spin_lock(&arq->lock);
+    arq->ack_due = true;
+    k_spin_unlock(&arq->lock, key);
+    k_work_schedule(&arq->ack_work, K_MSEC(CONFIG_IPC_BACKEND_UART_ARQ_ACK_DELAY_MS));
+    return err;
+}
+
+/**
+ * @brief Repairs a received frame followed by its parity bytes in place.
+ *
+ * @return Length of the frame without the parity bytes, or -EBADMSG if it has more corrupted bytes than the
+ * parity repairs.
+ */
+static int fec_correct(const struct device *instance, uint8_t *frame, size_t len) {
+    struct backend_data *instance_data = instance->data;
+
+    if (len < UART_IPC_FEC_PARITY_LEN) {
+        return -EBADMSG;
+    }
+    len -= UART_IPC_FEC_PARITY_LEN;
+    int corrected = uart_ipc_fec_decode(frame, len, frame + len);
+    if (corrected < 0) {
+        STATS_INC(instance_data, fec_failures);
+        return corrected;
+    }
+    if (corrected > 0) {
+        LOG_DBG("Repaired %d bytes", corrected);
+        STATS_ADD(instance_data, fec_corrected, corrected);
+    }
+    return len;
+}
+
+/**
+ * @brief Decodes and validates a COBS frame and adds its fragment to the reassembly buffer of the addressed
+ * endpoint. Frames for unbound addresses are dropped.
+ *
+ * @param instance Receiving instance
+ * @param encoded Encoded frame without delimiter. Decoded in place.
+ * @param len Length of the encoded frame
+ * @param rx_timeout Maximum time to wait for the next frame of the transfer
+ * @return 0 on success, negative errno on failure: -EINVAL for malformed or corrupted frames, -EMSGSIZE if
+ * the message is larger than a reassembly buffer, -ENOMEM if the fragment does not fit in the transfer or the
+ * reassembly buffer could not be allocated.
+ */
+static int receive_cobs_frame(const struct device *instance, uint8_t *encoded, size_t len, k_timeout_t rx_timeout) {
+    const struct backend_config *config = instance->config;
+    struct backend_data *instance_data = instance->data;
+
+    int frame_len = cobs_decode(encoded, encoded, len);
+    if (config->fec && frame_len >= 0) {
+        frame_len = fec_correct(instance, encoded, frame_len);
+    }
+    if (frame_len < (int)sizeof(struct uart_ipc_cobs_header)) {
+        LOG_ERR("Malformed frame");
+        rate_rx_error(instance);
+        frag_rx_count(instance, true, 0);
+        return -EINVAL;
+    }
+
+    struct uart_ipc_cobs_header *header = (struct uart_ipc_cobs_header *)encoded;
+    size_t header_len = sizeof(*header) + ((header->flags & COBS_FLAG_ARQ) ? sizeof(struct uart_ipc_arq_header) : 0) +
+                        ((header->flags & COBS_FLAG_CREDIT) ? sizeof(struct uart_ipc_credit_header) : 0);
+    if (frame_len < (int)(header_len + COBS_CRC_SIZE(header->flags)) ||
+        frame_len - header_len - COBS_CRC_SIZE(header->flags) > FRAME_FRAG_SIZE) {
+        LOG_ERR("Malformed frame");
+        rate_rx_error(instance);
+        frag_rx_count(instance, true, 0);
+        return -EINVAL;
+    }
+
+    size_t crc_offset = frame_len - COBS_CRC_SIZE(header->flags);
+    bool crc_ok = (header->flags & COBS_FLAG_CRC16) ? uart_ipc_crc16(encoded, crc_offset) == sys_get_le16(encoded + crc_offset)
+                                                    : uart_ipc_crc32(encoded, crc_offset) == sys_get_le32(encoded + crc_offset);
+    if (!crc_ok) {
+        LOG_ERR("CRC mismatch. Fragment is likely corrupted");
+        STATS_INC(instance_data, crc_errors);
+        rate_rx_error(instance);
+        frag_rx_count(instance, true, 0);
+        return -EINVAL;
+    }
+    STATS_INC(instance_data, rx_frames);
+    frag_rx_count(instance, false, header->addr != UART_IPC_ADDR_LINK ? crc_offset - header_len : 0);  // Link messages are not split
+
+    struct frame_info info = {
+        .flags = header->flags,
+        .addr = header->addr,
+        .total_data_length = sys_le16_to_cpu(header->total_data_length),
+        .frag_start = sys_le16_to_cpu(header->frag_start),
+        .frag = encoded + header_len,
+        .frag_len = crc_offset - header_len,
+    };
+
+    if (info.addr == UART_IPC_ADDR_LINK) {
+        receive_link(instance, info.frag, info.frag_len);
+        return 0;
+    }
+    if (header->flags & COBS_FLAG_CREDIT) {
+        memcpy(&info.credit, encoded + header_len - sizeof(info.credit), sizeof(info.credit));
+    }
+
+    int err = 0;
+    if (header->flags & COBS_FLAG_ARQ) {
+        if (config->arq == NULL) {
+            LOG_ERR("Received a reliable mode frame, but reliable mode is disabled");
+            return -EINVAL;
+        }
+        memcpy(&info.arq, encoded + sizeof(*header), sizeof(info.arq));
+        arq_receive_ack(instance, info.arq.ack, sys_le32_to_cpu(info.arq.sack));
+        if (!(header->flags & COBS_FLAG_NO_DATA)) {
+            err = arq_receive_frame(instance, &info, rx_timeout);
+        }
+    } else if (!(header->flags & COBS_FLAG_NO_DATA)) {
+        err = receive_fragment(instance, &info, rx_timeout);
+    }
+
+    if (config->flow_control && (header->flags & COBS_FLAG_CREDIT)) {
+        credit_receive(instance, &info);
+    }
+    return err;
+}
+
+/* Offset of the next position in buf that could start a fixed frame, at least 1 */
+static size_t next_frame_candidate(const uint8_t *buf, size_t len) {
+    const size_t header_len = offsetof(struct uart_ipc_frame, frag);
+
+    for (size_t offset = 1; offset < len; ++offset) {
+        if (len - offset < header_len) {
+            return offset;  // Too little left to rule it out
+        }
+        if (frame_header_plausible(sys_get_le16(buf + offset), sys_get_le16(buf + offset + 2), buf[offset + 4])) {
+            return offset;
+        }
+    }
+    return len;
+}
+
+/**
+ * @brief Reassembles fixed size frames from received bytes. Frames may span several calls. When a frame fails
+ * validation the stream is assumed to be misaligned, and the search for a valid frame restarts at the next
+ * plausible frame header.
+ */
+static void receive_fixed_bytes(const struct device *instance, const uint8_t *bytes, size_t len) {
+    const struct backend_config *config = instance->config;
+    struct backend_data *data = instance->data;
+    uint8_t *frame_buf = (uint8_t *)&data->fixed_rx;
+    const size_t frame_len = sizeof(struct uart_ipc_frame) + (config->fec ? UART_IPC_FEC_PARITY_LEN : 0);
+
+    while (len > 0) {
+        size_t copy_len = MIN(len, frame_len - data->fixed_rx_len);
+        memcpy(frame_buf + data->fixed_rx_len, bytes, copy_len);
+        data->fixed_rx_len += copy_len;
+        bytes += copy_len;
+        len -= copy_len;
+
+        if (data->fixed_rx_len < frame_len) {
+            return;
+        }
+
+        int err = -EBADMSG;
+        if (!config->fec || fec_correct(instance, frame_buf, frame_len) >= 0) {
+            err = receive_frame(instance, &data->fixed_rx.frame, data->rx_timeout);
+        }
+        if (err == -EBADMSG) {
+            rate_rx_error(instance);  // Also while resynchronizing, which does not end at a wrong baud rate
+            if (!data->rx_resyncing) {
+                data->rx_resyncing = true;
+                STATS_INC(data, resyncs);
+                LOG_ERR("Lost frame alignment, resynchronizing");
+                report_error(instance, "Received data is not a valid frame, resynchronizing");
+            }
+            size_t skip = next_frame_candidate(frame_buf, data->fixed_rx_len);
+            memmove(frame_buf, frame_buf + skip, data->fixed_rx_len - skip);
+            data->fixed_rx_len -= skip;
+            continue;
+        }
+
+        if (data->rx_resyncing) {
+            data->rx_resyncing = false;
+            LOG_INF("Frame alignment recovered");
+        }
+        if (err) {
+            report_error(instance, "Failed to receive frame");
+        }
+        data->fixed_rx_len = 0;
+    }
+}
+
+/* Splits received bytes into COBS frames. Frames may span several calls */
+static void receive_cobs_bytes(const struct device *instance, const uint8_t *bytes, size_t len) {
+    struct backend_data *data = instance->data;
+
+    while (len > 0) {
+        const uint8_t *delimiter = memchr(bytes, COBS_DELIMITER, len);
+        size_t chunk_len = delimiter != NULL ? (size_t)(delimiter - bytes) : len;
+
+        if (data->cobs_rx_len + chunk_len > sizeof(data->cobs_rx_buf)) {
+            data->cobs_rx_overflow = true;
+        } else if (!data->cobs_rx_overflow) {
+            memcpy(data->cobs_rx_buf + data->cobs_rx_len, bytes, chunk_len);
+            data->cobs_rx_len += chunk_len;
+        }
+
+        if (delimiter == NULL) {
+            return;
+        }
+
+        if (data->cobs_rx_overflow) {
+            LOG_ERR("Received frame is too long");
+            STATS_INC(data, resyncs);
+            rate_rx_error(instance);
+            frag_rx_count(instance, true, 0);
+            report_error(instance, "Received frame is too long");
+        } else if (data->cobs_rx_len > 0) {
+            int err = receive_cobs_frame(instance, data->cobs_rx_buf, data->cobs_rx_len, data->rx_timeout);
+            if (err) {
+                report_error(instance, "Failed to receive frame");
+            }
+        }
+
+        data->cobs_rx_len = 0;
+        data->cobs_rx_overflow = false;
+        bytes += chunk_len + 1;
+        len -= chunk_len + 1;
+    }
+}
+
+/**
+ * @brief Parses a chunk of received bytes with the framing of the instance.
+ */
+static void receive_bytes(const struct device *instance, const uint8_t *bytes, size_t len) {
+    const struct backend_config *config = instance->config;
+
+    STATS_ADD((struct backend_data *)instance->data, rx_bytes, len);
+    if (config->framing == UART_IPC_FRAMING_COBS) {
+        receive_cobs_bytes(instance, bytes, len);
+    } else {
+        receive_fixed_bytes(instance, bytes, len);
+    }
+}
+
+#ifdef CONFIG_IPC_BACKEND_UART_RX_THREAD
+/**
+ * @brief Hands a chunk to the RX thread. Only called from the UART callback.
+ *
+ * @param reserved Number of ring slots that must stay free after the push.
+ *
+ * @return true on success, false if the ring is full.
+ */
+static bool rx_ring_push(struct backend_data *data, const struct rx_chunk *chunk, size_t reserved) {
+    atomic_val_t head = atomic_get(&data->rx_ring_head);
+    atomic_val_t tail = atomic_get(&data->rx_ring_tail);
+
+    if (CONFIG_IPC_BACKEND_UART_RX_RING_SIZE - (size_t)(head - tail) <= reserved) {
+        return false;
+    }
+    data->rx_ring[head & (CONFIG_IPC_BACKEND_UART_RX_RING_SIZE - 1)] = *chunk;
+    atomic_set(&data->rx_ring_head, head + 1);  // Publishes the chunk
+    k_sem_give(&data->rx_sem);
+    return true;
+}
+
+/**
+ * @brief Queues received bytes for the RX thread. A slot is kept free for every RX buffer, so that
+ * released buffers can always be handed back through the ring after the data they hold.
+ */
+static void rx_ring_push_data(const struct device *instance, uint8_t *buf, size_t offset, size_t len) {
+    struct backend_data *data = instance->data;
+    const struct rx_chunk chunk = {.buf = buf, .offset = offset, .len = len};
+
+    if (!rx_ring_push(data, &chunk, data->rx_slab->num_blocks)) {
+        LOG_ERR("RX ring full, dropping %d bytes", len);
+        STATS_INC(data, rx_dropped);
+        report_error(instance, "RX thread is not keeping up, received data was dropped");
+    }
+}
+
+/**
+ * @brief Frees an RX buffer once the RX thread has processed all chunks queued before it.
+ */
+static void rx_ring_push_release(struct backend_data *data, uint8_t *buf) {
+    const struct rx_chunk chunk = {.buf = buf, .len = 0};
+
+    if (!rx_ring_push(data, &chunk, 0)) {
+        LOG_ERR("No room to hand back RX buffer <%p>, freeing it directly", buf);  // Data slots are bounded, should not happen
+        k_mem_slab_free(data->rx_slab, (void **)&buf);
+    }
+}
+
+/**
+ * @brief Processes all chunks in the RX ring and drops timed out transfers. Only called from the RX thread.
+ */
+static void rx_ring_process(const struct device *instance) {
+    const struct backend_config *config = instance->config;
+    struct backend_data *data = instance->data;
+
+    for (size_t i = 0; i < config->endpoint_count; ++i) {
+        struct backend_endpoint *endpoint = &config->endpoints[i];
+        if (atomic_cas(&endpoint->rx_timed_out, 1, 0) && endpoint_rx_drop(endpoint)) {
+            endpoint_rx_timed_out(endpoint);
+        }
+    }
+    if (atomic_cas(&data->control.rx_timed_out, 1, 0) && endpoint_rx_drop(&data->control)) {
+        endpoint_rx_timed_out(&data->control);
+    }
+    for (size_t prio = 0; prio < CONFIG_IPC_BACKEND_UART_TX_PRIO_COUNT; ++prio) {
+        struct backend_endpoint *batch = &data->batches[prio];
+        if (atomic_cas(&batch->rx_timed_out, 1, 0) && endpoint_rx_drop(batch)) {
+            endpoint_rx_timed_out(batch);
+        }
+    }
+
+    atomic_val_t tail = atomic_get(&data->rx_ring_tail);
+    while (tail != atomic_get(&data->rx_ring_head)) {
+        struct rx_chunk *chunk = &data->rx_ring[tail & (CONFIG_IPC_BACKEND_UART_RX_RING_SIZE - 1)];
+        if (chunk->len == 0) {
+            k_mem_slab_free(data->rx_slab, (void **)&chunk->buf);
+        } else {
+            receive_bytes(instance, chunk->buf + chunk->offset, chunk->len);
+        }
+        tail++;
+        atomic_set(&data->rx_ring_tail, tail);  // Frees the slot for the UART callback
+    }
+}
+
+static void rx_thread_entry(void *p1, void *p2, void *p3) {
+    ARG_UNUSED(p2);
+    ARG_UNUSED(p3);
+    const struct device *instance = p1;
+    struct backend_data *data = instance->data;
+
+    while (true) {
+        k_sem_take(&data->rx_sem, K_FOREVER);
+        rx_ring_process(instance);
+    }
+}
+#endif  // CONFIG_IPC_BACKEND_UART_RX_THREAD
+
 static void uart_callback(const struct device *uart_dev, struct uart_event *evt, void *user_data) {
     struct device *instance = (struct device *)user_data;
+    const struct backend_config *config = instance->config;
     struct backend_data *data = instance->data;
-    struct backend_endpoint *endpoint = &data->endpoint;
 
     switch (evt->type) {
         case UART_TX_DONE: {
             LOG_DBG("UART_TX_DONE");
-            k_work_submit(&data->free_tx_work);
+            tx_done(instance, false);
             break;
         }
         case UART_TX_ABORTED: {
-            if (endpoint->cfg.cb.error != NULL) {
-                endpoint->cfg.cb.error("Sending data was aborted", endpoint->cfg.priv);
-            }
-            k_work_submit(&data->free_tx_work);
+            tx_done(instance, true);
             LOG_DBG("UART_TX_ABORTED");
             break;
         }
         case UART_RX_RDY: {
             LOG_DBG("UART_RX_RDY");
-            if (evt->data.rx.len != sizeof(struct uart_ipc_frame)) {
-                LOG_ERR("Received data is not a valid frame");
-                if (endpoint->cfg.cb.error != NULL) {
-                    endpoint->cfg.cb.error("Received data is not a valid frame. IPC instance is in an invalid state", endpoint->cfg.priv);
-                }
-                break;
-            }
-            struct uart_ipc_frame *frame = (struct uart_ipc_frame *)evt->data.rx.buf;
-            int err = receive_frame(endpoint, frame, data->rx_timeout);
-            if (err && endpoint->cfg.cb.error != NULL) {
-                endpoint->cfg.cb.error("Failed to receive frame", endpoint->cfg.priv);
-            }
+#ifdef CONFIG_IPC_BACKEND_UART_RX_THREAD
+            rx_ring_push_data(instance, evt->data.rx.buf, evt->data.rx.offset, evt->data.rx.len);
+#else
+            receive_bytes(instance, evt->data.rx.buf + evt->data.rx.offset, evt->data.rx.len);
+#endif
             break;
         }
         case UART_RX_BUF_REQUEST: {
             LOG_DBG("UART_RX_BUF_REQUEST");
             uint8_t *new_buf = NULL;
-            int err = k_mem_slab_alloc(&data->rx_slab, (void **)&new_buf, K_NO_WAIT);
+            int err = k_mem_slab_alloc(data->rx_slab, (void **)&new_buf, K_NO_WAIT);
             if (err || new_buf == NULL) {
                 LOG_ERR("Failed to allocate new buffer from rx slab: %d", err);
-                if (endpoint->cfg.cb.error != NULL) {
-                    endpoint->cfg.cb.error("Failed to allocate new buffer from rx slab. Receiving will be interrupted.", endpoint->cfg.priv);
-                }
+                STATS_INC(data, rx_slab_failures);
+                report_error(instance, "Failed to allocate new buffer from rx slab. Receiving will be interrupted.");
                 break;
             }
-            LOG_DBG("Provisioning buffer of size %d bytes at <%p>", data->rx_slab.block_size, new_buf);
-            err = uart_rx_buf_rsp(uart_dev, new_buf, data->rx_slab.block_size);
+            LOG_DBG("Provisioning buffer of size %d bytes at <%p>", data->rx_slab->block_size, new_buf);
+            err = uart_rx_buf_rsp(uart_dev, new_buf, data->rx_slab->block_size);
             if (err) {
                 LOG_ERR("Failed to respond to rx buffer request: %d", err);
-                if (endpoint->cfg.cb.error != NULL) {
-                    endpoint->cfg.cb.error("Failed to respond to rx buffer request. Receiving will be interrupted.", endpoint->cfg.priv);
-                }
+                report_error(instance, "Failed to respond to rx buffer request. Receiving will be interrupted.");
             }
             break;
         }
         case UART_RX_BUF_RELEASED: {
             LOG_DBG("UART_RX_BUF_RELEASED");
-            k_mem_slab_free(&data->rx_slab, (void **)&evt->data.rx_buf.buf);
+#ifdef CONFIG_IPC_BACKEND_UART_RX_THREAD
+            rx_ring_push_release(data, evt->data.rx_buf.buf);
+#else
+            k_mem_slab_free(data->rx_slab, (void **)&evt->data.rx_buf.buf);
+#endif
             LOG_DBG("Released buffer <%p>", evt->data.rx_buf.buf);
             break;
         }
         case UART_RX_DISABLED: {
             LOG_DBG("UART_RX_DISABLED");
-            if (endpoint->cfg.cb.error != NULL) {
-                endpoint->cfg.cb.error("Receiving was disabled, attempting to restart.", endpoint->cfg.priv);
-            }
+            report_error(instance, "Receiving was disabled, attempting to restart.");
             uint8_t *rx_buf;
-            int err = k_mem_slab_alloc(&data->rx_slab, (void **)&rx_buf, K_NO_WAIT);
+            int err = k_mem_slab_alloc(data->rx_slab, (void **)&rx_buf, K_NO_WAIT);
             if (err) {
                 LOG_ERR("Failed to allocate new buffer from rx slab: %d", err);
-                if (endpoint->cfg.cb.error != NULL) {
-                    endpoint->cfg.cb.error("Failed to allocate new buffer from rx slab. Receiving could not be resumed", endpoint->cfg.priv);
-                }
+                STATS_INC(data, rx_slab_failures);
+                report_error(instance, "Failed to allocate new buffer from rx slab. Receiving could not be resumed");
                 break;
             }
-            err = uart_rx_enable(uart_dev, rx_buf, data->rx_slab.block_size, 100);
+            err = uart_rx_enable(uart_dev, rx_buf, data->rx_slab->block_size, config->rx_inactivity_timeout_usec);
             if (err) {
                 LOG_ERR("Failed to enable receiving: %d", err);
-                if (endpoint->cfg.cb.error != NULL) {
-                    endpoint->cfg.cb.error("Failed to enable receiving. Receiving could not be resumed", endpoint->cfg.priv);
-                }
+                report_error(instance, "Failed to enable receiving. Receiving could not be resumed");
+                k_mem_slab_free(data->rx_slab, (void **)&rx_buf);
+            }
             break;
         }
         case UART_RX_STOPPED: {
-            if (endpoint->cfg.cb.error != NULL) {
-                endpoint->cfg.cb.error("Receiving was stopped", endpoint->cfg.priv);
-            }
+            rate_rx_error(instance);  // Framing and parity errors, as when the peer sends at another rate
+            report_error(instance, "Receiving was stopped");
             LOG_DBG("UART_RX_STOPPED");
             break;
         }
         default:
             break;
-        }
     }
 }
 
+/* Message buffers of the heap-free mode, counted by the footprint estimate in CMakeLists.txt */
+#define BACKEND_MSG_POOLS_DEFINE(inst)                             \
+    BUILD_ASSERT(DT_INST_PROP(inst, max_message_size) >= 1 &&      \
+                 DT_INST_PROP(inst, max_message_size) <= UINT16_MAX,\
+                 "max_message_size must be between 1 and 65535");  \
+    BUILD_ASSERT(DT_INST_PROP(inst, rx_message_buffers) >= 1,      \
+                 "At least one reassembly buffer is needed");      \
+    K_MEM_SLAB_DEFINE_STATIC(backend_rx_msg_slab_##inst,           \
+        ROUND_UP(DT_INST_PROP(inst, max_message_size), 4),         \
+        DT_INST_PROP(inst, rx_message_buffers), 4);
+
 #define DEFINE_BACKEND_DEVICE(inst)                                \
+    K_MEM_SLAB_DEFINE_STATIC(backend_tx_slab_##inst,               \
+                             sizeof(struct uart_ipc_tx_buf),       \
+                             CONFIG_IPC_BACKEND_UART_TX_BUF_COUNT, \
+                             4);                                   \
+    K_MEM_SLAB_DEFINE_STATIC(backend_rx_slab_##inst,               \
+                             DT_INST_PROP(inst, rx_buffer_size),   \
+                             DT_INST_PROP(inst, rx_buffer_count),  \
+                             4);                                   \
+    IF_ENABLED(CONFIG_IPC_BACKEND_UART_STATIC_ALLOC,               \
+               (BACKEND_MSG_POOLS_DEFINE(inst)))                   \
+    BUILD_ASSERT(DT_INST_PROP(inst, rx_buffer_count) >= 2,         \
+                 "At least two RX buffers are needed");            \
+    IF_ENABLED(CONFIG_IPC_BACKEND_UART_RX_THREAD,                  \
+               (BUILD_ASSERT(DT_INST_PROP(inst, rx_buffer_count) < \
+                    CONFIG_IPC_BACKEND_UART_RX_RING_SIZE,          \
+                    "The RX ring must be larger than the number "  \
+                    "of RX buffers");))                            \
+    static char __aligned(4) backend_tx_queue_buf_##inst[          \
+        CONFIG_IPC_BACKEND_UART_TX_PRIO_COUNT *                    \
+        CONFIG_IPC_BACKEND_UART_TX_QUEUE_SIZE *                    \
+        sizeof(struct tx_request)];                                \
+    BUILD_ASSERT(DT_INST_PROP(inst, max_endpoint_count) <=         \
+                 UART_IPC_ADDR_BATCH,                              \
+                 "Too many endpoints");                            \
+    BUILD_ASSERT(sizeof(struct uart_ipc_control_header) +          \
+                 DT_INST_PROP(inst, max_endpoint_name_length) <=   \
+                 FRAME_FRAG_SIZE,                                  \
+                 "Endpoint names must fit in a single frame");     \
+    static struct backend_endpoint backend_endpoints_##inst[       \
+        DT_INST_PROP(inst, max_endpoint_count)];                   \
+    static char backend_endpoint_names_##inst[                     \
+        DT_INST_PROP(inst, max_endpoint_count) *                   \
+        (DT_INST_PROP(inst, max_endpoint_name_length) + 1)];       \
+    BUILD_ASSERT(!DT_INST_PROP(inst, reliable) ||                  \
+                 DT_INST_ENUM_IDX(inst, framing) ==                \
+                 UART_IPC_FRAMING_COBS,                            \
+                 "Reliable mode requires COBS framing");           \
+    BUILD_ASSERT(!DT_INST_PROP(inst, compression) ||               \
+                 DT_INST_ENUM_IDX(inst, framing) ==                \
+                 UART_IPC_FRAMING_COBS,                            \
+                 "Compression requires COBS framing");             \
+    BUILD_ASSERT(DT_INST_PROP(inst, coalesce_threshold) <=         \
+                 sizeof(((struct uart_ipc_tx_buf *)0)->data),      \
+                 "Batches must fit in a TX buffer");               \
+    BUILD_ASSERT(DT_INST_PROP(inst, rx_credits) >= 1 &&            \
+                 DT_INST_PROP(inst, rx_credits) <= 127,            \
+                 "rx_credits must be between 1 and 127");          \
+    BUILD_ASSERT(DT_INST_PROP(inst, fragment_size) >= 1 &&         \
+                 DT_INST_PROP(inst, fragment_size) <=              \
+                 FRAME_FRAG_SIZE,                                  \
+                 "fragment_size must be between 1 and 64");        \
+    BUILD_ASSERT(!DT_INST_PROP(inst, adaptive_fragment_size) ||    \
+                 DT_INST_ENUM_IDX(inst, framing) ==                \
+                 UART_IPC_FRAMING_COBS,                            \
+                 "adaptive_fragment_size requires COBS framing");  \
+    BUILD_ASSERT(!DT_INST_NODE_HAS_PROP(inst, baud_rates) ||       \
+                 IS_ENABLED(CONFIG_UART_USE_RUNTIME_CONFIGURE),    \
+                 "baud_rates requires "                            \
+                 "CONFIG_UART_USE_RUNTIME_CONFIGURE");             \
+    IF_ENABLED(DT_INST_NODE_HAS_PROP(inst, baud_rates),            \
+               (static const uint32_t backend_baud_rates_##inst[] =\
+                    DT_INST_PROP(inst, baud_rates);))              \
+    COND_CODE_1(DT_INST_PROP(inst, reliable),                      \
+                (static struct arq_state backend_arq_##inst;), ()) \
+    IF_ENABLED(CONFIG_IPC_BACKEND_UART_RX_THREAD,                  \
+               (K_KERNEL_STACK_DEFINE(backend_rx_stack_##inst,     \
+                   CONFIG_IPC_BACKEND_UART_RX_THREAD_STACK_SIZE);))\
     static struct backend_config backend_config_##inst = {         \
         .uart_dev = DEVICE_DT_GET(DT_INST_BUS(inst)),              \
         .rx_timeout_usec = DT_INST_PROP(inst, rx_timeout),         \
+        .rx_slab = &backend_rx_slab_##inst,                        \
+        .rx_inactivity_timeout_usec =                              \
+            DT_INST_PROP(inst, rx_inactivity_timeout),             \
+        .endpoints = backend_endpoints_##inst,                     \
+        .endpoint_count = DT_INST_PROP(inst, max_endpoint_count),  \
+        .endpoint_names = backend_endpoint_names_##inst,           \
+        .endpoint_name_len =                                       \
+            DT_INST_PROP(inst, max_endpoint_name_length),          \
+        .tx_slab = &backend_tx_slab_##inst,                        \
+        .tx_queue_buf = backend_tx_queue_buf_##inst,               \
+        .framing = DT_INST_ENUM_IDX(inst, framing),                \
+        .arq = COND_CODE_1(DT_INST_PROP(inst, reliable),           \
+                           (&backend_arq_##inst), (NULL)),         \
+        .flow_control = DT_INST_PROP(inst, flow_control),          \
+        .rx_credits = DT_INST_PROP(inst, rx_credits),              \
+        .hw_flow_control =                                         \
+            DT_PROP(DT_INST_BUS(inst), hw_flow_control),           \
+        .coalesce_window_usec =                                    \
+            DT_INST_PROP(inst, coalesce_window),                   \
+        .coalesce_threshold =                                      \
+            DT_INST_PROP(inst, coalesce_threshold),                \
+        .compression = DT_INST_PROP(inst, compression),            \
+        .baud_rates = COND_CODE_1(                                 \
+            DT_INST_NODE_HAS_PROP(inst, baud_rates),               \
+            (backend_baud_rates_##inst), (NULL)),                  \
+        .baud_rate_count = DT_INST_PROP_LEN_OR(inst, baud_rates, 0),\
+        .frag_size = DT_INST_PROP(inst, fragment_size),            \
+        .adaptive_frag = DT_INST_PROP(inst, adaptive_fragment_size),\
+        .fec = DT_INST_PROP(inst, fec),                            \
+        IF_ENABLED(CONFIG_IPC_BACKEND_UART_STATIC_ALLOC,           \
+                   (.rx_msg_pool = &backend_rx_msg_slab_##inst, )) \
+        IF_ENABLED(CONFIG_IPC_BACKEND_UART_RX_THREAD,              \
+                   (.rx_stack = backend_rx_stack_##inst, ))        \
     };                                                             \
     static struct backend_data backend_data_##inst = {0};          \
     DEVICE_DT_INST_DEFINE(inst,                                    \
@@ -0,0 +1,281 @@
+#include "benchmark.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <zephyr/ipc/ipc_service.h>
+#include <zephyr/kernel.h>
+#include <zephyr/random/rand32.h>
+#include <zephyr/sys/printk.h>
+
+#ifdef CONFIG_IPC_BACKEND_UART_STATS
+#include "uart_ipc_stats.h"
+#endif
+
+#include <zephyr/logging/log.h>
+LOG_MODULE_DECLARE(APPLICATION, CONFIG_APPLICATION_LOG_LEVEL);
+
+#define BENCHMARK_MAX_PAYLOAD (sizeof(((struct ping_event_fields *)0)->message) - 1)
+
+/* The 8 bit counter of a ping holds its slot in the low bits and the generation of its payload size in the high
+ * bits, so that late pongs of an earlier size are told apart */
+#define BENCHMARK_SLOT_BITS LOG2CEIL(CONFIG_BENCHMARK_OUTSTANDING)
+#define BENCHMARK_SLOT_MASK (BIT(BENCHMARK_SLOT_BITS) - 1)
+#define BENCHMARK_GENERATION_MASK (BIT(8 - BENCHMARK_SLOT_BITS) - 1)
+
+BUILD_ASSERT(BENCHMARK_SLOT_BITS <= 6, "Pings need two bits of their 8 bit counter for the generation");
+
+/* State of the payload size being run. The pong side only touches the pong callback fields */
+static struct {
+    benchmark_send_t send;
+    struct ping_event_fields ping;  // Ping sent for the current size, the counter is set per slot
+    atomic_t running;               // New pings are sent while set
+    atomic_t outstanding;           // Slots whose ping may still be answered
+    atomic_t send_failures;         // Pings that could not be sent, their slots are released
+    struct k_sem drained;
+    uint32_t sent_at[CONFIG_BENCHMARK_OUTSTANDING];  // Cycle count when the ping of each slot was sent
+    struct k_spinlock lock;                           // Protects the fields below against late pongs
+    bool sampling;                                    // Pongs are recorded while set
+    uint8_t generation;                               // Of the payload size being run, in the counter of its pings
+    uint32_t samples[CONFIG_BENCHMARK_MAX_SAMPLES];  // Round trip times in us
+    uint32_t completed;                               // Round trips so far
+    uint32_t corrupted;                               // Pongs whose message did not match the ping
+    uint32_t rtt_min;
+    uint32_t rtt_max;
+} bench;
+
+/* A slot will not see another pong. The last one signals that the run has drained */
+static void release_slot(void) {
+    if (atomic_dec(&bench.outstanding) == 1) {
+        k_sem_give(&bench.drained);
+    }
+}
+
+static void send_slot(uint8_t slot) {
+    struct ping_event_fields ping = bench.ping;
+
+    ping.counter = (bench.generation << BENCHMARK_SLOT_BITS) | slot;
+    bench.sent_at[slot] = k_cycle_get_32();
+    if (bench.send(&ping) < 0) {
+        atomic_inc(&bench.send_failures);
+        release_slot();
+    }
+}
+
+/* Keeps every round trip time with the same probability once the sample buffer is full */
+static void record_rtt(uint32_t rtt) {
+    bench.rtt_min = MIN(bench.rtt_min, rtt);
+    bench.rtt_max = MAX(bench.rtt_max, rtt);
+
+    if (bench.completed < CONFIG_BENCHMARK_MAX_SAMPLES) {
+        bench.samples[bench.completed] = rtt;
+    } else {
+        uint32_t index = sys_rand32_get() % (bench.completed + 1);
+        if (index < CONFIG_BENCHMARK_MAX_SAMPLES) {
+            bench.samples[index] = rtt;
+        }
+    }
+    bench.completed++;
+}
+
+void benchmark_pong_received(const struct pong_event_fields *pong) {
+    uint32_t now = k_cycle_get_32();
+
+    uint8_t slot = pong->counter & BENCHMARK_SLOT_MASK;
+
+    if (slot >= CONFIG_BENCHMARK_OUTSTANDING) {
+        LOG_WRN("Pong for unknown ping %d", pong->counter);
+        return;
+    }
+
+    k_spinlock_key_t key = k_spin_lock(&bench.lock);
+    if (!bench.sampling || (pong->counter >> BENCHMARK_SLOT_BITS) != bench.generation) {
+        k_spin_unlock(&bench.lock, key);
+        LOG_WRN("Pong for ping %d arrived after its size was evaluated", pong->counter);
+        return;
+    }
+    if (strcmp(pong->message, bench.ping.message) != 0) {
+        bench.corrupted++;
+    }
+    record_rtt(k_cyc_to_us_floor32(now - bench.sent_at[slot]));
+    k_spin_unlock(&bench.lock, key);
+
+    if (atomic_get(&bench.running)) {
+        send_slot(slot);
+    } else {
+        release_slot();
+    }
+}
+
+static int compare_u32(const void *a, const void *b) {
+    uint32_t x = *(const uint32_t *)a;
+    uint32_t y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+static uint32_t link_bytes(const struct device *instance) {
+#ifdef CONFIG_IPC_BACKEND_UART_STATS
+    struct uart_ipc_stats stats;
+    if (uart_ipc_stats_get(instance, &stats) == 0) {
+        return stats.tx_bytes + stats.rx_bytes;
+    }
+#endif
+    return 0;
+}
+
+static void run_payload(const struct device *instance, size_t payload_len) {
+    for (size_t i = 0; i < payload_len; ++i) {
+        bench.ping.message[i] = '!' + sys_rand32_get() % ('~' - '!' + 1);  // Random printable text, compresses poorly
+    }
+    bench.ping.message[payload_len] = '\0';
+    bench.ping.counter = 0;
+    bench.completed = 0;
+    bench.corrupted = 0;
+    bench.rtt_min = UINT32_MAX;
+    bench.rtt_max = 0;
+    k_spinlock_key_t key = k_spin_lock(&bench.lock);
+    bench.generation = (bench.generation + 1) & BENCHMARK_GENERATION_MASK;
+    bench.sampling = true;
+    k_spin_unlock(&bench.lock, key);
+    atomic_clear(&bench.send_failures);
+    k_sem_reset(&bench.drained);
+
+    uint32_t link_bytes_start = link_bytes(instance);
+    atomic_set(&bench.outstanding, CONFIG_BENCHMARK_OUTSTANDING);
+    atomic_set(&bench.running, 1);
+    int64_t start = k_uptime_get();
+    for (uint8_t slot = 0; slot < CONFIG_BENCHMARK_OUTSTANDING; ++slot) {
+        send_slot(slot);
+    }
+
+    k_sleep(K_MSEC(CONFIG_BENCHMARK_DURATION_MS));
+    atomic_clear(&bench.running);
+    uint32_t elapsed_ms = MAX(k_uptime_get() - start, 1);
+    key = k_spin_lock(&bench.lock);
+    uint32_t round_trips = bench.completed;
+    k_spin_unlock(&bench.lock, key);
+    uint32_t link_bytes_run = link_bytes(instance) - link_bytes_start;
+
+    /* Pings still in flight are only waited for, so that they do not leak into the next size */
+    uint32_t lost = 0;
+    if (k_sem_take(&bench.drained, K_SECONDS(1)) != 0) {
+        lost = atomic_get(&bench.outstanding);
+    }
+
+    /* Pongs arriving from now on would change the samples while they are sorted */
+    key = k_spin_lock(&bench.lock);
+    bench.sampling = false;
+    k_spin_unlock(&bench.lock, key);
+
+    size_t sample_count = MIN(bench.completed, CONFIG_BENCHMARK_MAX_SAMPLES);
+    qsort(bench.samples, sample_count, sizeof(bench.samples[0]), compare_u32);
+    const bool any = sample_count > 0;
+
+    /* Both events of a round trip carry the same fields */
+    size_t event_bytes = ping_event_fields_size(&bench.ping);
+    uint32_t events_per_sec = (uint64_t)round_trips * 2 * MSEC_PER_SEC / elapsed_ms;
+
+    printk("bench payload=%u outstanding=%u duration_ms=%u round_trips=%u lost=%u send_failures=%u corrupted=%u "
+           "rtt_us_min=%u rtt_us_median=%u rtt_us_p99=%u rtt_us_max=%u "
+           "events_per_s=%u event_bytes=%u payload_bytes_per_s=%u link_bytes_per_s=%u\n",
+           (unsigned int)payload_len, CONFIG_BENCHMARK_OUTSTANDING, elapsed_ms, round_trips, lost,
+           (uint32_t)atomic_get(&bench.send_failures), bench.corrupted,
+           any ? bench.rtt_min : 0, any ? bench.samples[sample_count / 2] : 0, any ? bench.samples[sample_count * 99 / 100] : 0,
+           bench.rtt_max, events_per_sec, (unsigned int)event_bytes, (uint32_t)(events_per_sec * event_bytes),
+           (uint32_t)((uint64_t)link_bytes_run * MSEC_PER_SEC / elapsed_ms));
+}
+
+void benchmark_run(const struct device *instance, benchmark_send_t send) {
+    const char *pos = CONFIG_BENCHMARK_PAYLOAD_SIZES;
+
+    bench.send = send;
+    k_sem_init(&bench.drained, 0, 1);
+
+    while (true) {
+        char *end;
+        unsigned long payload_len = strtoul(pos, &end, 10);
+        if (end == pos) {
+            break;
+        }
+        pos = end;
+
+        if (payload_len == 0 || payload_len > BENCHMARK_MAX_PAYLOAD) {
+            LOG_WRN("Skipping payload size %lu, must be between 1 and %zu", payload_len, BENCHMARK_MAX_PAYLOAD);
+            continue;
+        }
+        run_payload(instance, payload_len);
+    }
+    printk("bench done\n");
+}
+
+#ifdef CONFIG_BENCHMARK_LOOPBACK
+static struct ipc_ept ping_ept;  // On uart_ipc_backend, receives pongs
+static struct ipc_ept pong_ept;  // On uart_ipc_backend_peer, echoes pings
+static K_SEM_DEFINE(loopback_bound, 0, 2);
+
+static void loopback_bound_cb(void *priv) {
+    k_sem_give(&loopback_bound);
+}
+
+static void loopback_pong_received(const void *data, size_t len, void *priv) {
+    struct pong_event_fields pong;
+    if (pong_event_fields_decode(&pong, data, len)) {
+        LOG_ERR("Malformed pong");
+        return;
+    }
+    benchmark_pong_received(&pong);
+}
+
+static void loopback_ping_received(const void *data, size_t len, void *priv) {
+    struct ping_event_fields ping;
+    if (ping_event_fields_decode(&ping, data, len)) {
+        LOG_ERR("Malformed ping");
+        return;
+    }
+
+    struct pong_event_fields pong = {.counter = ping.counter};
+    strcpy(pong.message, ping.message);
+    uint8_t buf[sizeof(pong) + 8];  // Never more than the struct plus the varint prefixes
+    int err = ipc_service_send(&pong_ept, buf, pong_event_fields_encode(&pong, buf, sizeof(buf)));
+    if (err < 0) {
+        LOG_ERR("Failed to send pong %d", err);
+    }
+}
+
+static int loopback_send_ping(const struct ping_event_fields *ping) {
+    uint8_t buf[sizeof(*ping) + 8];
+    int err = ipc_service_send(&ping_ept, buf, ping_event_fields_encode(ping, buf, sizeof(buf)));
+    if (err < 0) {
+        LOG_ERR("Failed to send ping %d", err);
+        return err;
+    }
+    return 0;
+}
+
+void benchmark_loopback_run(void) {
+    const struct device *ping_instance = DEVICE_DT_GET(DT_NODELABEL(uart_ipc_backend));
+    const struct device *pong_instance = DEVICE_DT_GET(DT_NODELABEL(uart_ipc_backend_peer));
+    static const struct ipc_ept_cfg ping_cfg = {
+        .name = "benchmark",
+        .cb = {.bound = loopback_bound_cb, .received = loopback_pong_received},
+    };
+    static const struct ipc_ept_cfg pong_cfg = {
+        .name = "benchmark",
+        .cb = {.bound = loopback_bound_cb, .received = loopback_ping_received},
+    };
+
+    int err = ipc_service_open_instance(ping_instance);
+    err = err ? err : ipc_service_open_instance(pong_instance);
+    err = err ? err : ipc_service_register_endpoint(ping_instance, &ping_ept, &ping_cfg);
+    err = err ? err : ipc_service_register_endpoint(pong_instance, &pong_ept, &pong_cfg);
+    if (err) {
+        LOG_ERR("Failed to set up loopback endpoints %d", err);
+        return;
+    }
+
+    if (k_sem_take(&loopback_bound, K_SECONDS(1)) || k_sem_take(&loopback_bound, K_SECONDS(1))) {
+        LOG_ERR("Loopback endpoints did not bind");
+        return;
+    }
+    benchmark_run(ping_instance, loopback_send_ping);
+}
+#endif /* CONFIG_BENCHMARK_LOOPBACK */
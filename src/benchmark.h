@@ -0,0 +1,39 @@
+#ifndef BENCHMARK_H_
+#define BENCHMARK_H_
+
+#include <zephyr/device.h>
+
+#include "ping_event.h"
+#include "pong_event.h"
+
+/**
+ * @brief Sends a ping to the pong side, which echoes it back as a pong with the same message and counter.
+ *
+ * @return 0 on success, or a negative error code if the ping was not sent and no pong will follow.
+ */
+typedef int (*benchmark_send_t)(const struct ping_event_fields *ping);
+
+/**
+ * @brief Runs the benchmark for every size in CONFIG_BENCHMARK_PAYLOAD_SIZES and prints one result line per size.
+ * Blocks until all sizes have been run.
+ *
+ * @param instance Backend instance the pings are sent on, read for link level byte counts
+ * @param send Function sending a ping
+ */
+void benchmark_run(const struct device *instance, benchmark_send_t send);
+
+/**
+ * @brief Accounts for the pong of an earlier ping and sends the next ping in its place while the run lasts. Pongs
+ * arriving after a size has been evaluated are dropped. Must be called from one context at a time.
+ */
+void benchmark_pong_received(const struct pong_event_fields *pong);
+
+#ifdef CONFIG_BENCHMARK_LOOPBACK
+/**
+ * @brief Runs the benchmark between the uart_ipc_backend and uart_ipc_backend_peer instances of this image,
+ * sending the encoded events directly on IPC service endpoints.
+ */
+void benchmark_loopback_run(void);
+#endif
+
+#endif /* BENCHMARK_H_ */
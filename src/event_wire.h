@@ -0,0 +1,180 @@
+#ifndef EVENT_WIRE_H_
+#define EVENT_WIRE_H_
+
+#include <errno.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+/*
+ * Compact wire encoding of application event fields. Unsigned integers are LEB128 varints, signed integers are
+ * zigzag encoded varints and strings are a varint length followed by the characters, without terminator or
+ * padding. The encoding does not depend on the byte order of either side.
+ *
+ * The fields of an event are listed in an X-macro that applies FIELD(kind, name, arg) to every field:
+ *
+ *     #define PING_EVENT_FIELDS(FIELD)            \
+ *         FIELD(EVENT_WIRE_STRING, message, 128)  \
+ *         FIELD(EVENT_WIRE_UINT, counter, uint8_t)
+ *
+ * kind is EVENT_WIRE_UINT or EVENT_WIRE_INT with the C type as arg, or EVENT_WIRE_STRING with the size of the
+ * buffer, including the terminator, as arg. EVENT_WIRE_SCHEMA_DEFINE(ping_event, PING_EVENT_FIELDS) generates
+ * struct ping_event_fields with one member per field, and its encoder and decoder.
+ */
+
+static inline size_t event_wire_varint_size(uint64_t value) {
+    size_t size = 1;
+    for (; value >= 0x80; value >>= 7) {
+        size++;
+    }
+    return size;
+}
+
+static inline uint8_t *event_wire_put_varint(uint8_t *pos, uint64_t value) {
+    for (; value >= 0x80; value >>= 7) {
+        *pos++ = (uint8_t)value | 0x80;
+    }
+    *pos++ = (uint8_t)value;
+    return pos;
+}
+
+/* Returns the position after the varint, or NULL if it is truncated or longer than 64 bits */
+static inline const uint8_t *event_wire_get_varint(const uint8_t *pos, const uint8_t *end, uint64_t *value) {
+    *value = 0;
+    for (unsigned int shift = 0; pos < end && shift < 64; shift += 7) {
+        uint8_t byte = *pos++;
+        if (shift == 63 && byte > 1) {
+            return NULL;  // Only the top bit is left for the tenth byte
+        }
+        *value |= (uint64_t)(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            return pos;
+        }
+    }
+    return NULL;
+}
+
+static inline uint64_t event_wire_zigzag(int64_t value) {
+    return ((uint64_t)value << 1) ^ (uint64_t)(value >> 63);
+}
+
+static inline int64_t event_wire_unzigzag(uint64_t value) {
+    return (int64_t)(value >> 1) ^ -(int64_t)(value & 1);
+}
+
+/* Field kinds. Each provides a member declaration, its encoded size, an encoder and a decoder */
+#define EVENT_WIRE_UINT_MEMBER(name, type) type name;
+#define EVENT_WIRE_UINT_SIZE(name, type) event_wire_varint_size(fields->name)
+#define EVENT_WIRE_UINT_ENCODE(name, type) pos = event_wire_put_varint(pos, fields->name);
+#define EVENT_WIRE_UINT_DECODE(name, type)                                  \
+    {                                                                       \
+        uint64_t value;                                                     \
+        pos = event_wire_get_varint(pos, end, &value);                      \
+        if (pos == NULL || (uint64_t)(type)value != value) {                \
+            return -EINVAL;                                                 \
+        }                                                                   \
+        fields->name = (type)value;                                         \
+    }
+
+#define EVENT_WIRE_INT_MEMBER(name, type) type name;
+#define EVENT_WIRE_INT_SIZE(name, type) event_wire_varint_size(event_wire_zigzag(fields->name))
+#define EVENT_WIRE_INT_ENCODE(name, type) pos = event_wire_put_varint(pos, event_wire_zigzag(fields->name));
+#define EVENT_WIRE_INT_DECODE(name, type)                                   \
+    {                                                                       \
+        uint64_t value;                                                     \
+        pos = event_wire_get_varint(pos, end, &value);                      \
+        int64_t decoded = event_wire_unzigzag(value);                       \
+        if (pos == NULL || (int64_t)(type)decoded != decoded) {             \
+            return -EINVAL;                                                 \
+        }                                                                   \
+        fields->name = (type)decoded;                                       \
+    }
+
+#define EVENT_WIRE_STRING_MEMBER(name, size) char name[size];
+#define EVENT_WIRE_STRING_SIZE(name, size) \
+    (event_wire_varint_size(strnlen(fields->name, (size) - 1)) + strnlen(fields->name, (size) - 1))
+#define EVENT_WIRE_STRING_ENCODE(name, size)                                \
+    {                                                                       \
+        size_t str_len = strnlen(fields->name, (size) - 1);                 \
+        pos = event_wire_put_varint(pos, str_len);                          \
+        memcpy(pos, fields->name, str_len);                                 \
+        pos += str_len;                                                     \
+    }
+#define EVENT_WIRE_STRING_DECODE(name, size)                                \
+    {                                                                       \
+        uint64_t str_len;                                                   \
+        pos = event_wire_get_varint(pos, end, &str_len);                    \
+        if (pos == NULL || str_len >= (size) ||                             \
+            str_len > (uint64_t)(end - pos)) {                              \
+            return -EINVAL;                                                 \
+        }                                                                   \
+        memcpy(fields->name, pos, str_len);                                 \
+        fields->name[str_len] = '\0';                                       \
+        pos += str_len;                                                     \
+    }
+
+#define EVENT_WIRE_MEMBER(kind, name, arg) kind##_MEMBER(name, arg)
+#define EVENT_WIRE_SIZE(kind, name, arg) +kind##_SIZE(name, arg)
+#define EVENT_WIRE_ENCODE(kind, name, arg) kind##_ENCODE(name, arg)
+#define EVENT_WIRE_DECODE(kind, name, arg) kind##_DECODE(name, arg)
+
+/**
+ * @brief Defines struct ename##_fields holding the fields listed by FIELDS, and functions to encode and decode
+ * it in the compact wire encoding:
+ *
+ * size_t ename##_fields_size(fields) returns the length of the encoded fields.
+ *
+ * int ename##_fields_encode(fields, buf, size) returns the number of bytes written, or -ENOSPC if the encoded
+ * fields do not fit in size bytes.
+ *
+ * int ename##_fields_decode(fields, buf, len) returns 0 on success, or -EINVAL if buf does not hold exactly
+ * one valid encoding.
+ */
+#define EVENT_WIRE_SCHEMA_DEFINE(ename, FIELDS)                                                               \
+    struct ename##_fields {                                                                                   \
+        FIELDS(EVENT_WIRE_MEMBER)                                                                             \
+    };                                                                                                        \
+                                                                                                              \
+    static inline size_t ename##_fields_size(const struct ename##_fields *fields) {                          \
+        return 0 FIELDS(EVENT_WIRE_SIZE);                                                                     \
+    }                                                                                                         \
+                                                                                                              \
+    static inline int ename##_fields_encode(const struct ename##_fields *fields, uint8_t *buf, size_t size) { \
+        if (ename##_fields_size(fields) > size) {                                                             \
+            return -ENOSPC;                                                                                   \
+        }                                                                                                     \
+        uint8_t *pos = buf;                                                                                   \
+        FIELDS(EVENT_WIRE_ENCODE)                                                                             \
+        return pos - buf;                                                                                     \
+    }                                                                                                         \
+                                                                                                              \
+    static inline int ename##_fields_decode(struct ename##_fields *fields, const uint8_t *buf, size_t len) {  \
+        const uint8_t *pos = buf;                                                                             \
+        const uint8_t *end = buf + len;                                                                       \
+        FIELDS(EVENT_WIRE_DECODE)                                                                             \
+        return pos == end ? 0 : -EINVAL;                                                                      \
+    }
+
+/**
+ * @brief Defines helpers for an application event that carries its fields in the compact wire encoding as
+ * dynamic data. The event must be declared with APP_EVENT_TYPE_DYNDATA_DECLARE, end with a struct event_dyndata
+ * member named dyndata, and have its fields defined with EVENT_WIRE_SCHEMA_DEFINE.
+ *
+ * void submit_##ename(fields) creates an event holding the encoded fields and submits it.
+ *
+ * int ename##_get_fields(event, fields) decodes the fields of an event, returning 0 on success or -EINVAL if
+ * the event does not hold a valid encoding.
+ */
+#define EVENT_WIRE_EVENT_DEFINE(ename)                                                                        \
+    static inline void submit_##ename(const struct ename##_fields *fields) {                                 \
+        size_t size = ename##_fields_size(fields);                                                            \
+        struct ename *event = new_##ename(size);                                                              \
+        ename##_fields_encode(fields, event->dyndata.data, size);                                             \
+        APP_EVENT_SUBMIT(event);                                                                              \
+    }                                                                                                         \
+                                                                                                              \
+    static inline int ename##_get_fields(const struct ename *event, struct ename##_fields *fields) {          \
+        return ename##_fields_decode(fields, event->dyndata.data, event->dyndata.size);                       \
+    }
+
+#endif /* EVENT_WIRE_H_ */
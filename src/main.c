@@ -7,10 +7,15 @@
 #include <app_event_manager.h>
 #include <event_manager_proxy.h>
 #include <ipc/ipc_service.h>
+#include <string.h>
 
 #include "ping_event.h"
 #include "pong_event.h"
 
+#ifdef CONFIG_BENCHMARK
+#include "benchmark.h"
+#endif
+
 #define MODULE APPLICATION
 
 #ifdef CONFIG_PING
@@ -24,7 +29,20 @@
 #include <zephyr/logging/log.h>
 LOG_MODULE_REGISTER(MODULE, CONFIG_APPLICATION_LOG_LEVEL);
 
+#if defined(CONFIG_PING) && defined(CONFIG_BENCHMARK)
+/* Submitting an event does not fail, the event manager asserts when it runs out of memory */
+static int benchmark_send_ping(const struct ping_event_fields *ping) {
+    submit_ping_event(ping);
+    return 0;
+}
+#endif
+
 void main(void) {
+#ifdef CONFIG_BENCHMARK_LOOPBACK
+    benchmark_loopback_run();
+    return;
+#endif
+
     const struct device *instance = DEVICE_DT_GET(DT_NODELABEL(uart_ipc_backend));
     if (!device_is_ready(instance)) {
         LOG_ERR("IPC service backend is not ready");
@@ -36,12 +54,12 @@ void main(void) {
         return;
     }
 
+    /* Blocks until the other board has bound its endpoint, for up to CONFIG_EVENT_MANAGER_PROXY_BOND_TIMEOUT_MS */
     int err = event_manager_proxy_add_remote(instance);
     if (err) {
         LOG_ERR("IPC service register endpoint failed with error %d", err);
         return;
     }
-    k_sleep(K_MSEC(1000));
 
     err = EVENT_MANAGER_PROXY_SUBSCRIBE(instance, SUBSCRIBE_TO_EVENT);
 
@@ -56,38 +74,61 @@ void main(void) {
         return;
     }
     event_manager_proxy_wait_for_remotes(K_FOREVER);
-    k_sleep(K_MSEC(200));
 
-#ifdef CONFIG_PING
+#if defined(CONFIG_PING) && defined(CONFIG_BENCHMARK)
+    benchmark_run(instance, benchmark_send_ping);
+#elif defined(CONFIG_PING)
     LOG_DBG("Sending first ping event!");
-    struct ping_event *event = new_ping_event();
-    strncpy(&event->message[0], "This is the first PING event!", sizeof(event->message));
-    event->counter = 0;
-    APP_EVENT_SUBMIT(event);
+    struct ping_event_fields ping = {
+        .message = "This is the first PING event!",
+        .counter = 0,
+    };
+    submit_ping_event(&ping);
 #endif /* CONFIG_PING */
 }
 
 static bool app_event_handler(const struct app_event_header *aeh) {
     if (is_ping_event(aeh)) {
-        const struct ping_event *event = cast_ping_event(aeh);
-        LOG_INF("PING! (%d) : %s",event->counter, event->message);
+        struct ping_event_fields event;
+        if (ping_event_get_fields(cast_ping_event(aeh), &event)) {
+            LOG_ERR("Malformed ping event");
+            return false;
+        }
+#ifdef CONFIG_BENCHMARK
+        /* Echo the ping, so that the payload crosses the link both ways */
+        struct pong_event_fields echo = {.counter = event.counter};
+        strcpy(echo.message, event.message);
+        submit_pong_event(&echo);
+        return false;
+#endif
+        LOG_INF("PING! (%d) : %s",event.counter, event.message);
         // k_sleep(K_MSEC(500));
-        struct pong_event *pong = new_pong_event();
-        strncpy(&pong->message[0], "Hello from the PONG server!", sizeof(pong->message));
-        pong->counter = event->counter + 1;
-        APP_EVENT_SUBMIT(pong);
+        struct pong_event_fields pong = {
+            .message = "Hello from the PONG server!",
+            .counter = event.counter + 1,
+        };
+        submit_pong_event(&pong);
         LOG_INF("Sending PONG!");
         return false;
     }
 
     if (is_pong_event(aeh)) {
-        const struct pong_event *event = cast_pong_event(aeh);
-        LOG_INF("PONG! (%d) : %s",event->counter, event->message);
+        struct pong_event_fields event;
+        if (pong_event_get_fields(cast_pong_event(aeh), &event)) {
+            LOG_ERR("Malformed pong event");
+            return false;
+        }
+#ifdef CONFIG_BENCHMARK
+        benchmark_pong_received(&event);
+        return false;
+#endif
+        LOG_INF("PONG! (%d) : %s",event.counter, event.message);
         // k_sleep(K_MSEC(500));
-        struct ping_event *ping = new_ping_event();
-        strncpy(&ping->message[0], "Hello from the PING client!", sizeof(ping->message));
-        ping->counter = event->counter + 1;
-        APP_EVENT_SUBMIT(ping);
+        struct ping_event_fields ping = {
+            .message = "Hello from the PING client!",
+            .counter = event.counter + 1,
+        };
+        submit_ping_event(&ping);
         LOG_INF("Sending PING!");
         return false;
     }
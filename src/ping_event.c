@@ -2,8 +2,13 @@
 
 static void log_ping_event(const struct app_event_header *aeh) {
     const struct ping_event *event = cast_ping_event(aeh);
+    struct ping_event_fields fields;
 
-    APP_EVENT_MANAGER_LOG(aeh, "message: %s", event->message);
+    if (ping_event_get_fields(event, &fields)) {
+        APP_EVENT_MANAGER_LOG(aeh, "malformed");
+        return;
+    }
+    APP_EVENT_MANAGER_LOG(aeh, "message: %s", fields.message);
 }
 
 APP_EVENT_TYPE_DEFINE(ping_event, log_ping_event, NULL, APP_EVENT_FLAGS_CREATE());
\ No newline at end of file
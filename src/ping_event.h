@@ -1,9 +1,17 @@
 #include <app_event_manager.h>
 
+#include "event_wire.h"
+
+/* Fields of a ping event. They cross the link in the compact wire encoding instead of as a padded struct */
+#define PING_EVENT_FIELDS(FIELD)           \
+    FIELD(EVENT_WIRE_STRING, message, 128) \
+    FIELD(EVENT_WIRE_UINT, counter, uint8_t)
+
 struct ping_event {
     struct app_event_header header;
-    char message[128];
-    uint8_t counter;
+    struct event_dyndata dyndata;  // struct ping_event_fields in the compact wire encoding
 };
 
-APP_EVENT_TYPE_DECLARE(ping_event);
\ No newline at end of file
+APP_EVENT_TYPE_DYNDATA_DECLARE(ping_event);
+EVENT_WIRE_SCHEMA_DEFINE(ping_event, PING_EVENT_FIELDS);
+EVENT_WIRE_EVENT_DEFINE(ping_event);
@@ -2,8 +2,13 @@
 
 static void log_pong_event(const struct app_event_header *aeh) {
     const struct pong_event *event = cast_pong_event(aeh);
+    struct pong_event_fields fields;
 
-    APP_EVENT_MANAGER_LOG(aeh, "message: %s", event->message);
+    if (pong_event_get_fields(event, &fields)) {
+        APP_EVENT_MANAGER_LOG(aeh, "malformed");
+        return;
+    }
+    APP_EVENT_MANAGER_LOG(aeh, "message: %s", fields.message);
 }
 
 APP_EVENT_TYPE_DEFINE(pong_event, log_pong_event, NULL, APP_EVENT_FLAGS_CREATE());
\ No newline at end of file
@@ -1,11 +1,23 @@
+#include <zephyr/drivers/uart.h>
 #include <zephyr/fff.h>
 #include <zephyr/random/rand32.h>
+#include <zephyr/sys/crc.h>
 #include <zephyr/ztest.h>
 
-#include "../../drivers/zephyr,uart-ipc-service-backend.c"
-
 DEFINE_FFF_GLOBALS;
 
+/* UART fakes. The UART API consists of inline syscalls, so the driver is redirected to the fakes */
+FAKE_VALUE_FUNC(int, fake_uart_tx, const struct device *, const uint8_t *, size_t, int32_t);
+#define uart_tx fake_uart_tx
+FAKE_VALUE_FUNC(int, fake_uart_rx_enable, const struct device *, uint8_t *, size_t, int32_t);
+#define uart_rx_enable fake_uart_rx_enable
+FAKE_VALUE_FUNC(int, fake_uart_configure, const struct device *, const struct uart_config *);
+#define uart_configure fake_uart_configure
+FAKE_VALUE_FUNC(int, fake_uart_config_get, const struct device *, struct uart_config *);
+#define uart_config_get fake_uart_config_get
+
+#include "../../drivers/zephyr,uart-ipc-service-backend.c"
+
 /* Fakes */
 FAKE_VOID_FUNC(fake_endpoint_cb_received, const void *, size_t, void *);
 FAKE_VOID_FUNC(fake_endpoint_cb_bound, void *);
@@ -19,10 +31,39 @@ void endpoint_error_callback_default(const char *message, void *priv) {
 #define FAKE_LIST(OP)             \
     OP(fake_endpoint_cb_received) \
     OP(fake_endpoint_cb_bound)    \
-    OP(fake_endpoint_cb_error)
+    OP(fake_endpoint_cb_error)    \
+    OP(fake_uart_tx)              \
+    OP(fake_uart_rx_enable)       \
+    OP(fake_uart_configure)       \
+    OP(fake_uart_config_get)
+
+static struct uart_ipc_tx_buf test_tx_bufs[CONFIG_IPC_BACKEND_UART_TX_BUF_COUNT];
+static struct k_mem_slab test_tx_slab;
+#define TEST_RX_BUF_COUNT 3
+#define TEST_RX_BUF_SIZE ROUND_UP(sizeof(struct uart_ipc_frame), sizeof(void *))
+#define TEST_RX_INACTIVITY_TIMEOUT 250
+
+static uint8_t __aligned(sizeof(void *)) test_rx_bufs[TEST_RX_BUF_COUNT * TEST_RX_BUF_SIZE];
+static struct k_mem_slab test_rx_slab;
+static char test_tx_queue_buf[CONFIG_IPC_BACKEND_UART_TX_PRIO_COUNT * CONFIG_IPC_BACKEND_UART_TX_QUEUE_SIZE * sizeof(struct tx_request)];
+
+#ifdef CONFIG_IPC_BACKEND_UART_STATIC_ALLOC
+#define TEST_MSG_BUF_COUNT 3
+#define TEST_MSG_BUF_SIZE 4096
+
+static uint8_t __aligned(4) test_rx_msg_bufs[TEST_MSG_BUF_COUNT * TEST_MSG_BUF_SIZE];
+static struct k_mem_slab test_rx_msg_slab;
+#endif
+
+#define TEST_ENDPOINT_COUNT 2
+#define TEST_ENDPOINT_NAME_LEN 16
 
 static struct uart_ipc_service_backend_suite_fixture {
     struct backend_data instance_data;
+    struct backend_config instance_config;
+    struct backend_endpoint endpoints[TEST_ENDPOINT_COUNT];
+    char endpoint_names[TEST_ENDPOINT_COUNT * (TEST_ENDPOINT_NAME_LEN + 1)];
+    struct arq_state arq;
     struct device instance;
     struct uart_event uart_event;
     struct uart_ipc_frame frame;
@@ -49,7 +90,36 @@ static void suite_before(void *f) {
     memset(fixture, 0, sizeof(*fixture));
 
     fixture->instance.data = &fixture->instance_data;
-    fixture->instance_data.endpoint.cfg.cb = (struct ipc_service_cb){
+    fixture->instance.config = &fixture->instance_config;
+
+    k_mem_slab_init(&test_tx_slab, test_tx_bufs, sizeof(struct uart_ipc_tx_buf), CONFIG_IPC_BACKEND_UART_TX_BUF_COUNT);
+    fixture->instance_config.tx_slab = &test_tx_slab;
+    fixture->instance_data.tx_slab = &test_tx_slab;
+    tx_queues_init(&fixture->instance_data, test_tx_queue_buf);
+    k_mem_slab_init(&test_rx_slab, test_rx_bufs, TEST_RX_BUF_SIZE, TEST_RX_BUF_COUNT);
+    fixture->instance_config.rx_slab = &test_rx_slab;
+    fixture->instance_config.rx_inactivity_timeout_usec = TEST_RX_INACTIVITY_TIMEOUT;
+    fixture->instance_data.rx_slab = &test_rx_slab;
+#ifdef CONFIG_IPC_BACKEND_UART_RX_THREAD
+    k_sem_init(&fixture->instance_data.rx_sem, 0, 1);
+#endif
+    fixture->instance_config.endpoints = fixture->endpoints;
+    fixture->instance_config.endpoint_count = TEST_ENDPOINT_COUNT;
+    fixture->instance_config.endpoint_names = fixture->endpoint_names;
+    fixture->instance_config.endpoint_name_len = TEST_ENDPOINT_NAME_LEN;
+    fixture->instance_config.frag_size = FRAME_FRAG_SIZE;
+#ifdef CONFIG_IPC_BACKEND_UART_STATIC_ALLOC
+    k_mem_slab_init(&test_rx_msg_slab, test_rx_msg_bufs, TEST_MSG_BUF_SIZE, TEST_MSG_BUF_COUNT);
+    fixture->instance_config.rx_msg_pool = &test_rx_msg_slab;
+#endif
+    control_init(&fixture->instance);
+
+    /* Endpoint 0 is bound to peer address 0 */
+    endpoint_init(&fixture->endpoints[0], &fixture->instance, 0);
+    fixture->endpoints[0].is_registered = true;
+    fixture->endpoints[0].is_bound = true;
+    fixture->endpoints[0].cfg.name = "test";
+    fixture->endpoints[0].cfg.cb = (struct ipc_service_cb){
         .received = fake_endpoint_cb_received,
         .bound = fake_endpoint_cb_bound,
         .error = endpoint_error_callback_default,
@@ -57,9 +127,6 @@ static void suite_before(void *f) {
 
     fixture->buffer_container.max = 2;
     fixture->buffer_container.buffers = k_malloc(sizeof(void *) * fixture->buffer_container.max);
-
-    k_work_init(&fixture->instance_data.free_tx_work, free_tx_work_handler);
-    k_work_init_delayable(&fixture->instance_data.endpoint.rx_timeout_work, endpoint_rx_timeout_handler);
 }
 
 static void suite_after(void *f) {
@@ -99,6 +166,45 @@ static int register_test_buffer(void *buffer, struct uart_ipc_service_backend_su
     }
 }
 
+static inline size_t frame_count(size_t len) {
+    return DIV_ROUND_UP(len, FRAME_FRAG_SIZE);
+}
+
+/**
+ * @brief Packages data as the peer would send it, in the wire format of the instance. The destination must hold
+ * at least frame_count(len) fixed size frames, which is always enough for COBS frames.
+ *
+ * @return Number of bytes written
+ */
+static size_t pack_message(const struct backend_config *config, uint8_t *dest, uint8_t addr, const void *data, uint16_t len) {
+    size_t written = 0;
+
+    for (uint16_t frag_start = 0; frag_start < len; frag_start += FRAME_FRAG_SIZE) {
+        struct frame_info info = {
+            .addr = addr,
+            .total_data_length = len,
+            .frag_start = frag_start,
+            .frag = (const uint8_t *)data + frag_start,
+            .frag_len = MIN(FRAME_FRAG_SIZE, len - frag_start),
+        };
+        uint8_t frame[TX_FRAME_MAX_LEN] __aligned(4);
+        size_t frame_len = encode_frame(config, frame, &info);
+        memcpy(dest + written, frame, frame_len);
+        written += frame_len;
+    }
+    return written;
+}
+
+/* Packages data into heap allocated fixed size frames that must be freed by the caller */
+static struct uart_ipc_frame *create_frames(const void *data, uint16_t len, size_t *n_frames) {
+    struct uart_ipc_frame *frames = k_calloc(frame_count(len), sizeof(struct uart_ipc_frame));
+    if (frames != NULL) {
+        const struct backend_config fixed_config = {.framing = UART_IPC_FRAMING_FIXED};
+        *n_frames = pack_message(&fixed_config, (uint8_t *)frames, 0, data, len) / sizeof(struct uart_ipc_frame);
+    }
+    return frames;
+}
+
 static int free_test_buffer(void *buffer, struct uart_ipc_service_backend_suite_fixture *fixture) {
     k_free(buffer);
     for (size_t i = 0; i < fixture->buffer_container.count; i++) {
@@ -110,12 +216,29 @@ static int free_test_buffer(void *buffer, struct uart_ipc_service_backend_suite_
     return 0;
 }
 
+/* Passes fixture->uart_event to the driver and, in RX thread mode, runs the RX thread until it is idle */
+static void send_uart_event(struct uart_ipc_service_backend_suite_fixture *fixture) {
+    uart_callback(NULL, &fixture->uart_event, &fixture->instance);
+#ifdef CONFIG_IPC_BACKEND_UART_RX_THREAD
+    rx_ring_process(&fixture->instance);
+#endif
+}
+
+static void send_tx_done(struct uart_ipc_service_backend_suite_fixture *fixture) {
+    fixture->uart_event = (struct uart_event){
+        .type = UART_TX_DONE,
+        .data.tx.buf = fake_uart_tx_fake.arg1_val,
+        .data.tx.len = fake_uart_tx_fake.arg2_val,
+    };
+    uart_callback(NULL, &fixture->uart_event, &fixture->instance);
+}
+
 /* Endpoint callback functions */
 
 /* Error callbacks */
-void endpoint_error_callback_expect_frame_wrong_size(const char *message, void *priv) {
+void endpoint_error_callback_expect_resync(const char *message, void *priv) {
     fake_endpoint_cb_error(message, priv);  // Call to track number of error callbacks
-    char msg[] = "Received data is not a valid frame. IPC instance is in an invalid state";
+    char msg[] = "Received data is not a valid frame, resynchronizing";
     zassert_mem_equal(message, msg, sizeof(msg), "Wrong error message");
 }
 
@@ -130,22 +253,62 @@ void endpoint_receive_callback_validate_data(const void *data, size_t len, void
     zassert_mem_equal(data, expected_result->data, len, "Wrong data");
 }
 
+/* Holds the delivered buffer. priv is the fixture, the expected data is passed through held_rx_expected */
+static struct sized_buffer *held_rx_expected;
+static void *held_rx_buffer;
+
+void endpoint_receive_callback_hold(const void *data, size_t len, void *priv) {
+    struct uart_ipc_service_backend_suite_fixture *fixture = priv;
+    endpoint_receive_callback_validate_data(data, len, held_rx_expected);
+
+    int err = hold_rx_buffer(&fixture->instance, &fixture->endpoints[0], (void *)data);
+    zassert_equal(err, 0, "Failed to hold rx buffer %d", err);
+    held_rx_buffer = (void *)data;
+}
+
 /*================================= Tests ===============================*/
 
-ZTEST_F(uart_ipc_service_backend_suite, test_error_frame_wrong_size) {
-    fixture->uart_event = (struct uart_event){
-        .type = UART_RX_RDY,
-        .data.rx.buf = NULL,
-        .data.rx.len = sizeof(struct uart_ipc_frame) - 1,  // Received 1 byte less than expected
-    };
+ZTEST_F(uart_ipc_service_backend_suite, test_resync_after_truncated_frame) {
+    uint16_t total_data_length = FRAME_FRAG_SIZE;
+    uint8_t data[total_data_length];
+    sys_rand_get(data, total_data_length);
 
-    fixture->instance_data.endpoint.cfg.cb.error = endpoint_error_callback_expect_frame_wrong_size;
+    size_t n_frames = 0;
+    struct uart_ipc_frame *frame = create_frames(data, total_data_length, &n_frames);
+    register_test_buffer(frame, fixture);
+
+    /* A frame missing its last byte followed by two intact frames */
+    const size_t frame_size = sizeof(struct uart_ipc_frame);
+    size_t stream_len = 3 * frame_size - 1;
+    uint8_t *stream = k_malloc(stream_len);
+    register_test_buffer(stream, fixture);
+    memcpy(stream, frame, frame_size - 1);
+    memcpy(stream + frame_size - 1, frame, frame_size);
+    memcpy(stream + 2 * frame_size - 1, frame, frame_size);
 
-    uart_callback(NULL, &fixture->uart_event, &fixture->instance);
+    struct sized_buffer expected_result = {
+        .size = total_data_length,
+        .data = data,
+    };
+    fixture->endpoints[0].cfg.priv = &expected_result;
+    fixture->endpoints[0].cfg.cb.received = endpoint_receive_callback_validate_data;
+    fixture->endpoints[0].cfg.cb.error = endpoint_error_callback_expect_resync;
+
+    const size_t chunk_size = 13;
+    for (size_t offset = 0; offset < stream_len; offset += chunk_size) {
+        fixture->uart_event = (struct uart_event){
+            .type = UART_RX_RDY,
+            .data.rx.buf = stream,
+            .data.rx.offset = offset,
+            .data.rx.len = MIN(chunk_size, stream_len - offset),
+        };
+        send_uart_event(fixture);
+    }
 
     zassert_equal(1, fake_endpoint_cb_error_fake.call_count, "Wrong number of calls to endpoint error callback");
-    zassert_equal(0, fake_endpoint_cb_received_fake.call_count, "Wrong number of calls to endpoint received callback");
+    zassert_equal(2, fake_endpoint_cb_received_fake.call_count, "Wrong number of calls to endpoint received callback");
     zassert_equal(0, fake_endpoint_cb_bound_fake.call_count, "Wrong number of calls to endpoint bound callback");
+    zassert_false(fixture->instance_data.rx_resyncing, "Frame alignment not recovered");
 }
 
 ZTEST_F(uart_ipc_service_backend_suite, test_roundtrip_data_frame_creation) {
@@ -202,16 +365,16 @@ ZTEST_F(uart_ipc_service_backend_suite, test_one_frame_received_successfully) {
         .data.rx.len = sizeof(struct uart_ipc_frame) * n_frames,
     };
 
-    fixture->instance_data.endpoint.cfg.cb.received = endpoint_receive_callback_validate_data;
+    fixture->endpoints[0].cfg.cb.received = endpoint_receive_callback_validate_data;
 
     struct sized_buffer expected_result = {
         .size = total_data_length,
         .data = data,
     };
 
-    fixture->instance_data.endpoint.cfg.priv = &expected_result;
+    fixture->endpoints[0].cfg.priv = &expected_result;
 
-    uart_callback(NULL, &fixture->uart_event, &fixture->instance);
+    send_uart_event(fixture);
 
     zassert_equal(fake_endpoint_cb_error_fake.call_count, 0, "Wrong number of calls to endpoint error callback");
     zassert_equal(fake_endpoint_cb_received_fake.call_count, 1, "Wrong number of calls to endpoint received callback");
@@ -220,7 +383,7 @@ ZTEST_F(uart_ipc_service_backend_suite, test_one_frame_received_successfully) {
 
 ZTEST_F(uart_ipc_service_backend_suite, test_multiple_frames_received_successfully) {
 
-    fixture->instance_data.endpoint.cfg.cb.received = endpoint_receive_callback_validate_data;
+    fixture->endpoints[0].cfg.cb.received = endpoint_receive_callback_validate_data;
 
     uint16_t total_data_length = sizeof(((struct uart_ipc_frame *)0)->frag) * 10 + 5;
     uint8_t *data = k_malloc(total_data_length);
@@ -238,7 +401,7 @@ ZTEST_F(uart_ipc_service_backend_suite, test_multiple_frames_received_successful
         .size = total_data_length,
         .data = data,
     };
-    fixture->instance_data.endpoint.cfg.priv = &expected_result;
+    fixture->endpoints[0].cfg.priv = &expected_result;
 
     for (int i = 0; i < n_frames; ++i){
         fixture->uart_event = (struct uart_event){
@@ -246,10 +409,1395 @@ ZTEST_F(uart_ipc_service_backend_suite, test_multiple_frames_received_successful
             .data.rx.buf = &frames[i],
             .data.rx.len = sizeof(struct uart_ipc_frame),
         };
-        uart_callback(NULL, &fixture->uart_event, &fixture->instance);
+        send_uart_event(fixture);
     } 
 
     zassert_equal(fake_endpoint_cb_error_fake.call_count, 0, "Called %d times", fake_endpoint_cb_error_fake.call_count);
     zassert_equal(fake_endpoint_cb_received_fake.call_count, 1, "Called %d times", fake_endpoint_cb_received_fake.call_count);
     zassert_equal(fake_endpoint_cb_bound_fake.call_count, 0, "Called %d times", fake_endpoint_cb_bound_fake.call_count);
 }
+
+ZTEST_F(uart_ipc_service_backend_suite, test_lost_fragment_drops_partial_message) {
+    uint16_t total_data_length = 3 * FRAME_FRAG_SIZE;
+    uint8_t lost[3 * FRAME_FRAG_SIZE];
+    uint8_t data[3 * FRAME_FRAG_SIZE];
+    sys_rand_get(lost, sizeof(lost));
+    sys_rand_get(data, sizeof(data));
+
+    size_t n_frames = 0;
+    struct uart_ipc_frame *lost_frames = create_frames(lost, total_data_length, &n_frames);
+    register_test_buffer(lost_frames, fixture);
+    struct uart_ipc_frame *frames = create_frames(data, total_data_length, &n_frames);
+    register_test_buffer(frames, fixture);
+
+    struct sized_buffer expected_result = {
+        .size = total_data_length,
+        .data = data,
+    };
+    fixture->endpoints[0].cfg.cb.received = endpoint_receive_callback_validate_data;
+    fixture->endpoints[0].cfg.priv = &expected_result;
+
+    /* The middle fragment of the first message is lost, the next message of the same length starts over */
+    const struct uart_ipc_frame *stream[] = {&lost_frames[0], &lost_frames[2], &frames[0], &frames[1], &frames[2]};
+    for (size_t i = 0; i < ARRAY_SIZE(stream); ++i) {
+        fixture->uart_event = (struct uart_event){
+            .type = UART_RX_RDY,
+            .data.rx.buf = (uint8_t *)stream[i],
+            .data.rx.len = sizeof(struct uart_ipc_frame),
+        };
+        send_uart_event(fixture);
+    }
+
+    zassert_equal(fake_endpoint_cb_received_fake.call_count, 1, "Called %d times", fake_endpoint_cb_received_fake.call_count);
+    zassert_is_null(fixture->endpoints[0].rx_buffer, "Reassembly buffer not released");
+}
+
+ZTEST_F(uart_ipc_service_backend_suite, test_nocopy_multi_frame_message) {
+    fixture->instance_data.is_opened = true;
+    void *token = &fixture->endpoints[0];
+
+    uint8_t *payload = NULL;
+    uint32_t len = 0;
+    int err = get_tx_buffer(&fixture->instance, token, (void **)&payload, &len, K_NO_WAIT);
+    zassert_equal(err, 0, "Failed to get tx buffer %d", err);
+    zassert_equal(len, CONFIG_IPC_BACKEND_UART_TX_BUF_FRAMES * FRAME_FRAG_SIZE, "Wrong buffer size %d", len);
+
+    uint8_t data[FRAME_FRAG_SIZE + FRAME_FRAG_SIZE / 2];
+    sys_rand_get(data, sizeof(data));
+    memcpy(payload, data, sizeof(data));
+
+    err = send_nocopy(&fixture->instance, token, payload, sizeof(data));
+    zassert_equal(err, 0, "Failed to send %d", err);
+
+    uint8_t unwrapped_data[sizeof(data)];
+    for (size_t i = 0; i < frame_count(sizeof(data)); ++i) {
+        zassert_equal(fake_uart_tx_fake.call_count, i + 1, "Called %d times", fake_uart_tx_fake.call_count);
+        zassert_equal(fake_uart_tx_fake.arg2_val, sizeof(struct uart_ipc_frame), "Wrong transfer size");
+
+        struct uart_ipc_frame *frame = (struct uart_ipc_frame *)fake_uart_tx_fake.arg1_val;
+        size_t unwrapped_bytes = 0;
+        zassert_ok(check_frame(frame), "Invalid frame");
+        err = unwrap_frame(unwrapped_data, sizeof(unwrapped_data), frame, &unwrapped_bytes);
+        zassert_equal(err, 0, "Failed to unwrap frame %d", err);
+
+        fixture->uart_event = (struct uart_event){
+            .type = UART_TX_DONE,
+        };
+        uart_callback(NULL, &fixture->uart_event, &fixture->instance);
+    }
+    zassert_mem_equal(data, unwrapped_data, sizeof(data), "Wrong data");
+    zassert_equal(fake_uart_tx_fake.call_count, 2, "Called %d times", fake_uart_tx_fake.call_count);
+    zassert_equal(k_mem_slab_num_used_get(&test_tx_slab), 0, "TX buffer was not returned to the pool");
+}
+
+ZTEST_F(uart_ipc_service_backend_suite, test_nocopy_single_frame_sent_in_place) {
+    fixture->instance_data.is_opened = true;
+    void *token = &fixture->endpoints[0];
+
+    uint8_t *payload = NULL;
+    uint32_t len = FRAME_FRAG_SIZE;
+    zassert_equal(get_tx_buffer(&fixture->instance, token, (void **)&payload, &len, K_NO_WAIT), 0, "Failed to get tx buffer");
+    sys_rand_get(payload, FRAME_FRAG_SIZE / 2);
+    zassert_equal(send_nocopy(&fixture->instance, token, payload, FRAME_FRAG_SIZE / 2), 0, "Failed to send");
+
+    /* The frame is encoded around the payload and sent from the TX buffer, which is kept until it is done */
+    const struct uart_ipc_frame *frame = (const struct uart_ipc_frame *)fake_uart_tx_fake.arg1_val;
+    zassert_equal_ptr(frame->frag, payload, "Frame was not encoded in place");
+    zassert_ok(check_frame(frame), "Invalid frame");
+    zassert_equal(k_mem_slab_num_used_get(&test_tx_slab), 1, "TX buffer returned while the frame is on the line");
+
+    send_tx_done(fixture);
+    zassert_equal(k_mem_slab_num_used_get(&test_tx_slab), 0, "TX buffer was not returned to the pool");
+}
+
+ZTEST_F(uart_ipc_service_backend_suite, test_get_tx_buffer_too_large) {
+    fixture->instance_data.is_opened = true;
+
+    void *payload = NULL;
+    uint32_t len = sizeof(((struct uart_ipc_tx_buf *)0)->data) + 1;
+    int err = get_tx_buffer(&fixture->instance, &fixture->endpoints[0], &payload, &len, K_NO_WAIT);
+
+    zassert_equal(err, -ENOMEM, "Wrong error code %d", err);
+    zassert_equal(len, sizeof(((struct uart_ipc_tx_buf *)0)->data), "Maximum size not reported");
+    zassert_equal(k_mem_slab_num_used_get(&test_tx_slab), 0, "TX buffer leaked");
+}
+
+ZTEST_F(uart_ipc_service_backend_suite, test_drop_tx_buffer) {
+    fixture->instance_data.is_opened = true;
+    void *token = &fixture->endpoints[0];
+
+    void *payload = NULL;
+    uint32_t len = 0;
+    zassert_equal(get_tx_buffer(&fixture->instance, token, &payload, &len, K_NO_WAIT), 0, "Failed to get tx buffer");
+    zassert_equal(k_mem_slab_num_used_get(&test_tx_slab), 1, "TX buffer not taken from the pool");
+
+    uint8_t not_a_tx_buffer[4];
+    zassert_equal(drop_tx_buffer(&fixture->instance, token, not_a_tx_buffer), -ENXIO, "Foreign buffer accepted");
+
+    zassert_equal(drop_tx_buffer(&fixture->instance, token, payload), 0, "Failed to drop tx buffer");
+    zassert_equal(k_mem_slab_num_used_get(&test_tx_slab), 0, "TX buffer was not returned to the pool");
+    zassert_equal(fake_uart_tx_fake.call_count, 0, "Dropped buffer was sent");
+}
+
+ZTEST_F(uart_ipc_service_backend_suite, test_hold_rx_buffer) {
+    uint16_t total_data_length = FRAME_FRAG_SIZE + 3;
+    uint8_t data[total_data_length];
+    sys_rand_get(data, total_data_length);
+
+    size_t n_frames = 0;
+    struct uart_ipc_frame *frames = create_frames(data, total_data_length, &n_frames);
+    register_test_buffer(frames, fixture);
+
+    struct sized_buffer expected_result = {
+        .size = total_data_length,
+        .data = data,
+    };
+    struct backend_endpoint *endpoint = &fixture->endpoints[0];
+    endpoint->cfg.cb.received = endpoint_receive_callback_hold;
+    endpoint->cfg.priv = fixture;
+    held_rx_expected = &expected_result;
+    held_rx_buffer = NULL;
+
+    for (int i = 0; i < n_frames; ++i) {
+        int err = receive_frame(&fixture->instance, &frames[i], K_FOREVER);
+        zassert_equal(err, 0, "Failed to receive frame %d", err);
+    }
+
+    zassert_equal(fake_endpoint_cb_received_fake.call_count, 1, "Called %d times", fake_endpoint_cb_received_fake.call_count);
+    zassert_not_null(held_rx_buffer, "Buffer was not held");
+    zassert_is_null(endpoint->rx_buffer, "Held buffer is still used for reassembly");
+    zassert_mem_equal(held_rx_buffer, data, total_data_length, "Held buffer was modified");
+
+    uint8_t not_held[4];
+    zassert_equal(release_rx_buffer(&fixture->instance, endpoint, not_held), -EINVAL, "Released a buffer that is not held");
+    zassert_equal(release_rx_buffer(&fixture->instance, &fixture->endpoints[1], held_rx_buffer), -EINVAL,
+                  "Released a buffer held by another endpoint");
+
+    zassert_equal(release_rx_buffer(&fixture->instance, endpoint, held_rx_buffer), 0, "Failed to release rx buffer");
+    zassert_equal(release_rx_buffer(&fixture->instance, endpoint, held_rx_buffer), -EINVAL, "Released buffer twice");
+}
+
+ZTEST_F(uart_ipc_service_backend_suite, test_send_queues_while_busy) {
+    fixture->instance_data.is_opened = true;
+    void *token = &fixture->endpoints[0];
+    uint8_t data[FRAME_FRAG_SIZE];
+    sys_rand_get(data, sizeof(data));
+
+    /* The message on the line is sent straight from its TX buffer, which it keeps until the frame is done */
+    const int message_count = CONFIG_IPC_BACKEND_UART_TX_BUF_COUNT;
+    for (int i = 0; i < message_count; ++i) {
+        int err = send(&fixture->instance, token, data, sizeof(data));
+        zassert_equal(err, 0, "Send %d failed %d", i, err);
+    }
+
+    /* Only the first message is on the line, the rest wait in the queue */
+    zassert_equal(fake_uart_tx_fake.call_count, 1, "Called %d times", fake_uart_tx_fake.call_count);
+
+    /* Every TX buffer is in use, so further messages are rejected instead of blocking */
+    zassert_equal(send(&fixture->instance, token, data, sizeof(data)), -EAGAIN, "Send did not fail on full queue");
+
+    /* Each completed transfer starts the next one straight from the callback */
+    for (int i = 1; i < message_count; ++i) {
+        send_tx_done(fixture);
+        zassert_equal(fake_uart_tx_fake.call_count, i + 1, "Called %d times", fake_uart_tx_fake.call_count);
+    }
+    send_tx_done(fixture);
+
+    zassert_equal(fake_uart_tx_fake.call_count, message_count, "Called %d times", fake_uart_tx_fake.call_count);
+    zassert_equal(k_mem_slab_num_used_get(&test_tx_slab), 0, "TX buffers were not returned to the pool");
+    zassert_equal(atomic_get(&fixture->instance_data.tx_busy), 0, "Transmitter still busy");
+}
+
+ZTEST_F(uart_ipc_service_backend_suite, test_cobs_roundtrip) {
+    uint8_t data[COBS_IN_PLACE_MAX_LEN];
+    sys_rand_get(data, sizeof(data));
+    for (size_t i = 0; i < sizeof(data); i += 5) {
+        data[i] = 0;  // Make sure there are zeros to encode
+    }
+
+    uint8_t buf[sizeof(data) + 1];
+    memcpy(buf + 1, data, sizeof(data));
+    size_t encoded_len = cobs_encode_in_place(buf, sizeof(data));
+
+    zassert_equal(encoded_len, sizeof(data) + 1, "Wrong encoded length %d", encoded_len);
+    zassert_is_null(memchr(buf, COBS_DELIMITER, encoded_len), "Encoded data contains a delimiter");
+
+    int decoded_len = cobs_decode(buf, buf, encoded_len);
+    zassert_equal(decoded_len, sizeof(data), "Wrong decoded length %d", decoded_len);
+    zassert_mem_equal(buf, data, sizeof(data), "Decoded data differs");
+}
+
+ZTEST_F(uart_ipc_service_backend_suite, test_cobs_frames_received_in_chunks) {
+    fixture->instance_config.framing = UART_IPC_FRAMING_COBS;
+    fixture->endpoints[0].cfg.cb.received = endpoint_receive_callback_validate_data;
+
+    uint16_t total_data_length = FRAME_FRAG_SIZE * 2 + 5;
+    uint8_t data[total_data_length];
+    sys_rand_get(data, total_data_length);
+
+    uint8_t *wire = k_malloc(frame_count(total_data_length) * sizeof(struct uart_ipc_frame));
+    register_test_buffer(wire, fixture);
+    size_t wire_len = pack_message(&fixture->instance_config, wire, 0, data, total_data_length);
+
+    /* The short last fragment is not padded */
+    zassert_true(wire_len < frame_count(total_data_length) * sizeof(struct uart_ipc_frame), "COBS frames were padded");
+
+    struct sized_buffer expected_result = {
+        .size = total_data_length,
+        .data = data,
+    };
+    fixture->endpoints[0].cfg.priv = &expected_result;
+
+    /* Chunk boundaries do not line up with frame boundaries */
+    const size_t chunk_size = 7;
+    for (size_t offset = 0; offset < wire_len; offset += chunk_size) {
+        fixture->uart_event = (struct uart_event){
+            .type = UART_RX_RDY,
+            .data.rx.buf = wire,
+            .data.rx.offset = offset,
+            .data.rx.len = MIN(chunk_size, wire_len - offset),
+        };
+        send_uart_event(fixture);
+    }
+
+    zassert_equal(fake_endpoint_cb_error_fake.call_count, 0, "Called %d times", fake_endpoint_cb_error_fake.call_count);
+    zassert_equal(fake_endpoint_cb_received_fake.call_count, 1, "Called %d times", fake_endpoint_cb_received_fake.call_count);
+}
+
+ZTEST_F(uart_ipc_service_backend_suite, test_crc_matches_reference) {
+    uint8_t data[300];
+    sys_rand_get(data, sizeof(data));
+
+    /* Covers every tail length of the word at a time loop */
+    for (size_t len = 0; len <= sizeof(data); len += (len < 16) ? 1 : 37) {
+        zassert_equal(uart_ipc_crc32(data, len), crc32_ieee(data, len), "crc32 differs for %d bytes", len);
+        zassert_equal(uart_ipc_crc16(data, len), crc16_itu_t(0xFFFF, data, len), "crc16 differs for %d bytes", len);
+    }
+}
+
+ZTEST_F(uart_ipc_service_backend_suite, test_cobs_short_frame_uses_crc16) {
+    fixture->instance_config.framing = UART_IPC_FRAMING_COBS;
+    fixture->endpoints[0].cfg.cb.received = endpoint_receive_callback_validate_data;
+
+    uint8_t data[5];
+    sys_rand_get(data, sizeof(data));
+
+    uint8_t wire[sizeof(struct uart_ipc_frame)];
+    size_t wire_len = pack_message(&fixture->instance_config, wire, 0, data, sizeof(data));
+
+    /* Header, data, crc16, COBS code byte and delimiter */
+    zassert_equal(wire_len, sizeof(struct uart_ipc_cobs_header) + sizeof(data) + sizeof(uint16_t) + 2, "Wrong frame size %d", wire_len);
+
+    struct sized_buffer expected_result = {
+        .size = sizeof(data),
+        .data = data,
+    };
+    fixture->endpoints[0].cfg.priv = &expected_result;
+
+    fixture->uart_event = (struct uart_event){
+        .type = UART_RX_RDY,
+        .data.rx.buf = wire,
+        .data.rx.len = wire_len,
+    };
+    send_uart_event(fixture);
+
+    zassert_equal(fake_endpoint_cb_error_fake.call_count, 0, "Called %d times", fake_endpoint_cb_error_fake.call_count);
+    zassert_equal(fake_endpoint_cb_received_fake.call_count, 1, "Called %d times", fake_endpoint_cb_received_fake.call_count);
+}
+
+ZTEST_F(uart_ipc_service_backend_suite, test_fec_repairs_corrupted_bytes) {
+    fixture->instance_config.fec = true;
+    fixture->endpoints[0].cfg.cb.received = endpoint_receive_callback_validate_data;
+
+    /* No zero bytes, so that the corrupted bytes of COBS frames are never code bytes */
+    uint8_t data[FRAME_FRAG_SIZE + 10];
+    for (size_t i = 0; i < sizeof(data); ++i) {
+        data[i] = i + 1;
+    }
+    struct sized_buffer expected_result = {
+        .size = sizeof(data),
+        .data = data,
+    };
+    fixture->endpoints[0].cfg.priv = &expected_result;
+    uint8_t wire[2 * TX_FRAME_MAX_LEN];
+
+    /* Fixed frames carry their parity after the crc. As many bytes as the parity repairs are corrupted in each
+     * frame, parity included */
+    const size_t fixed_len = sizeof(struct uart_ipc_frame) + UART_IPC_FEC_PARITY_LEN;
+    size_t wire_len = pack_message(&fixture->instance_config, wire, 0, data, sizeof(data));
+    zassert_equal(wire_len, 2 * fixed_len, "Wrong frame size %d", wire_len);
+    for (size_t frame = 0; frame < 2; ++frame) {
+        for (size_t i = 0; i < UART_IPC_FEC_PARITY_LEN / 2; ++i) {
+            wire[frame * fixed_len + i * (fixed_len - 1) / (UART_IPC_FEC_PARITY_LEN / 2 - 1)] ^= 0x5A;
+        }
+    }
+    receive_bytes(&fixture->instance, wire, wire_len);
+    zassert_equal(fake_endpoint_cb_received_fake.call_count, 1, "Called %d times", fake_endpoint_cb_received_fake.call_count);
+    zassert_equal(atomic_get(&fixture->instance_data.stats.counters[STATS_fec_corrected]), UART_IPC_FEC_PARITY_LEN,
+                  "Repairs not counted");
+
+    /* In COBS frames the parity is encoded along with the frame */
+    fixture->instance_config.framing = UART_IPC_FRAMING_COBS;
+    wire_len = pack_message(&fixture->instance_config, wire, 0, data, sizeof(data));
+    for (size_t i = 0; i < UART_IPC_FEC_PARITY_LEN / 2; ++i) {
+        wire[1 + sizeof(struct uart_ipc_cobs_header) + 2 * i] ^= 0x5A;
+    }
+    receive_bytes(&fixture->instance, wire, wire_len);
+    zassert_equal(fake_endpoint_cb_received_fake.call_count, 2, "Called %d times", fake_endpoint_cb_received_fake.call_count);
+
+    /* One more corrupted byte than the parity repairs loses the message */
+    wire_len = pack_message(&fixture->instance_config, wire, 0, data, sizeof(data));
+    for (size_t i = 0; i <= UART_IPC_FEC_PARITY_LEN / 2; ++i) {
+        wire[1 + sizeof(struct uart_ipc_cobs_header) + 2 * i] ^= 0x5A;
+    }
+    receive_bytes(&fixture->instance, wire, wire_len);
+    zassert_equal(fake_endpoint_cb_received_fake.call_count, 2, "Corrupted message delivered");
+    zassert_equal(atomic_get(&fixture->instance_data.stats.counters[STATS_fec_failures]), 1, "Failure not counted");
+}
+
+/* Passes a message from the given peer address through the RX path */
+static void receive_from_peer(struct uart_ipc_service_backend_suite_fixture *fixture, uint8_t addr, const void *data, uint16_t len) {
+    uint8_t wire[CONFIG_IPC_BACKEND_UART_TX_BUF_FRAMES * sizeof(struct uart_ipc_frame)];
+    fixture->uart_event = (struct uart_event){
+        .type = UART_RX_RDY,
+        .data.rx.buf = wire,
+        .data.rx.len = pack_message(&fixture->instance_config, wire, addr, data, len),
+    };
+    send_uart_event(fixture);
+}
+
+ZTEST_F(uart_ipc_service_backend_suite, test_endpoints_bound_by_name) {
+    fixture->instance_data.is_opened = true;
+    atomic_set(&fixture->instance_data.link_up, 1);
+    fixture->endpoints[0].cfg.priv = &fixture->endpoints[0];
+
+    const struct ipc_ept_cfg cfg = {
+        .name = "second",
+        .cb = {
+            .bound = fake_endpoint_cb_bound,
+            .received = fake_endpoint_cb_received,
+        },
+        .priv = &fixture->endpoints[1],
+    };
+    void *token = NULL;
+    zassert_equal(register_endpoint(&fixture->instance, &token, &cfg), 0, "Failed to register endpoint");
+    zassert_equal(token, &fixture->endpoints[1], "Endpoint not placed in the first free slot");
+    zassert_equal(fake_endpoint_cb_bound_fake.call_count, 0, "Bound before the peer registered the endpoint");
+
+    /* The endpoint is announced on the control channel */
+    zassert_equal(fake_uart_tx_fake.call_count, 1, "Called %d times", fake_uart_tx_fake.call_count);
+    const struct uart_ipc_frame *frame = (const struct uart_ipc_frame *)fake_uart_tx_fake.arg1_val;
+    const struct uart_ipc_control_header *header = (const struct uart_ipc_control_header *)frame->frag;
+    zassert_equal(frame->addr, UART_IPC_ADDR_CONTROL, "Not sent on the control channel");
+    zassert_equal(header->type, UART_IPC_CONTROL_BIND_REQ, "Wrong control message");
+    zassert_equal(header->addr, 1, "Wrong endpoint address");
+    zassert_mem_equal(frame->frag + sizeof(*header), "second", strlen("second"), "Wrong endpoint name");
+
+    /* The peer registers an endpoint with the same name at address 5 */
+    uint8_t bind[sizeof(struct uart_ipc_control_header) + sizeof("second") - 1] = {UART_IPC_CONTROL_BIND_REQ, 5};
+    memcpy(bind + sizeof(struct uart_ipc_control_header), "second", strlen("second"));
+    receive_from_peer(fixture, UART_IPC_ADDR_CONTROL, bind, sizeof(bind));
+
+    zassert_equal(fake_endpoint_cb_bound_fake.call_count, 1, "Called %d times", fake_endpoint_cb_bound_fake.call_count);
+    zassert_equal(fake_endpoint_cb_bound_fake.arg0_val, &fixture->endpoints[1], "Wrong endpoint bound");
+    zassert_equal(k_msgq_num_used_get(&fixture->instance_data.tx_queues[0]), 1, "Bind request was not answered");
+
+    /* Frames are delivered by peer address */
+    uint8_t data[8];
+    sys_rand_get(data, sizeof(data));
+    receive_from_peer(fixture, 5, data, sizeof(data));
+    zassert_equal(fake_endpoint_cb_received_fake.call_count, 1, "Called %d times", fake_endpoint_cb_received_fake.call_count);
+    zassert_equal(fake_endpoint_cb_received_fake.arg2_val, &fixture->endpoints[1], "Delivered to the wrong endpoint");
+
+    receive_from_peer(fixture, 0, data, sizeof(data));
+    zassert_equal(fake_endpoint_cb_received_fake.call_count, 2, "Called %d times", fake_endpoint_cb_received_fake.call_count);
+    zassert_equal(fake_endpoint_cb_received_fake.arg2_val, &fixture->endpoints[0], "Delivered to the wrong endpoint");
+
+    /* Nothing is bound to address 7 */
+    receive_from_peer(fixture, 7, data, sizeof(data));
+    zassert_equal(fake_endpoint_cb_received_fake.call_count, 2, "Frame for an unbound address was delivered");
+    zassert_equal(fake_endpoint_cb_error_fake.call_count, 0, "Called %d times", fake_endpoint_cb_error_fake.call_count);
+}
+
+ZTEST_F(uart_ipc_service_backend_suite, test_register_endpoint_limits) {
+    struct ipc_ept_cfg cfg = {.name = "test"};
+    void *token = NULL;
+
+    zassert_equal(register_endpoint(&fixture->instance, &token, &cfg), -EALREADY, "Duplicate name accepted");
+
+    cfg.name = "a_name_that_is_too_long";
+    zassert_equal(register_endpoint(&fixture->instance, &token, &cfg), -EINVAL, "Too long name accepted");
+
+    cfg.name = "second";
+    zassert_equal(register_endpoint(&fixture->instance, &token, &cfg), 0, "Failed to register endpoint");
+    cfg.name = "third";
+    zassert_equal(register_endpoint(&fixture->instance, &token, &cfg), -ENOMEM, "More than max_endpoint_count endpoints registered");
+    zassert_equal(fake_uart_tx_fake.call_count, 0, "Endpoint announced before the instance was opened");
+}
+
+/* Passes a hello from a peer with the given capabilities through the RX path */
+static void receive_hello_with_capabilities(struct uart_ipc_service_backend_suite_fixture *fixture, uint8_t capabilities, uint32_t session,
+                                            uint32_t peer_session, uint8_t flags) {
+    uint8_t msg[sizeof(struct uart_ipc_link_header) + sizeof(struct uart_ipc_hello)] = {UART_IPC_LINK_HELLO};
+    const struct uart_ipc_hello hello = {
+        .version = UART_IPC_PROTOCOL_VERSION,
+        .capabilities = capabilities,
+        .flags = flags,
+        .frag_size = FRAME_FRAG_SIZE,
+        .session = sys_cpu_to_le32(session),
+        .peer_session = sys_cpu_to_le32(peer_session),
+    };
+    memcpy(msg + sizeof(struct uart_ipc_link_header), &hello, sizeof(hello));
+    receive_from_peer(fixture, UART_IPC_ADDR_LINK, msg, sizeof(msg));
+}
+
+/* Passes a hello from a peer configured like the instance through the RX path */
+static void receive_hello_from_peer(struct uart_ipc_service_backend_suite_fixture *fixture, uint32_t session, uint32_t peer_session, uint8_t flags) {
+    receive_hello_with_capabilities(fixture, link_capabilities(&fixture->instance_config), session, peer_session, flags);
+}
+
+/* Checks that the last frame passed to uart_tx is a hello answering the given peer session */
+static void expect_hello_sent(uint32_t session, uint32_t peer_session) {
+    const struct uart_ipc_frame *frame = (const struct uart_ipc_frame *)fake_uart_tx_fake.arg1_val;
+    struct uart_ipc_hello hello;
+
+    zassert_equal(frame->addr, UART_IPC_ADDR_LINK, "Not a link message");
+    zassert_equal(frame->frag[0], UART_IPC_LINK_HELLO, "Not a hello");
+    memcpy(&hello, frame->frag + sizeof(struct uart_ipc_link_header), sizeof(hello));
+    zassert_equal(hello.version, UART_IPC_PROTOCOL_VERSION, "Wrong protocol version");
+    zassert_equal(sys_le32_to_cpu(hello.session), session, "Wrong session");
+    zassert_equal(sys_le32_to_cpu(hello.peer_session), peer_session, "Peer session not echoed");
+}
+
+ZTEST_F(uart_ipc_service_backend_suite, test_link_handshake_binds_and_rebinds) {
+    fixture->instance_data.is_opened = true;
+    fixture->instance_data.link_session = 0x1234;
+    fixture->endpoints[0].is_bound = false;
+    uint8_t bind_rsp[sizeof(struct uart_ipc_control_header) + sizeof("test") - 1] = {UART_IPC_CONTROL_BIND_RSP, 3};
+    memcpy(bind_rsp + sizeof(struct uart_ipc_control_header), "test", strlen("test"));
+
+    for (uint32_t peer_session = 0xbeef; peer_session <= 0xcafe; peer_session += 0xcafe - 0xbeef) {
+        /* The peer (re)starts: its hello is answered, but nothing is announced until it echoes the local session */
+        receive_hello_from_peer(fixture, peer_session, 0, 0);
+        zassert_false(atomic_get(&fixture->instance_data.link_up), "Link up before the peer echoed the session");
+        zassert_false(fixture->endpoints[0].is_bound, "Endpoint bound before the link is up");
+        expect_hello_sent(0x1234, peer_session);
+        send_tx_done(fixture);
+
+        size_t tx_count = fake_uart_tx_fake.call_count;
+        receive_hello_from_peer(fixture, peer_session, 0x1234, UART_IPC_HELLO_FLAG_UP);
+        zassert_true(atomic_get(&fixture->instance_data.link_up), "Link not up");
+
+        /* Only the endpoint is announced, the hello of a peer whose link is up is not answered */
+        zassert_equal(fake_uart_tx_fake.call_count, tx_count + 1, "Called %d times", fake_uart_tx_fake.call_count);
+        const struct uart_ipc_frame *frame = (const struct uart_ipc_frame *)fake_uart_tx_fake.arg1_val;
+        zassert_equal(frame->addr, UART_IPC_ADDR_CONTROL, "Endpoint not announced");
+        zassert_equal(((const struct uart_ipc_control_header *)frame->frag)->type, UART_IPC_CONTROL_BIND_REQ, "Wrong control message");
+        send_tx_done(fixture);
+
+        receive_from_peer(fixture, UART_IPC_ADDR_CONTROL, bind_rsp, sizeof(bind_rsp));
+        zassert_true(fixture->endpoints[0].is_bound, "Endpoint not bound");
+        zassert_equal(fixture->endpoints[0].remote_addr, 3, "Bound to the wrong peer address");
+    }
+
+    /* The restart was reported, and the endpoint was bound once per start of the peer */
+    zassert_equal(fake_endpoint_cb_error_fake.call_count, 1, "Called %d times", fake_endpoint_cb_error_fake.call_count);
+    zassert_equal(fake_endpoint_cb_bound_fake.call_count, 2, "Called %d times", fake_endpoint_cb_bound_fake.call_count);
+    zassert_equal(atomic_get(&fixture->instance_data.tx_busy), 0, "Transmitter still busy");
+}
+
+ZTEST_F(uart_ipc_service_backend_suite, test_hello_with_other_capabilities_ignored) {
+    fixture->instance_data.is_opened = true;
+    fixture->instance_data.link_session = 0x1234;
+    fixture->instance_config.fec = true;
+
+    /* The peer's hello does not announce parity, so the link is not brought up */
+    receive_hello_with_capabilities(fixture, link_capabilities(&fixture->instance_config) & ~UART_IPC_CAP_FEC, 0xbeef, 0x1234,
+                                    UART_IPC_HELLO_FLAG_UP);
+    zassert_equal(fixture->instance_data.link_peer_session, 0, "Hello accepted");
+    zassert_false(atomic_get(&fixture->instance_data.link_up), "Link up with a peer without parity");
+    zassert_equal(fake_uart_tx_fake.call_count, 0, "Called %d times", fake_uart_tx_fake.call_count);
+}
+
+ZTEST_F(uart_ipc_service_backend_suite, test_bind_request_repeated_until_bound) {
+    fixture->instance_data.is_opened = true;
+    atomic_set(&fixture->instance_data.link_up, 1);
+    fixture->endpoints[0].is_bound = false;
+    uint8_t bind_rsp[sizeof(struct uart_ipc_control_header) + sizeof("test") - 1] = {UART_IPC_CONTROL_BIND_RSP, 3};
+    memcpy(bind_rsp + sizeof(struct uart_ipc_control_header), "test", strlen("test"));
+
+    /* Neither the first request nor the repeated one reach the peer */
+    link_announce(&fixture->instance);
+    for (size_t i = 1; i <= 2; ++i) {
+        zassert_equal(fake_uart_tx_fake.call_count, i, "Called %d times", fake_uart_tx_fake.call_count);
+        const struct uart_ipc_frame *frame = (const struct uart_ipc_frame *)fake_uart_tx_fake.arg1_val;
+        zassert_equal(frame->addr, UART_IPC_ADDR_CONTROL, "Endpoint not announced");
+        zassert_equal(((const struct uart_ipc_control_header *)frame->frag)->type, UART_IPC_CONTROL_BIND_REQ, "Wrong control message");
+        send_tx_done(fixture);
+        k_sleep(K_MSEC(CONFIG_IPC_BACKEND_UART_HELLO_INTERVAL_MS));
+    }
+
+    /* Once the peer has answered, the endpoint is no longer announced */
+    receive_from_peer(fixture, UART_IPC_ADDR_CONTROL, bind_rsp, sizeof(bind_rsp));
+    zassert_true(fixture->endpoints[0].is_bound, "Endpoint not bound");
+    size_t tx_count = fake_uart_tx_fake.call_count;
+    send_tx_done(fixture);
+    k_sleep(K_MSEC(2 * CONFIG_IPC_BACKEND_UART_HELLO_INTERVAL_MS));
+    zassert_equal(fake_uart_tx_fake.call_count, tx_count, "Announced a bound endpoint");
+}
+
+/* Baud rate of the faked UART */
+static uint32_t fake_uart_baudrate;
+
+static int uart_configure_track_baudrate(const struct device *dev, const struct uart_config *cfg) {
+    fake_uart_baudrate = cfg->baudrate;
+    return 0;
+}
+
+static int uart_config_get_track_baudrate(const struct device *dev, struct uart_config *cfg) {
+    *cfg = (struct uart_config){.baudrate = fake_uart_baudrate};
+    return 0;
+}
+
+/* Passes a baud rate negotiation message from the peer through the RX path, with the test pattern for RATE_TEST */
+static void receive_rate_from_peer(struct uart_ipc_service_backend_suite_fixture *fixture, uint8_t type, uint32_t baudrate, bool accepted) {
+    uint8_t msg[sizeof(struct uart_ipc_link_header) + sizeof(struct uart_ipc_rate) + sizeof(rate_test_pattern)] = {type};
+    const struct uart_ipc_rate rate = {.baudrate = sys_cpu_to_le32(baudrate), .accepted = accepted};
+    size_t len = sizeof(struct uart_ipc_link_header) + sizeof(rate);
+
+    memcpy(msg + sizeof(struct uart_ipc_link_header), &rate, sizeof(rate));
+    if (type == UART_IPC_LINK_RATE_TEST) {
+        memcpy(msg + len, rate_test_pattern, sizeof(rate_test_pattern));
+        len += sizeof(rate_test_pattern);
+    }
+    receive_from_peer(fixture, UART_IPC_ADDR_LINK, msg, len);
+}
+
+/* Checks that the last frame passed to uart_tx is a baud rate negotiation message, and completes its transfer */
+static void expect_rate_sent(struct uart_ipc_service_backend_suite_fixture *fixture, uint8_t type, uint32_t baudrate) {
+    const struct uart_ipc_frame *frame = (const struct uart_ipc_frame *)fake_uart_tx_fake.arg1_val;
+    struct uart_ipc_rate rate;
+
+    zassert_equal(frame->addr, UART_IPC_ADDR_LINK, "Not a link message");
+    zassert_equal(frame->frag[0], type, "Sent link message %d instead of %d", frame->frag[0], type);
+    memcpy(&rate, frame->frag + sizeof(struct uart_ipc_link_header), sizeof(rate));
+    zassert_equal(sys_le32_to_cpu(rate.baudrate), baudrate, "Message about %u baud", sys_le32_to_cpu(rate.baudrate));
+    send_tx_done(fixture);
+}
+
+ZTEST_F(uart_ipc_service_backend_suite, test_baud_rate_steps_up_and_falls_back) {
+    static const uint32_t rates[] = {1000000, 460800};
+    struct rate_state *rate = &fixture->instance_data.rate;
+    fake_uart_configure_fake.custom_fake = uart_configure_track_baudrate;
+    fake_uart_config_get_fake.custom_fake = uart_config_get_track_baudrate;
+    fake_uart_baudrate = 115200;
+    fixture->instance_config.baud_rates = rates;
+    fixture->instance_config.baud_rate_count = ARRAY_SIZE(rates);
+    fixture->instance_data.is_opened = true;
+    fixture->instance_data.link_session = 0x2000;
+    fixture->endpoints[0].is_bound = false;
+    rate_open(&fixture->instance);
+
+    /* The link comes up. This side has the larger session, so it leads and asks for the slowest rate first */
+    receive_hello_from_peer(fixture, 0x1000, 0x2000, UART_IPC_HELLO_FLAG_UP | UART_IPC_HELLO_FLAG_RATES);
+    zassert_false(link_ready(&fixture->instance), "Endpoints announced before the rate is settled");
+    expect_rate_sent(fixture, UART_IPC_LINK_RATE_REQ, 460800);
+
+    /* The peer accepts, both sides switch and the test pattern makes it through */
+    receive_rate_from_peer(fixture, UART_IPC_LINK_RATE_ACK, 460800, true);
+    rate_handler(&rate->work.work);
+    zassert_equal(fake_uart_baudrate, 460800, "UART at %u baud", fake_uart_baudrate);
+    expect_rate_sent(fixture, UART_IPC_LINK_RATE_TEST, 460800);
+    receive_rate_from_peer(fixture, UART_IPC_LINK_RATE_TEST, 460800, false);
+    zassert_equal(rate->rate, 460800, "Tested rate not kept");
+    expect_rate_sent(fixture, UART_IPC_LINK_RATE_REQ, 1000000);
+
+    /* The test pattern is lost at 1 Mbaud, so the rate settles at 460800 baud and endpoints are announced */
+    receive_rate_from_peer(fixture, UART_IPC_LINK_RATE_ACK, 1000000, true);
+    rate_handler(&rate->work.work);
+    expect_rate_sent(fixture, UART_IPC_LINK_RATE_TEST, 1000000);
+    rate_handler(&rate->work.work);
+    zassert_equal(fake_uart_baudrate, 460800, "UART at %u baud", fake_uart_baudrate);
+    expect_rate_sent(fixture, UART_IPC_LINK_RATE_DONE, 460800);
+    zassert_true(link_ready(&fixture->instance), "Rate not settled");
+    zassert_equal(((const struct uart_ipc_frame *)fake_uart_tx_fake.arg1_val)->addr, UART_IPC_ADDR_CONTROL, "Endpoint not announced");
+    send_tx_done(fixture);
+
+    /* Errors pile up at 460800 baud, both sides go back to the default rate and bring the link up again */
+    for (size_t i = 0; i < CONFIG_IPC_BACKEND_UART_RATE_MAX_ERRORS; ++i) {
+        rate_rx_error(&fixture->instance);
+    }
+    zassert_equal(rate->step, RATE_FALLBACK, "No fallback after %d errors", CONFIG_IPC_BACKEND_UART_RATE_MAX_ERRORS);
+    rate_handler(&rate->work.work);
+    zassert_equal(fake_uart_baudrate, 115200, "UART at %u baud", fake_uart_baudrate);
+    zassert_false(atomic_get(&fixture->instance_data.link_up), "Link still up");
+    zassert_equal(atomic_get(&fixture->instance_data.stats.counters[STATS_baud_fallbacks]), 1, "Fallback not counted");
+
+    /* Only rates below the one that failed are tried again, so the link stays at the default rate */
+    receive_hello_from_peer(fixture, 0x1000, 0x2000, UART_IPC_HELLO_FLAG_UP | UART_IPC_HELLO_FLAG_RATES);
+    expect_rate_sent(fixture, UART_IPC_LINK_RATE_DONE, 115200);
+    zassert_true(link_ready(&fixture->instance), "Rate not settled");
+    zassert_equal(fake_endpoint_cb_error_fake.call_count, 0, "Called %d times", fake_endpoint_cb_error_fake.call_count);
+}
+
+ZTEST_F(uart_ipc_service_backend_suite, test_urgent_message_overtakes_at_frame_boundary) {
+    fixture->instance_data.is_opened = true;
+    struct backend_endpoint *bulk = &fixture->endpoints[0];
+    bulk->tx_prio = 1;
+
+    struct backend_endpoint *urgent = &fixture->endpoints[1];
+    endpoint_init(urgent, &fixture->instance, 1);
+    urgent->is_registered = true;
+    urgent->tx_prio = 0;
+
+    uint8_t data[3 * FRAME_FRAG_SIZE];
+    sys_rand_get(data, sizeof(data));
+
+    zassert_equal(send(&fixture->instance, bulk, data, sizeof(data)), 0, "Failed to send bulk message");
+    zassert_equal(fake_uart_tx_fake.arg2_val, sizeof(struct uart_ipc_frame), "More than one frame sent at a time");
+    zassert_equal(send(&fixture->instance, urgent, data, 4), 0, "Failed to send urgent message");
+
+    /* Expected sender and fragment of every frame on the line */
+    const struct {
+        uint8_t addr;
+        uint16_t frag_start;
+    } expected[] = {{0, 0}, {1, 0}, {0, FRAME_FRAG_SIZE}, {0, 2 * FRAME_FRAG_SIZE}};
+
+    for (size_t i = 0; i < ARRAY_SIZE(expected); ++i) {
+        const struct uart_ipc_frame *frame = (const struct uart_ipc_frame *)fake_uart_tx_fake.arg1_val;
+        zassert_equal(fake_uart_tx_fake.call_count, i + 1, "Called %d times", fake_uart_tx_fake.call_count);
+        zassert_equal(frame->addr, expected[i].addr, "Frame %d sent by wrong endpoint", i);
+        zassert_equal(sys_le16_to_cpu(frame->frag_start), expected[i].frag_start, "Frame %d has wrong fragment", i);
+        zassert_ok(check_frame(frame), "Frame %d is corrupted", i);
+        send_tx_done(fixture);
+    }
+
+    zassert_equal(fake_uart_tx_fake.call_count, ARRAY_SIZE(expected), "Called %d times", fake_uart_tx_fake.call_count);
+    zassert_equal(k_mem_slab_num_used_get(&test_tx_slab), 0, "TX buffers were not returned to the pool");
+}
+
+ZTEST_F(uart_ipc_service_backend_suite, test_tx_abort_drops_prepared_frame_of_same_message) {
+    fixture->instance_data.is_opened = true;
+    void *token = &fixture->endpoints[0];
+    uint8_t data[3 * FRAME_FRAG_SIZE];
+    sys_rand_get(data, sizeof(data));
+
+    zassert_equal(send(&fixture->instance, token, data, sizeof(data)), 0, "Failed to send long message");
+    zassert_equal(send(&fixture->instance, token, data, 4), 0, "Failed to send short message");
+
+    /* The third frame is encoded while the second one is on the line */
+    send_tx_done(fixture);
+    zassert_equal(fake_uart_tx_fake.call_count, 2, "Called %d times", fake_uart_tx_fake.call_count);
+    const struct tx_frame_buf *prepared = &fixture->instance_data.tx_frames[fixture->instance_data.tx_line ^ 1];
+    zassert_equal(prepared->len, sizeof(struct uart_ipc_frame), "Next frame was not prepared");
+
+    /* Aborting the second frame drops the prepared third one, and the short message goes out next */
+    fixture->uart_event = (struct uart_event){.type = UART_TX_ABORTED};
+    uart_callback(NULL, &fixture->uart_event, &fixture->instance);
+    zassert_equal(fake_endpoint_cb_error_fake.call_count, 1, "Called %d times", fake_endpoint_cb_error_fake.call_count);
+    zassert_equal(fake_uart_tx_fake.call_count, 3, "Called %d times", fake_uart_tx_fake.call_count);
+
+    const struct uart_ipc_frame *frame = (const struct uart_ipc_frame *)fake_uart_tx_fake.arg1_val;
+    zassert_equal(sys_le16_to_cpu(frame->total_data_length), 4, "Rest of the aborted message was sent");
+    send_tx_done(fixture);
+
+    zassert_equal(fake_uart_tx_fake.call_count, 3, "Called %d times", fake_uart_tx_fake.call_count);
+    zassert_equal(k_mem_slab_num_used_get(&test_tx_slab), 0, "TX buffers were not returned to the pool");
+    zassert_equal(atomic_get(&fixture->instance_data.tx_busy), 0, "Transmitter still busy");
+}
+
+/* Frames passed to uart_tx, kept since the driver reuses its frame buffer */
+static uint8_t captured_frames[8][TX_FRAME_MAX_LEN];
+static size_t captured_frame_lens[8];
+
+static int capture_uart_tx(const struct device *dev, const uint8_t *buf, size_t len, int32_t timeout) {
+    size_t index = fake_uart_tx_fake.call_count - 1;
+    if (index < ARRAY_SIZE(captured_frames)) {
+        memcpy(captured_frames[index], buf, len);
+        captured_frame_lens[index] = len;
+    }
+    return 0;
+}
+
+/* Decodes the reliable mode header of a captured frame */
+static struct uart_ipc_arq_header captured_arq_header(size_t index, uint8_t *flags) {
+    uint8_t decoded[TX_FRAME_MAX_LEN];
+    struct uart_ipc_arq_header arq;
+
+    cobs_decode(decoded, captured_frames[index], captured_frame_lens[index] - 1);
+    *flags = ((struct uart_ipc_cobs_header *)decoded)->flags;
+    memcpy(&arq, decoded + sizeof(struct uart_ipc_cobs_header), sizeof(arq));
+    return arq;
+}
+
+/* Feeds a captured frame back to the instance, which talks to itself */
+static void loop_back_frame(struct uart_ipc_service_backend_suite_fixture *fixture, size_t index) {
+    receive_bytes(&fixture->instance, captured_frames[index], captured_frame_lens[index]);
+}
+
+/* Instance whose transfers complete_uart_tx completes */
+static const struct device *sync_tx_instance;
+
+/* Captures a frame and completes its transfer before uart_tx returns, as a sender blocked in send() cannot */
+static int complete_uart_tx(const struct device *dev, const uint8_t *buf, size_t len, int32_t timeout) {
+    struct uart_event event = {.type = UART_TX_DONE, .data.tx.buf = buf, .data.tx.len = len};
+
+    capture_uart_tx(dev, buf, len, timeout);
+    uart_callback(NULL, &event, (void *)sync_tx_instance);
+    return 0;
+}
+
+ZTEST_F(uart_ipc_service_backend_suite, test_peer_restart_drops_partial_transfers) {
+    fixture->instance_data.is_opened = true;
+    fixture->instance_data.link_session = 0x1234;
+    fixture->instance_data.link_peer_session = 0xbeef;
+    atomic_set(&fixture->instance_data.link_up, 1);
+    fake_uart_tx_fake.custom_fake = capture_uart_tx;
+
+    /* The peer sent the first frame of a message to endpoint 0 */
+    uint8_t data[3 * FRAME_FRAG_SIZE];
+    sys_rand_get(data, sizeof(data));
+    uint8_t wire[3 * sizeof(struct uart_ipc_frame)];
+    pack_message(&fixture->instance_config, wire, 0, data, sizeof(data));
+    fixture->uart_event = (struct uart_event){
+        .type = UART_RX_RDY,
+        .data.rx.buf = wire,
+        .data.rx.len = sizeof(struct uart_ipc_frame),
+    };
+    send_uart_event(fixture);
+    zassert_not_null(fixture->endpoints[0].rx_buffer, "Transfer not started");
+
+    /* And the first frame of a message to the peer is on the line */
+    zassert_equal(send(&fixture->instance, &fixture->endpoints[0], data, sizeof(data)), 0, "Failed to send");
+    zassert_equal(fake_uart_tx_fake.call_count, 1, "Called %d times", fake_uart_tx_fake.call_count);
+
+    /* The peer restarts: neither message is continued */
+    receive_hello_from_peer(fixture, 0xcafe, 0, 0);
+    zassert_is_null(fixture->endpoints[0].rx_buffer, "Partial transfer from the peer kept");
+    for (size_t i = 0; i < ARRAY_SIZE(captured_frames) && atomic_get(&fixture->instance_data.tx_busy); ++i) {
+        send_tx_done(fixture);
+    }
+    zassert_equal(atomic_get(&fixture->instance_data.tx_busy), 0, "Transmitter still busy");
+    for (size_t i = 1; i < fake_uart_tx_fake.call_count; ++i) {
+        const struct uart_ipc_frame *frame = (const struct uart_ipc_frame *)captured_frames[i];
+        zassert_true(frame->addr != 0 || sys_le16_to_cpu(frame->frag_start) < 2 * FRAME_FRAG_SIZE,
+                     "Rest of the message sent after the peer restarted");
+    }
+    zassert_is_null(fixture->instance_data.tx_active[0].data, "Partially sent message kept");
+    zassert_equal(k_mem_slab_num_used_get(&test_tx_slab), 0, "TX buffers were not returned to the pool");
+}
+
+ZTEST_F(uart_ipc_service_backend_suite, test_large_message_framed_from_caller_buffer) {
+    fixture->instance_data.is_opened = true;
+    fake_uart_tx_fake.custom_fake = complete_uart_tx;
+    sync_tx_instance = &fixture->instance;
+
+    static uint8_t data[CONFIG_IPC_BACKEND_UART_TX_BUF_FRAMES * FRAME_FRAG_SIZE + 10];
+    sys_rand_get(data, sizeof(data));
+    struct sized_buffer expected_result = {
+        .size = sizeof(data),
+        .data = data,
+    };
+    fixture->endpoints[0].cfg.cb.received = endpoint_receive_callback_validate_data;
+    fixture->endpoints[0].cfg.priv = &expected_result;
+
+    /* send() returns once every frame has been encoded, without copying the message to a TX buffer first */
+    zassert_equal(send(&fixture->instance, &fixture->endpoints[0], data, sizeof(data)), 0, "Failed to send");
+    zassert_equal(fake_uart_tx_fake.call_count, frame_count(sizeof(data)), "Called %d times", fake_uart_tx_fake.call_count);
+    zassert_equal(k_mem_slab_num_used_get(&test_tx_slab), 0, "Message was copied to a TX buffer");
+
+    for (size_t i = 0; i < frame_count(sizeof(data)); ++i) {
+        loop_back_frame(fixture, i);
+    }
+    zassert_equal(fake_endpoint_cb_received_fake.call_count, 1, "Called %d times", fake_endpoint_cb_received_fake.call_count);
+    zassert_equal(fake_endpoint_cb_error_fake.call_count, 0, "Called %d times", fake_endpoint_cb_error_fake.call_count);
+}
+
+/* Completes the first transfer like complete_uart_tx and fails the ones after it */
+static int fail_second_uart_tx(const struct device *dev, const uint8_t *buf, size_t len, int32_t timeout) {
+    if (fake_uart_tx_fake.call_count > 1) {
+        return -EIO;
+    }
+    return complete_uart_tx(dev, buf, len, timeout);
+}
+
+ZTEST_F(uart_ipc_service_backend_suite, test_large_message_dropped_or_timed_out) {
+    fixture->instance_data.is_opened = true;
+    fake_uart_tx_fake.custom_fake = fail_second_uart_tx;
+    sync_tx_instance = &fixture->instance;
+
+    static uint8_t data[CONFIG_IPC_BACKEND_UART_TX_BUF_FRAMES * FRAME_FRAG_SIZE + 10];
+    sys_rand_get(data, sizeof(data));
+
+    /* The sender learns that the rest of its message was dropped */
+    zassert_equal(send(&fixture->instance, &fixture->endpoints[0], data, sizeof(data)), -ECONNRESET, "Dropped message reported as sent");
+    zassert_equal(fake_uart_tx_fake.call_count, 2, "Called %d times", fake_uart_tx_fake.call_count);
+    zassert_is_null(fixture->instance_data.tx_active[0].data, "Dropped message kept");
+
+    /* Without credit nothing is framed, and the message is withdrawn once the TX timeout expires */
+    fixture->instance_config.flow_control = true;
+    fixture->instance_config.rx_credits = 2;
+    credit_init(&fixture->instance);
+    fixture->instance_data.tx_credit_limit = 0;
+    zassert_equal(send(&fixture->instance, &fixture->endpoints[0], data, sizeof(data)), -EAGAIN, "Timed out message reported as sent");
+    zassert_equal(fake_uart_tx_fake.call_count, 2, "Called %d times", fake_uart_tx_fake.call_count);
+    zassert_equal(k_msgq_num_used_get(&fixture->instance_data.tx_queues[0]), 0, "Message left in the TX queue");
+    zassert_is_null(fixture->instance_data.tx_active[0].data, "Message left in the TX queue");
+}
+
+ZTEST_F(uart_ipc_service_backend_suite, test_reliable_mode_retransmits_only_lost_frame) {
+    fixture->instance_data.is_opened = true;
+    fixture->instance_config.framing = UART_IPC_FRAMING_COBS;
+    fixture->instance_config.arq = &fixture->arq;
+    arq_init(&fixture->instance);
+    fake_uart_tx_fake.custom_fake = capture_uart_tx;
+
+    uint8_t data[2 * FRAME_FRAG_SIZE + 10];
+    sys_rand_get(data, sizeof(data));
+    struct sized_buffer expected_result = {
+        .size = sizeof(data),
+        .data = data,
+    };
+    fixture->endpoints[0].cfg.cb.received = endpoint_receive_callback_validate_data;
+    fixture->endpoints[0].cfg.priv = &expected_result;
+
+    zassert_equal(send(&fixture->instance, &fixture->endpoints[0], data, sizeof(data)), 0, "Failed to send");
+    for (int i = 0; i < 3; ++i) {
+        send_tx_done(fixture);
+    }
+    zassert_equal(fake_uart_tx_fake.call_count, 3, "Called %d times", fake_uart_tx_fake.call_count);
+
+    /* The second frame is lost. The third one is kept until the second one arrives */
+    loop_back_frame(fixture, 0);
+    loop_back_frame(fixture, 2);
+    zassert_equal(fake_endpoint_cb_received_fake.call_count, 0, "Delivered with a missing fragment");
+
+    /* Nothing else is sent, so a bare acknowledgement follows after the acknowledgement delay */
+    k_sleep(K_MSEC(CONFIG_IPC_BACKEND_UART_ARQ_ACK_DELAY_MS));
+    zassert_equal(fake_uart_tx_fake.call_count, 4, "Called %d times", fake_uart_tx_fake.call_count);
+    uint8_t flags;
+    struct uart_ipc_arq_header arq = captured_arq_header(3, &flags);
+    zassert_true(flags & COBS_FLAG_NO_DATA, "Not a bare acknowledgement");
+    zassert_equal(arq.ack, 1, "Wrong cumulative acknowledgement %d", arq.ack);
+    zassert_equal(sys_le32_to_cpu(arq.sack), BIT(0), "Wrong selective acknowledgement");
+    send_tx_done(fixture);
+
+    /* Only the frame reported missing is retransmitted */
+    loop_back_frame(fixture, 3);
+    zassert_equal(fake_uart_tx_fake.call_count, 5, "Called %d times", fake_uart_tx_fake.call_count);
+    arq = captured_arq_header(4, &flags);
+    zassert_false(flags & COBS_FLAG_NO_DATA, "Retransmission carries no data");
+    zassert_equal(arq.seq, 1, "Wrong frame retransmitted %d", arq.seq);
+    send_tx_done(fixture);
+
+    loop_back_frame(fixture, 4);
+    zassert_equal(fake_endpoint_cb_received_fake.call_count, 1, "Called %d times", fake_endpoint_cb_received_fake.call_count);
+
+    /* Once everything is acknowledged nothing is retransmitted */
+    k_sleep(K_MSEC(CONFIG_IPC_BACKEND_UART_ARQ_ACK_DELAY_MS));
+    zassert_equal(fake_uart_tx_fake.call_count, 6, "Called %d times", fake_uart_tx_fake.call_count);
+    send_tx_done(fixture);
+    loop_back_frame(fixture, 5);
+    zassert_equal(fixture->arq.tx_base, fixture->arq.tx_next, "Frames left unacknowledged");
+
+    k_sleep(K_MSEC(2 * CONFIG_IPC_BACKEND_UART_ARQ_RTO_MS));
+    zassert_equal(fake_uart_tx_fake.call_count, 6, "Called %d times", fake_uart_tx_fake.call_count);
+    zassert_equal(fake_endpoint_cb_error_fake.call_count, 0, "Called %d times", fake_endpoint_cb_error_fake.call_count);
+    zassert_equal(k_mem_slab_num_used_get(&test_tx_slab), 0, "TX buffer was not returned to the pool");
+}
+
+/* Decodes the header of a captured COBS frame, and returns the decoded frame in decoded */
+static struct uart_ipc_cobs_header captured_cobs_header(size_t index, uint8_t *decoded) {
+    struct uart_ipc_cobs_header header;
+
+    cobs_decode(decoded, captured_frames[index], captured_frame_lens[index] - 1);
+    memcpy(&header, decoded, sizeof(header));
+    return header;
+}
+
+/* Passes a COBS frame from the peer whose crc does not match through the RX path */
+static void receive_corrupted_from_peer(struct uart_ipc_service_backend_suite_fixture *fixture) {
+    uint8_t data[8];
+    sys_rand_get(data, sizeof(data));
+
+    uint8_t wire[sizeof(struct uart_ipc_frame)];
+    size_t wire_len = pack_message(&fixture->instance_config, wire, 0, data, sizeof(data));
+    wire[wire_len - 2] = wire[wire_len - 2] == 1 ? 2 : 1;  // Last crc byte, the delimiter stays in place
+    fixture->uart_event = (struct uart_event){
+        .type = UART_RX_RDY,
+        .data.rx.buf = wire,
+        .data.rx.len = wire_len,
+    };
+    send_uart_event(fixture);
+}
+
+ZTEST_F(uart_ipc_service_backend_suite, test_adaptive_fragment_size_follows_error_rate) {
+    struct frag_state *frag = &fixture->instance_data.frag;
+    fixture->instance_data.is_opened = true;
+    fixture->instance_config.framing = UART_IPC_FRAMING_COBS;
+    fixture->instance_config.adaptive_frag = true;
+    atomic_set(&fixture->instance_data.link_up, 1);
+    fake_uart_tx_fake.custom_fake = capture_uart_tx;
+
+    /* A window with enough corrupted frames halves the fragment size asked from the peer */
+    uint8_t data[8];
+    sys_rand_get(data, sizeof(data));
+    for (int i = 0; i < CONFIG_IPC_BACKEND_UART_FRAG_WINDOW - CONFIG_IPC_BACKEND_UART_FRAG_SHRINK_ERRORS; ++i) {
+        receive_from_peer(fixture, 0, data, sizeof(data));
+    }
+    zassert_equal(fake_uart_tx_fake.call_count, 0, "Called %d times", fake_uart_tx_fake.call_count);
+    for (int i = 0; i < CONFIG_IPC_BACKEND_UART_FRAG_SHRINK_ERRORS; ++i) {
+        receive_corrupted_from_peer(fixture);
+    }
+    zassert_equal(frag->rx_size, FRAME_FRAG_SIZE / 2, "Asking for fragments of %d bytes", frag->rx_size);
+    zassert_equal(fake_uart_tx_fake.call_count, 1, "Called %d times", fake_uart_tx_fake.call_count);
+
+    uint8_t decoded[TX_FRAME_MAX_LEN];
+    struct uart_ipc_cobs_header header = captured_cobs_header(0, decoded);
+    zassert_equal(header.addr, UART_IPC_ADDR_LINK, "Not a link message");
+    zassert_equal(decoded[sizeof(header)], UART_IPC_LINK_FRAG_SIZE, "Wrong link message %d", decoded[sizeof(header)]);
+    zassert_equal(decoded[sizeof(header) + sizeof(struct uart_ipc_link_header)], FRAME_FRAG_SIZE / 2, "Wrong fragment size");
+    send_tx_done(fixture);
+
+    /* The peer asks for small fragments in turn, and a message is split accordingly */
+    const uint8_t request[] = {UART_IPC_LINK_FRAG_SIZE, 16};
+    receive_from_peer(fixture, UART_IPC_ADDR_LINK, request, sizeof(request));
+    uint8_t message[40];
+    sys_rand_get(message, sizeof(message));
+    zassert_equal(send(&fixture->instance, &fixture->endpoints[0], message, sizeof(message)), 0, "Failed to send");
+    for (int i = 0; i < 3; ++i) {
+        send_tx_done(fixture);
+    }
+    zassert_equal(fake_uart_tx_fake.call_count, 4, "Called %d times", fake_uart_tx_fake.call_count);
+    header = captured_cobs_header(3, decoded);
+    zassert_equal(sys_le16_to_cpu(header.frag_start), 32, "Last fragment starts at %d", sys_le16_to_cpu(header.frag_start));
+
+    /* A clean window grows the fragment size again, one step at a time */
+    for (int i = 0; i < CONFIG_IPC_BACKEND_UART_FRAG_WINDOW - 1; ++i) {
+        receive_from_peer(fixture, 0, data, sizeof(data));
+    }
+    zassert_equal(frag->rx_size, FRAME_FRAG_SIZE / 2 + UART_IPC_FRAG_GROW_STEP, "Asking for fragments of %d bytes", frag->rx_size);
+    zassert_equal(fake_uart_tx_fake.call_count, 5, "Called %d times", fake_uart_tx_fake.call_count);
+    send_tx_done(fixture);
+    zassert_equal(atomic_get(&fixture->instance_data.stats.counters[STATS_frag_size_changes]), 2, "Changes not counted");
+    zassert_equal(fake_endpoint_cb_received_fake.call_count, 2 * CONFIG_IPC_BACKEND_UART_FRAG_WINDOW - 3, "Called %d times",
+                  fake_endpoint_cb_received_fake.call_count);
+}
+
+ZTEST_F(uart_ipc_service_backend_suite, test_small_messages_coalesced_into_one_frame) {
+    fixture->instance_data.is_opened = true;
+    fixture->instance_config.framing = UART_IPC_FRAMING_COBS;
+    fixture->instance_config.coalesce_window_usec = 500;
+    fixture->instance_config.coalesce_threshold = FRAME_FRAG_SIZE;
+    fake_uart_tx_fake.custom_fake = capture_uart_tx;
+
+    uint8_t data[3][10];
+    sys_rand_get(data, sizeof(data));
+    for (int i = 0; i < ARRAY_SIZE(data); ++i) {
+        zassert_equal(send(&fixture->instance, &fixture->endpoints[0], data[i], sizeof(data[i])), 0, "Failed to send");
+    }
+    zassert_equal(fake_uart_tx_fake.call_count, 0, "Sent before the coalescing window passed");
+
+    k_sleep(K_USEC(500));
+    zassert_equal(fake_uart_tx_fake.call_count, 1, "Called %d times", fake_uart_tx_fake.call_count);
+    send_tx_done(fixture);
+    zassert_equal(k_mem_slab_num_used_get(&test_tx_slab), 0, "TX buffer was not returned to the pool");
+
+    /* The receiver splits the batch back into the original messages */
+    loop_back_frame(fixture, 0);
+    zassert_equal(fake_endpoint_cb_received_fake.call_count, ARRAY_SIZE(data), "Called %d times", fake_endpoint_cb_received_fake.call_count);
+    for (int i = 0; i < ARRAY_SIZE(data); ++i) {
+        zassert_equal(fake_endpoint_cb_received_fake.arg1_history[i], sizeof(data[i]), "Wrong length of message %d", i);
+    }
+    zassert_equal(fake_endpoint_cb_error_fake.call_count, 0, "Called %d times", fake_endpoint_cb_error_fake.call_count);
+}
+
+ZTEST_F(uart_ipc_service_backend_suite, test_batches_of_two_levels_interleaved) {
+    fixture->instance_data.is_opened = true;
+    fixture->instance_config.framing = UART_IPC_FRAMING_COBS;
+    fixture->instance_config.coalesce_window_usec = 500;
+    fixture->instance_config.coalesce_threshold = 2 * FRAME_FRAG_SIZE;
+    fake_uart_tx_fake.custom_fake = capture_uart_tx;
+
+    struct backend_endpoint *bulk = &fixture->endpoints[0];
+    bulk->tx_prio = 1;
+    bulk->cfg.priv = bulk;
+
+    struct backend_endpoint *urgent = &fixture->endpoints[1];
+    endpoint_init(urgent, &fixture->instance, 1);
+    urgent->cfg.cb.received = fake_endpoint_cb_received;
+    urgent->cfg.priv = urgent;
+    urgent->remote_addr = 1;
+    urgent->is_registered = true;
+    urgent->is_bound = true;
+    urgent->tx_prio = 0;
+
+    /* Two messages fill a batch of two frames. The urgent batch overtakes the bulk one after its first frame */
+    uint8_t data[FRAME_FRAG_SIZE];
+    sys_rand_get(data, sizeof(data));
+    for (int i = 0; i < 2; ++i) {
+        zassert_equal(send(&fixture->instance, bulk, data, FRAME_FRAG_SIZE - 2), 0, "Failed to send bulk message");
+    }
+    zassert_equal(fake_uart_tx_fake.call_count, 1, "Full bulk batch was not sent");
+    for (int i = 0; i < 2; ++i) {
+        zassert_equal(send(&fixture->instance, urgent, data, FRAME_FRAG_SIZE - 3), 0, "Failed to send urgent message");
+    }
+    for (int i = 0; i < 4; ++i) {
+        send_tx_done(fixture);
+    }
+    zassert_equal(fake_uart_tx_fake.call_count, 4, "Called %d times", fake_uart_tx_fake.call_count);
+    zassert_equal(k_mem_slab_num_used_get(&test_tx_slab), 0, "TX buffers were not returned to the pool");
+
+    /* Each level is reassembled apart, the urgent batch completes first */
+    for (int i = 0; i < 4; ++i) {
+        loop_back_frame(fixture, i);
+    }
+    const struct {
+        struct backend_endpoint *endpoint;
+        size_t len;
+    } expected[] = {{urgent, FRAME_FRAG_SIZE - 3}, {urgent, FRAME_FRAG_SIZE - 3}, {bulk, FRAME_FRAG_SIZE - 2}, {bulk, FRAME_FRAG_SIZE - 2}};
+
+    zassert_equal(fake_endpoint_cb_received_fake.call_count, ARRAY_SIZE(expected), "Called %d times", fake_endpoint_cb_received_fake.call_count);
+    for (int i = 0; i < ARRAY_SIZE(expected); ++i) {
+        zassert_equal(fake_endpoint_cb_received_fake.arg2_history[i], expected[i].endpoint, "Message %d delivered to the wrong endpoint", i);
+        zassert_equal(fake_endpoint_cb_received_fake.arg1_history[i], expected[i].len, "Wrong length of message %d", i);
+    }
+    zassert_equal(fake_endpoint_cb_error_fake.call_count, 0, "Called %d times", fake_endpoint_cb_error_fake.call_count);
+}
+
+ZTEST_F(uart_ipc_service_backend_suite, test_lz_roundtrip) {
+    /* Shaped like the application events: a short string in a zero padded buffer, followed by a counter */
+    uint8_t data[140] = "A ping event message";
+    data[sizeof(data) - 1] = 42;
+
+    uint8_t compressed[sizeof(data)];
+    int compressed_len = uart_ipc_lz_compress(compressed, sizeof(compressed), data, sizeof(data));
+    zassert_true(compressed_len > 0 && compressed_len < sizeof(data) / 4, "Compressed to %d bytes", compressed_len);
+
+    uint8_t decompressed[sizeof(data)];
+    int decompressed_len = uart_ipc_lz_decompress(decompressed, sizeof(decompressed), compressed, compressed_len);
+    zassert_equal(decompressed_len, sizeof(data), "Wrong decompressed length %d", decompressed_len);
+    zassert_mem_equal(decompressed, data, sizeof(data), "Decompressed data differs");
+
+    /* Random data does not get smaller, and truncated blocks are rejected */
+    sys_rand_get(data, sizeof(data));
+    zassert_equal(uart_ipc_lz_compress(compressed, sizeof(data), data, sizeof(data)), -ENOSPC, "Random data was compressed");
+    zassert_equal(uart_ipc_lz_decompress(decompressed, sizeof(decompressed), compressed, 3), -EINVAL, "Truncated block accepted");
+}
+
+ZTEST_F(uart_ipc_service_backend_suite, test_compressed_message_roundtrip) {
+    fixture->instance_data.is_opened = true;
+    fixture->instance_config.framing = UART_IPC_FRAMING_COBS;
+    fixture->instance_config.compression = true;
+    fake_uart_tx_fake.custom_fake = capture_uart_tx;
+
+    uint8_t data[2 * FRAME_FRAG_SIZE + 3] = "A ping event message";
+    struct sized_buffer expected_result = {
+        .size = sizeof(data),
+        .data = data,
+    };
+    fixture->endpoints[0].cfg.cb.received = endpoint_receive_callback_validate_data;
+    fixture->endpoints[0].cfg.priv = &expected_result;
+
+    /* Three fragments uncompressed, one compressed */
+    zassert_equal(send(&fixture->instance, &fixture->endpoints[0], data, sizeof(data)), 0, "Failed to send");
+    send_tx_done(fixture);
+    zassert_equal(fake_uart_tx_fake.call_count, 1, "Called %d times", fake_uart_tx_fake.call_count);
+
+    loop_back_frame(fixture, 0);
+    zassert_equal(fake_endpoint_cb_received_fake.call_count, 1, "Called %d times", fake_endpoint_cb_received_fake.call_count);
+    zassert_equal(fake_endpoint_cb_error_fake.call_count, 0, "Called %d times", fake_endpoint_cb_error_fake.call_count);
+
+    /* Incompressible messages are sent as they are */
+    sys_rand_get(data, sizeof(data));
+    zassert_equal(send(&fixture->instance, &fixture->endpoints[0], data, sizeof(data)), 0, "Failed to send");
+    for (int i = 0; i < frame_count(sizeof(data)); ++i) {
+        send_tx_done(fixture);
+    }
+    zassert_equal(fake_uart_tx_fake.call_count, 1 + frame_count(sizeof(data)), "Called %d times", fake_uart_tx_fake.call_count);
+    for (int i = 1; i <= frame_count(sizeof(data)); ++i) {
+        loop_back_frame(fixture, i);
+    }
+    zassert_equal(fake_endpoint_cb_received_fake.call_count, 2, "Called %d times", fake_endpoint_cb_received_fake.call_count);
+}
+
+/* Feeds a single frame from the peer carrying the given flow control state. Frames without data if len is 0 */
+static void receive_with_credit(struct uart_ipc_service_backend_suite_fixture *fixture, const void *data, uint8_t len, uint8_t count, uint8_t limit) {
+    const struct frame_info info = {
+        .flags = COBS_FLAG_CREDIT | (len == 0 ? COBS_FLAG_NO_DATA : 0),
+        .addr = len == 0 ? UART_IPC_ADDR_CONTROL : 0,
+        .total_data_length = len,
+        .frag = data,
+        .frag_len = len,
+        .credit = {.count = count, .limit = limit},
+    };
+    uint8_t frame[TX_FRAME_MAX_LEN] __aligned(4);
+    receive_bytes(&fixture->instance, frame, encode_frame(&fixture->instance_config, frame, &info));
+}
+
+ZTEST_F(uart_ipc_service_backend_suite, test_flow_control_waits_for_credit) {
+    fixture->instance_data.is_opened = true;
+    fixture->instance_config.flow_control = true;
+    fixture->instance_config.rx_credits = 2;
+    credit_init(&fixture->instance);
+    fake_uart_tx_fake.custom_fake = capture_uart_tx;
+
+    uint8_t data[8];
+    sys_rand_get(data, sizeof(data));
+    for (int i = 0; i < 3; ++i) {
+        zassert_equal(send(&fixture->instance, &fixture->endpoints[0], data, sizeof(data)), 0, "Failed to send");
+    }
+    send_tx_done(fixture);
+    send_tx_done(fixture);
+
+    /* The peer is assumed to grant as much credit as this side */
+    zassert_equal(fake_uart_tx_fake.call_count, 2, "Called %d times", fake_uart_tx_fake.call_count);
+    for (int i = 0; i < 2; ++i) {
+        const struct uart_ipc_frame *frame = (const struct uart_ipc_frame *)captured_frames[i];
+        zassert_equal(frame->credit_count, i + 1, "Wrong frame count %d", frame->credit_count);
+        zassert_equal(frame->credit_limit, 2, "Wrong advertised limit %d", frame->credit_limit);
+    }
+
+    /* Without credit the peer is probed */
+    k_sleep(K_MSEC(CONFIG_IPC_BACKEND_UART_CREDIT_PROBE_MS));
+    zassert_equal(fake_uart_tx_fake.call_count, 3, "Called %d times", fake_uart_tx_fake.call_count);
+    const struct uart_ipc_frame *probe = (const struct uart_ipc_frame *)captured_frames[2];
+    zassert_ok(check_frame(probe), "Invalid probe");
+    zassert_equal(probe->frag_len, 0, "Probe carries data");
+    zassert_equal(sys_le16_to_cpu(probe->frag_start), UART_IPC_CREDIT_PROBE, "Not marked as probe");
+    zassert_equal(probe->credit_count, 2, "Probe used up credit");
+    send_tx_done(fixture);
+
+    /* A credit update releases the last message */
+    receive_with_credit(fixture, NULL, 0, 0, 3);
+    zassert_equal(fake_uart_tx_fake.call_count, 4, "Called %d times", fake_uart_tx_fake.call_count);
+    zassert_equal(((const struct uart_ipc_frame *)captured_frames[3])->credit_count, 3, "Wrong frame count");
+    send_tx_done(fixture);
+
+    /* Once the peer has used up half of its credit, a new limit is advertised */
+    receive_with_credit(fixture, data, sizeof(data), 1, 3);
+    zassert_equal(fake_endpoint_cb_received_fake.call_count, 1, "Called %d times", fake_endpoint_cb_received_fake.call_count);
+    zassert_equal(fake_uart_tx_fake.call_count, 5, "Called %d times", fake_uart_tx_fake.call_count);
+    const struct uart_ipc_frame *update = (const struct uart_ipc_frame *)captured_frames[4];
+    zassert_equal(update->frag_len, 0, "Update carries data");
+    zassert_equal(sys_le16_to_cpu(update->frag_start), 0, "Update marked as probe");
+    zassert_equal(update->credit_count, 3, "Update used up credit");
+    zassert_equal(update->credit_limit, 3, "Wrong advertised limit %d", update->credit_limit);
+    send_tx_done(fixture);
+
+    /* Updates are not answered */
+    receive_with_credit(fixture, NULL, 0, 1, 3);
+    zassert_equal(fake_uart_tx_fake.call_count, 5, "Called %d times", fake_uart_tx_fake.call_count);
+    zassert_equal(fake_endpoint_cb_error_fake.call_count, 0, "Called %d times", fake_endpoint_cb_error_fake.call_count);
+}
+
+ZTEST_F(uart_ipc_service_backend_suite, test_credit_window_follows_free_buffers) {
+    fixture->instance_data.is_opened = true;
+    fixture->instance_config.flow_control = true;
+    fixture->instance_config.rx_credits = TEST_RX_BUF_COUNT;
+    credit_init(&fixture->instance);
+    fake_uart_tx_fake.custom_fake = capture_uart_tx;
+    uint8_t data[8];
+    sys_rand_get(data, sizeof(data));
+
+    /* With a single free RX buffer, only the frame it takes is granted */
+    void *rx_bufs[TEST_RX_BUF_COUNT - 1];
+    for (size_t i = 0; i < ARRAY_SIZE(rx_bufs); ++i) {
+        zassert_ok(k_mem_slab_alloc(&test_rx_slab, &rx_bufs[i], K_NO_WAIT), "Failed to take RX buffer");
+    }
+    zassert_equal(send(&fixture->instance, &fixture->endpoints[0], data, sizeof(data)), 0, "Failed to send");
+    zassert_equal(((const struct uart_ipc_frame *)captured_frames[0])->credit_limit, 1, "Granted more than the free buffers take");
+    send_tx_done(fixture);
+
+    /* Once the buffers are back, the whole window is granted again */
+    for (size_t i = 0; i < ARRAY_SIZE(rx_bufs); ++i) {
+        k_mem_slab_free(&test_rx_slab, &rx_bufs[i]);
+    }
+    zassert_equal(send(&fixture->instance, &fixture->endpoints[0], data, sizeof(data)), 0, "Failed to send");
+    zassert_equal(((const struct uart_ipc_frame *)captured_frames[1])->credit_limit, TEST_RX_BUF_COUNT, "Window not restored");
+    send_tx_done(fixture);
+
+#ifdef CONFIG_IPC_BACKEND_UART_STATIC_ALLOC
+    /* Without a free reassembly buffer, no message can be started */
+    void *msg_bufs[TEST_MSG_BUF_COUNT];
+    for (size_t i = 0; i < ARRAY_SIZE(msg_bufs); ++i) {
+        zassert_ok(k_mem_slab_alloc(&test_rx_msg_slab, &msg_bufs[i], K_NO_WAIT), "Failed to take message buffer");
+    }
+    zassert_equal(send(&fixture->instance, &fixture->endpoints[0], data, sizeof(data)), 0, "Failed to send");
+    zassert_equal(((const struct uart_ipc_frame *)captured_frames[2])->credit_limit, 1, "Granted credit without a reassembly buffer");
+    send_tx_done(fixture);
+    for (size_t i = 0; i < ARRAY_SIZE(msg_bufs); ++i) {
+        k_mem_slab_free(&test_rx_msg_slab, &msg_bufs[i]);
+    }
+#endif
+}
+
+ZTEST_F(uart_ipc_service_backend_suite, test_rx_disabled_restarts_with_configured_buffers) {
+    fixture->uart_event = (struct uart_event){
+        .type = UART_RX_DISABLED,
+    };
+    uart_callback(NULL, &fixture->uart_event, &fixture->instance);
+
+    zassert_equal(fake_uart_rx_enable_fake.call_count, 1, "Called %d times", fake_uart_rx_enable_fake.call_count);
+    zassert_equal(fake_uart_rx_enable_fake.arg2_val, TEST_RX_BUF_SIZE, "Wrong buffer size %d", fake_uart_rx_enable_fake.arg2_val);
+    zassert_equal(fake_uart_rx_enable_fake.arg3_val, TEST_RX_INACTIVITY_TIMEOUT, "Wrong timeout %d", fake_uart_rx_enable_fake.arg3_val);
+    zassert_equal(k_mem_slab_num_used_get(&test_rx_slab), 1, "%d RX buffers in use", k_mem_slab_num_used_get(&test_rx_slab));
+
+    /* A failed restart hands the buffer back */
+    fake_uart_rx_enable_fake.return_val = -EBUSY;
+    uart_callback(NULL, &fixture->uart_event, &fixture->instance);
+    zassert_equal(k_mem_slab_num_used_get(&test_rx_slab), 1, "RX buffer leaked");
+}
+
+#ifdef CONFIG_IPC_BACKEND_UART_STATS
+static uint32_t histogram_total(const uint32_t *hist) {
+    uint32_t total = 0;
+    for (size_t i = 0; i < UART_IPC_STATS_HIST_BUCKETS; ++i) {
+        total += hist[i];
+    }
+    return total;
+}
+
+ZTEST_F(uart_ipc_service_backend_suite, test_stats_count_link_activity) {
+    fixture->instance.api = &backend_ops;
+    fixture->instance_data.is_opened = true;
+    struct uart_ipc_stats stats;
+
+    /* A two frame message is timed until the TX done event of its last frame */
+    uint8_t data[FRAME_FRAG_SIZE + 1];
+    sys_rand_get(data, sizeof(data));
+    zassert_equal(send(&fixture->instance, &fixture->endpoints[0], data, sizeof(data)), 0, "Send failed");
+    send_tx_done(fixture);
+    zassert_equal(uart_ipc_stats_get(&fixture->instance, &stats), 0, "Could not read statistics");
+    zassert_equal(histogram_total(stats.tx_latency), 0, "Message timed before its last frame was sent");
+    send_tx_done(fixture);
+
+    zassert_equal(uart_ipc_stats_get(&fixture->instance, &stats), 0, "Could not read statistics");
+    zassert_equal(stats.tx_frames, 2, "%d frames sent", stats.tx_frames);
+    zassert_equal(stats.tx_bytes, 2 * sizeof(struct uart_ipc_frame), "%d bytes sent", stats.tx_bytes);
+    zassert_equal(stats.tx_queue_high_water, 1, "High water mark %d", stats.tx_queue_high_water);
+    zassert_equal(histogram_total(stats.tx_latency), 1, "Message not timed");
+
+    /* A corrupted frame followed by the intact message */
+    fixture->endpoints[0].cfg.cb.error = fake_endpoint_cb_error;
+    size_t n_frames = 0;
+    struct uart_ipc_frame *frames = create_frames(data, sizeof(data), &n_frames);
+    register_test_buffer(frames, fixture);
+    struct uart_ipc_frame corrupted = frames[0];
+    corrupted.frag[0] ^= 0x01;
+
+    fixture->uart_event = (struct uart_event){
+        .type = UART_RX_RDY,
+        .data.rx.buf = (uint8_t *)&corrupted,
+        .data.rx.len = sizeof(corrupted),
+    };
+    send_uart_event(fixture);
+    fixture->uart_event.data.rx.buf = (uint8_t *)frames;
+    fixture->uart_event.data.rx.len = n_frames * sizeof(struct uart_ipc_frame);
+    send_uart_event(fixture);
+
+    zassert_equal(fake_endpoint_cb_received_fake.call_count, 1, "Message not received");
+    zassert_equal(uart_ipc_stats_get(&fixture->instance, &stats), 0, "Could not read statistics");
+    zassert_equal(stats.rx_bytes, 3 * sizeof(struct uart_ipc_frame), "%d bytes received", stats.rx_bytes);
+    zassert_equal(stats.rx_frames, 2, "%d frames received", stats.rx_frames);
+    zassert_equal(stats.crc_errors, 1, "%d crc errors", stats.crc_errors);
+    zassert_equal(stats.resyncs, 1, "%d resyncs", stats.resyncs);
+    zassert_equal(histogram_total(stats.rx_reassembly), 1, "Reassembly not timed");
+
+    zassert_equal(uart_ipc_stats_reset(&fixture->instance), 0, "Could not reset statistics");
+    zassert_equal(uart_ipc_stats_get(&fixture->instance, &stats), 0, "Could not read statistics");
+    zassert_equal(stats.tx_frames + stats.rx_frames + histogram_total(stats.tx_latency), 0, "Statistics not reset");
+
+    /* Other devices are rejected */
+    fixture->instance.api = NULL;
+    zassert_equal(uart_ipc_stats_get(&fixture->instance, &stats), -EINVAL, "Read statistics of another device");
+}
+#endif
+
+#ifdef CONFIG_IPC_BACKEND_UART_RX_THREAD
+ZTEST_F(uart_ipc_service_backend_suite, test_rx_thread_frees_buffer_after_processing) {
+    fixture->endpoints[0].cfg.cb.received = endpoint_receive_callback_validate_data;
+
+    uint8_t data[10];
+    sys_rand_get(data, sizeof(data));
+    struct sized_buffer expected_result = {
+        .size = sizeof(data),
+        .data = data,
+    };
+    fixture->endpoints[0].cfg.priv = &expected_result;
+
+    uint8_t *rx_buf = NULL;
+    k_mem_slab_alloc(fixture->instance_data.rx_slab, (void **)&rx_buf, K_NO_WAIT);
+    pack_message(&fixture->instance_config, rx_buf, 0, data, sizeof(data));
+
+    /* The UART hands over the data and releases the buffer before the RX thread runs */
+    fixture->uart_event = (struct uart_event){
+        .type = UART_RX_RDY,
+        .data.rx.buf = rx_buf,
+        .data.rx.len = sizeof(struct uart_ipc_frame),
+    };
+    uart_callback(NULL, &fixture->uart_event, &fixture->instance);
+    fixture->uart_event = (struct uart_event){
+        .type = UART_RX_BUF_RELEASED,
+        .data.rx_buf.buf = rx_buf,
+    };
+    uart_callback(NULL, &fixture->uart_event, &fixture->instance);
+
+    zassert_equal(fake_endpoint_cb_received_fake.call_count, 0, "Data delivered from the UART callback");
+    zassert_equal(k_mem_slab_num_used_get(fixture->instance_data.rx_slab), 1, "RX buffer freed before it was processed");
+
+    rx_ring_process(&fixture->instance);
+
+    zassert_equal(fake_endpoint_cb_received_fake.call_count, 1, "Called %d times", fake_endpoint_cb_received_fake.call_count);
+    zassert_equal(k_mem_slab_num_used_get(fixture->instance_data.rx_slab), 0, "RX buffer was not freed");
+}
+#endif
+
+#ifdef CONFIG_IPC_BACKEND_UART_STATIC_ALLOC
+ZTEST_F(uart_ipc_service_backend_suite, test_static_pools_limit_messages) {
+    uint16_t total_data_length = FRAME_FRAG_SIZE + 3;
+    uint8_t data[total_data_length];
+    sys_rand_get(data, total_data_length);
+
+    size_t n_frames = 0;
+    struct uart_ipc_frame *frames = create_frames(data, total_data_length, &n_frames);
+    register_test_buffer(frames, fixture);
+
+    struct sized_buffer expected_result = {
+        .size = total_data_length,
+        .data = data,
+    };
+    fixture->endpoints[0].cfg.cb.received = endpoint_receive_callback_validate_data;
+    fixture->endpoints[0].cfg.priv = &expected_result;
+
+    /* With every reassembly buffer held, a new message is dropped instead of falling back to the heap */
+    void *held[TEST_MSG_BUF_COUNT];
+    for (size_t i = 0; i < TEST_MSG_BUF_COUNT; ++i) {
+        zassert_ok(k_mem_slab_alloc(&test_rx_msg_slab, &held[i], K_NO_WAIT), "Could not exhaust the pool");
+    }
+    zassert_equal(receive_frame(&fixture->instance, &frames[0], K_FOREVER), -ENOMEM, "Message was not dropped");
+    zassert_is_null(fixture->endpoints[0].rx_buffer, "Reassembly started without a buffer");
+
+    /* Once a buffer is back the next message is reassembled in it and the buffer is returned after delivery */
+    k_mem_slab_free(&test_rx_msg_slab, &held[0]);
+    for (size_t i = 0; i < n_frames; ++i) {
+        zassert_ok(receive_frame(&fixture->instance, &frames[i], K_FOREVER), "Failed to receive frame %d", i);
+    }
+    zassert_equal(fake_endpoint_cb_received_fake.call_count, 1, "Called %d times", fake_endpoint_cb_received_fake.call_count);
+    zassert_equal(k_mem_slab_num_used_get(&test_rx_msg_slab), TEST_MSG_BUF_COUNT - 1, "Reassembly buffer was not returned");
+
+    /* Messages larger than a pool buffer are refused in both directions, which is not an allocation failure */
+    static uint8_t large[TEST_MSG_BUF_SIZE + 1];
+    atomic_val_t heap_failures = atomic_get(&fixture->instance_data.stats.counters[STATS_heap_failures]);
+    size_t n_large_frames = 0;
+    struct uart_ipc_frame *large_frames = create_frames(large, sizeof(large), &n_large_frames);
+    register_test_buffer(large_frames, fixture);
+    zassert_equal(receive_frame(&fixture->instance, &large_frames[0], K_FOREVER), -EMSGSIZE, "Received an oversized message");
+    zassert_equal(atomic_get(&fixture->instance_data.stats.counters[STATS_heap_failures]), heap_failures,
+                  "Oversized message counted as an allocation failure");
+
+    fixture->instance_data.is_opened = true;
+    zassert_equal(send(&fixture->instance, &fixture->endpoints[0], large, sizeof(large)), -EMSGSIZE, "Sent an oversized message");
+    zassert_equal(fake_uart_tx_fake.call_count, 0, "Called %d times", fake_uart_tx_fake.call_count);
+}
+#endif
@@ -0,0 +1,155 @@
+#include <stdint.h>
+#include <string.h>
+#include <zephyr/ztest.h>
+
+#include "../../src/event_wire.h"
+
+/* One field of every kind, each at its own integer width */
+#define WIRE_TEST_FIELDS(FIELD)            \
+    FIELD(EVENT_WIRE_UINT, u8, uint8_t)    \
+    FIELD(EVENT_WIRE_UINT, u64, uint64_t)  \
+    FIELD(EVENT_WIRE_INT, i32, int32_t)    \
+    FIELD(EVENT_WIRE_INT, i64, int64_t)    \
+    FIELD(EVENT_WIRE_STRING, text, 8)
+
+EVENT_WIRE_SCHEMA_DEFINE(wire_test, WIRE_TEST_FIELDS);
+
+/* Largest encoding of struct wire_test_fields: 2 + 10 + 5 + 10 byte varints and a 7 character string */
+#define WIRE_TEST_MAX_LEN 35
+
+ZTEST_SUITE(event_wire_suite, NULL, NULL, NULL, NULL, NULL);
+
+ZTEST(event_wire_suite, test_varint_roundtrip) {
+    static const uint64_t values[] = {0, 1, 0x7F, 0x80, 0x3FFF, 0x4000, UINT32_MAX, (uint64_t)UINT32_MAX + 1, INT64_MAX, UINT64_MAX};
+    uint8_t buf[10];
+
+    for (size_t i = 0; i < ARRAY_SIZE(values); ++i) {
+        uint8_t *end = event_wire_put_varint(buf, values[i]);
+        zassert_equal(end - buf, event_wire_varint_size(values[i]), "Size of %llu does not match", values[i]);
+
+        uint64_t value;
+        zassert_equal_ptr(event_wire_get_varint(buf, end, &value), end, "Failed to decode %llu", values[i]);
+        zassert_equal(value, values[i], "Decoded %llu instead of %llu", value, values[i]);
+    }
+
+    /* Seven bits per byte, least significant group first */
+    zassert_equal(event_wire_put_varint(buf, 0x80) - buf, 2, "Wrong size");
+    zassert_mem_equal(buf, ((uint8_t[]){0x80, 0x01}), 2, "Wrong encoding");
+    zassert_equal(event_wire_varint_size(UINT64_MAX), 10, "Wrong size");
+}
+
+ZTEST(event_wire_suite, test_zigzag_roundtrip) {
+    static const int64_t values[] = {0, -1, 1, INT32_MIN, INT32_MAX, INT64_MIN, INT64_MAX};
+
+    for (size_t i = 0; i < ARRAY_SIZE(values); ++i) {
+        zassert_equal(event_wire_unzigzag(event_wire_zigzag(values[i])), values[i], "%lld not restored", values[i]);
+    }
+
+    /* Small magnitudes of either sign stay small */
+    zassert_equal(event_wire_zigzag(0), 0, "Wrong encoding");
+    zassert_equal(event_wire_zigzag(-1), 1, "Wrong encoding");
+    zassert_equal(event_wire_zigzag(1), 2, "Wrong encoding");
+    zassert_equal(event_wire_zigzag(INT32_MIN), UINT32_MAX, "Wrong encoding");
+    zassert_equal(event_wire_zigzag(INT64_MAX), UINT64_MAX - 1, "Wrong encoding");
+    zassert_equal(event_wire_zigzag(INT64_MIN), UINT64_MAX, "Wrong encoding");
+}
+
+ZTEST(event_wire_suite, test_fields_roundtrip_at_limits) {
+    const struct wire_test_fields limits[] = {
+        {.u8 = 0, .u64 = 0, .i32 = 0, .i64 = 0, .text = ""},
+        {.u8 = UINT8_MAX, .u64 = UINT64_MAX, .i32 = INT32_MIN, .i64 = INT64_MIN, .text = "1234567"},
+        {.u8 = 1, .u64 = 1, .i32 = INT32_MAX, .i64 = INT64_MAX, .text = "a"},
+        {.u8 = 0x80, .u64 = (uint64_t)UINT32_MAX + 1, .i32 = -1, .i64 = -1, .text = "\x80\xff"},
+    };
+    uint8_t buf[WIRE_TEST_MAX_LEN];
+
+    for (size_t i = 0; i < ARRAY_SIZE(limits); ++i) {
+        int len = wire_test_fields_encode(&limits[i], buf, sizeof(buf));
+        zassert_true(len > 0, "Failed to encode %d", len);
+        zassert_equal(len, wire_test_fields_size(&limits[i]), "Size does not match the encoding");
+
+        struct wire_test_fields decoded;
+        memset(&decoded, 0xAA, sizeof(decoded));
+        zassert_ok(wire_test_fields_decode(&decoded, buf, len), "Failed to decode");
+        zassert_equal(decoded.u8, limits[i].u8, "Wrong u8");
+        zassert_equal(decoded.u64, limits[i].u64, "Wrong u64");
+        zassert_equal(decoded.i32, limits[i].i32, "Wrong i32");
+        zassert_equal(decoded.i64, limits[i].i64, "Wrong i64");
+        zassert_mem_equal(decoded.text, limits[i].text, strlen(limits[i].text) + 1, "Wrong text");
+    }
+    zassert_equal(wire_test_fields_size(&limits[1]), WIRE_TEST_MAX_LEN, "Largest encoding changed");
+}
+
+ZTEST(event_wire_suite, test_encode_needs_room) {
+    const struct wire_test_fields fields = {.u64 = UINT64_MAX, .text = "text"};
+    uint8_t buf[WIRE_TEST_MAX_LEN];
+    size_t size = wire_test_fields_size(&fields);
+
+    zassert_equal(wire_test_fields_encode(&fields, buf, size - 1), -ENOSPC, "Encoded past the buffer");
+    zassert_equal(wire_test_fields_encode(&fields, buf, size), size, "Failed to encode into an exact fit");
+}
+
+ZTEST(event_wire_suite, test_string_longer_than_field) {
+    struct wire_test_fields fields = {0};
+    uint8_t buf[WIRE_TEST_MAX_LEN];
+
+    /* A string filling its buffer without terminator is cut to the characters that fit with one */
+    memcpy(fields.text, "12345678", sizeof(fields.text));
+    int len = wire_test_fields_encode(&fields, buf, sizeof(buf));
+    zassert_equal(buf[len - 8], 7, "String not cut to fit its field");
+
+    struct wire_test_fields decoded;
+    zassert_ok(wire_test_fields_decode(&decoded, buf, len), "Failed to decode");
+    zassert_mem_equal(decoded.text, "1234567", sizeof("1234567"), "Wrong text");
+
+    /* A string of the whole field size leaves no room for the terminator */
+    uint8_t wire[] = {0, 0, 0, 0, 8, '1', '2', '3', '4', '5', '6', '7', '8'};
+    zassert_equal(wire_test_fields_decode(&decoded, wire, sizeof(wire)), -EINVAL, "Accepted a string longer than its field");
+
+    /* A length beyond the input is not read past the end */
+    uint8_t past_end[] = {0, 0, 0, 0, 0x80, 0x01, 'x'};
+    zassert_equal(wire_test_fields_decode(&decoded, past_end, sizeof(past_end)), -EINVAL, "Read past the input");
+}
+
+ZTEST(event_wire_suite, test_integer_out_of_range) {
+    struct wire_test_fields decoded;
+
+    /* 256 does not fit in u8 */
+    uint8_t u8_overflow[] = {0x80, 0x02, 0, 0, 0, 0};
+    zassert_equal(wire_test_fields_decode(&decoded, u8_overflow, sizeof(u8_overflow)), -EINVAL, "Accepted 256 as uint8_t");
+
+    /* INT32_MAX + 1 does not fit in i32 */
+    uint8_t i32_overflow[] = {0, 0, 0x80, 0x80, 0x80, 0x80, 0x10, 0, 0};
+    zassert_equal(wire_test_fields_decode(&decoded, i32_overflow, sizeof(i32_overflow)), -EINVAL, "Accepted INT32_MAX + 1");
+
+    /* The tenth byte of a varint only holds bit 63 */
+    uint8_t u64_overflow[] = {0, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x02, 0, 0, 0};
+    zassert_equal(wire_test_fields_decode(&decoded, u64_overflow, sizeof(u64_overflow)), -EINVAL, "Accepted 65 bits");
+
+    /* Varints of more than ten bytes are rejected */
+    uint8_t too_long[] = {0, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x00, 0, 0, 0};
+    zassert_equal(wire_test_fields_decode(&decoded, too_long, sizeof(too_long)), -EINVAL, "Accepted an 11 byte varint");
+}
+
+ZTEST(event_wire_suite, test_truncated_input) {
+    const struct wire_test_fields fields = {.u8 = UINT8_MAX, .u64 = UINT64_MAX, .i32 = INT32_MIN, .i64 = INT64_MIN, .text = "text"};
+    uint8_t buf[WIRE_TEST_MAX_LEN];
+    int len = wire_test_fields_encode(&fields, buf, sizeof(buf));
+
+    /* Every prefix ends in the middle of a field, or before a field */
+    for (int i = 0; i < len; ++i) {
+        struct wire_test_fields decoded;
+        zassert_equal(wire_test_fields_decode(&decoded, buf, i), -EINVAL, "Accepted %d of %d bytes", i, len);
+    }
+}
+
+ZTEST(event_wire_suite, test_trailing_bytes) {
+    const struct wire_test_fields fields = {.u8 = 1, .text = "text"};
+    uint8_t buf[WIRE_TEST_MAX_LEN + 1];
+    int len = wire_test_fields_encode(&fields, buf, sizeof(buf));
+
+    struct wire_test_fields decoded;
+    buf[len] = 0;
+    zassert_equal(wire_test_fields_decode(&decoded, buf, len + 1), -EINVAL, "Accepted a trailing byte");
+    zassert_ok(wire_test_fields_decode(&decoded, buf, len), "Failed to decode");
+}
@@ -0,0 +1,248 @@
+#include <zephyr/sys/printk.h>
+#include <zephyr/timing/timing.h>
+#include <zephyr/ztest.h>
+
+#include "../../drivers/zephyr,uart-ipc-service-backend.c"
+
+/*
+ * Cycle counts of the per byte code of the driver, for payloads from 1 byte to several KB. Every measurement
+ * prints one line of key=value pairs starting with "framing_bench", so that runs can be compared by a script:
+ *
+ *   framing_bench op=receive_cobs size=1024 iterations=64 cycles_per_msg=... cycles_per_byte=... ns_per_msg=...
+ *
+ * Operations:
+ *   crc32, crc16        CRC over the payload
+ *   encode_fixed/_cobs  Every frame of a message encoded with encode_frame, as the TX path does
+ *   check_frame         Validation of every fixed frame of a message, including the crc
+ *   unwrap_frame        Copy of every validated fixed frame into the reassembly buffer
+ *   receive_fixed/_cobs Full RX path of an encoded message handed over in UART sized chunks, from frame
+ *                       parsing to reassembly and delivery
+ *   *_fec               The same with forward error correction, on clean frames
+ */
+
+#define BENCH_MAX_SIZE 4096
+#define BENCH_MAX_FRAMES DIV_ROUND_UP(BENCH_MAX_SIZE, FRAME_FRAG_SIZE)
+#define BENCH_BYTES_PER_RUN 65536  // Payload bytes processed per measurement, so that short payloads run long enough
+#define BENCH_MIN_ITERATIONS 16
+#define BENCH_RX_CHUNK_SIZE 128    // Bytes per UART_RX_RDY, as with the rx_buffer_size of the board overlays
+
+static const size_t bench_sizes[] = {1, 16, 64, 256, 1024, BENCH_MAX_SIZE};
+
+static uint8_t payload[BENCH_MAX_SIZE];
+static uint8_t reassembled[BENCH_MAX_SIZE];
+static uint8_t __aligned(4) encoded[BENCH_MAX_FRAMES * TX_FRAME_MAX_LEN];
+static size_t encoded_len;  // Written by the encode loops, so that they are not optimized away
+
+static struct backend_data bench_data;
+static struct backend_config bench_config;
+static struct backend_endpoint bench_endpoint;
+static struct device bench_instance = {.data = &bench_data, .config = &bench_config};
+static uint32_t delivered;
+
+static void bench_received(const void *data, size_t len, void *priv) {
+    delivered++;
+}
+
+static void *suite_setup(void) {
+    timing_init();
+    timing_start();
+    for (size_t i = 0; i < sizeof(payload); ++i) {
+        payload[i] = i * 7 + (i >> 8);  // Not compressible to nothing, and no run of zeros for COBS
+    }
+    printk("framing_bench_config timer_mhz=%u frag_size=%u rx_chunk=%u\n", (unsigned int)timing_freq_get_mhz(),
+           (unsigned int)FRAME_FRAG_SIZE, BENCH_RX_CHUNK_SIZE);
+    return NULL;
+}
+
+/* A receiving instance with endpoint 0 bound to peer address 0, as in the driver tests */
+static void suite_before(void *f) {
+    memset(&bench_data, 0, sizeof(bench_data));
+    memset(&bench_config, 0, sizeof(bench_config));
+    bench_config.endpoints = &bench_endpoint;
+    bench_config.endpoint_count = 1;
+    bench_data.rx_timeout = K_USEC(10000);
+    control_init(&bench_instance);
+
+    endpoint_init(&bench_endpoint, &bench_instance, 0);
+    bench_endpoint.is_registered = true;
+    bench_endpoint.is_bound = true;
+    bench_endpoint.cfg.name = "bench";
+    bench_endpoint.cfg.cb.received = bench_received;
+    delivered = 0;
+}
+
+ZTEST_SUITE(uart_ipc_framing_benchmark, NULL, suite_setup, suite_before, NULL, NULL);
+
+static size_t bench_iterations(size_t size) {
+    return MAX(BENCH_BYTES_PER_RUN / size, BENCH_MIN_ITERATIONS);
+}
+
+static void bench_report(const char *op, size_t size, size_t iterations, uint64_t cycles) {
+    uint64_t ns = timing_cycles_to_ns(cycles);
+    uint64_t milli_cycles_per_byte = cycles * 1000 / ((uint64_t)iterations * size);
+
+    printk("framing_bench op=%s size=%u iterations=%u cycles_per_msg=%u cycles_per_byte=%u.%03u ns_per_msg=%u\n", op,
+           (unsigned int)size, (unsigned int)iterations, (uint32_t)(cycles / iterations),
+           (uint32_t)(milli_cycles_per_byte / 1000), (uint32_t)(milli_cycles_per_byte % 1000), (uint32_t)(ns / iterations));
+}
+
+/* Encodes the payload the way a peer would send it, into encoded */
+static size_t encode_message(const struct backend_config *config, size_t size) {
+    size_t written = 0;
+
+    for (size_t frag_start = 0; frag_start < size; frag_start += FRAME_FRAG_SIZE) {
+        const struct frame_info info = {
+            .addr = 0,
+            .total_data_length = size,
+            .frag_start = frag_start,
+            .frag = payload + frag_start,
+            .frag_len = MIN(FRAME_FRAG_SIZE, size - frag_start),
+        };
+        written += encode_frame(config, encoded + written, &info);
+    }
+    return written;
+}
+
+static void bench_crc(const char *op, bool crc16) {
+    for (size_t i = 0; i < ARRAY_SIZE(bench_sizes); ++i) {
+        const size_t size = bench_sizes[i];
+        const size_t iterations = bench_iterations(size);
+        volatile uint32_t sink = 0;  // Keeps the results alive
+
+        timing_t start = timing_counter_get();
+        for (size_t n = 0; n < iterations; ++n) {
+            sink += crc16 ? uart_ipc_crc16(payload, size) : uart_ipc_crc32(payload, size);
+        }
+        timing_t end = timing_counter_get();
+        bench_report(op, size, iterations, timing_cycles_get(&start, &end));
+    }
+}
+
+static void bench_encode(const char *op, enum uart_ipc_framing framing, bool fec) {
+    const struct backend_config config = {.framing = framing, .fec = fec};
+
+    for (size_t i = 0; i < ARRAY_SIZE(bench_sizes); ++i) {
+        const size_t size = bench_sizes[i];
+        const size_t iterations = bench_iterations(size);
+
+        timing_t start = timing_counter_get();
+        for (size_t n = 0; n < iterations; ++n) {
+            encoded_len = encode_message(&config, size);
+        }
+        timing_t end = timing_counter_get();
+        bench_report(op, size, iterations, timing_cycles_get(&start, &end));
+    }
+}
+
+/* Hands the encoded message to the driver in chunks, as the UART reports it */
+static void receive_message(size_t len) {
+    for (size_t offset = 0; offset < len; offset += BENCH_RX_CHUNK_SIZE) {
+        receive_bytes(&bench_instance, encoded + offset, MIN(BENCH_RX_CHUNK_SIZE, len - offset));
+    }
+}
+
+static void bench_receive(const char *op, enum uart_ipc_framing framing, bool fec) {
+    bench_config.framing = framing;
+    bench_config.fec = fec;
+
+    for (size_t i = 0; i < ARRAY_SIZE(bench_sizes); ++i) {
+        const size_t size = bench_sizes[i];
+        const size_t iterations = bench_iterations(size);
+        const size_t len = encode_message(&bench_config, size);
+        uint32_t delivered_before = delivered;
+
+        timing_t start = timing_counter_get();
+        for (size_t n = 0; n < iterations; ++n) {
+            receive_message(len);
+        }
+        timing_t end = timing_counter_get();
+        zassert_equal(delivered - delivered_before, iterations, "Messages of %u bytes were not delivered", size);
+        bench_report(op, size, iterations, timing_cycles_get(&start, &end));
+    }
+}
+
+ZTEST(uart_ipc_framing_benchmark, test_crc32) {
+    bench_crc("crc32", false);
+}
+
+ZTEST(uart_ipc_framing_benchmark, test_crc16) {
+    bench_crc("crc16", true);
+}
+
+ZTEST(uart_ipc_framing_benchmark, test_encode_fixed) {
+    bench_encode("encode_fixed", UART_IPC_FRAMING_FIXED, false);
+}
+
+ZTEST(uart_ipc_framing_benchmark, test_encode_cobs) {
+    bench_encode("encode_cobs", UART_IPC_FRAMING_COBS, false);
+}
+
+ZTEST(uart_ipc_framing_benchmark, test_encode_fixed_fec) {
+    bench_encode("encode_fixed_fec", UART_IPC_FRAMING_FIXED, true);
+}
+
+ZTEST(uart_ipc_framing_benchmark, test_encode_cobs_fec) {
+    bench_encode("encode_cobs_fec", UART_IPC_FRAMING_COBS, true);
+}
+
+ZTEST(uart_ipc_framing_benchmark, test_check_frame) {
+    const struct backend_config config = {.framing = UART_IPC_FRAMING_FIXED};
+
+    for (size_t i = 0; i < ARRAY_SIZE(bench_sizes); ++i) {
+        const size_t size = bench_sizes[i];
+        const size_t iterations = bench_iterations(size);
+        const size_t n_frames = encode_message(&config, size) / sizeof(struct uart_ipc_frame);
+        struct uart_ipc_frame *frames = (struct uart_ipc_frame *)encoded;
+        int err = 0;
+
+        timing_t start = timing_counter_get();
+        for (size_t n = 0; n < iterations; ++n) {
+            for (size_t f = 0; f < n_frames; ++f) {
+                err |= check_frame(&frames[f]);
+            }
+        }
+        timing_t end = timing_counter_get();
+        zassert_ok(err, "Frames of a %u byte message did not validate", size);
+        bench_report("check_frame", size, iterations, timing_cycles_get(&start, &end));
+    }
+}
+
+ZTEST(uart_ipc_framing_benchmark, test_unwrap_frame) {
+    const struct backend_config config = {.framing = UART_IPC_FRAMING_FIXED};
+
+    for (size_t i = 0; i < ARRAY_SIZE(bench_sizes); ++i) {
+        const size_t size = bench_sizes[i];
+        const size_t iterations = bench_iterations(size);
+        const size_t n_frames = encode_message(&config, size) / sizeof(struct uart_ipc_frame);
+        struct uart_ipc_frame *frames = (struct uart_ipc_frame *)encoded;
+        int err = 0;
+
+        timing_t start = timing_counter_get();
+        for (size_t n = 0; n < iterations; ++n) {
+            for (size_t f = 0; f < n_frames; ++f) {
+                size_t added = 0;
+                err |= unwrap_frame(reassembled, size, &frames[f], &added);
+            }
+        }
+        timing_t end = timing_counter_get();
+        zassert_ok(err, "Frames of a %u byte message could not be unwrapped", size);
+        zassert_mem_equal(reassembled, payload, size, "Unwrapped data differs");
+        bench_report("unwrap_frame", size, iterations, timing_cycles_get(&start, &end));
+    }
+}
+
+ZTEST(uart_ipc_framing_benchmark, test_receive_fixed) {
+    bench_receive("receive_fixed", UART_IPC_FRAMING_FIXED, false);
+}
+
+ZTEST(uart_ipc_framing_benchmark, test_receive_cobs) {
+    bench_receive("receive_cobs", UART_IPC_FRAMING_COBS, false);
+}
+
+ZTEST(uart_ipc_framing_benchmark, test_receive_fixed_fec) {
+    bench_receive("receive_fixed_fec", UART_IPC_FRAMING_FIXED, true);
+}
+
+ZTEST(uart_ipc_framing_benchmark, test_receive_cobs_fec) {
+    bench_receive("receive_cobs_fec", UART_IPC_FRAMING_COBS, true);
+}
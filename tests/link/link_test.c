@@ -0,0 +1,374 @@
+#include <stdlib.h>
+#include <string.h>
+#include <zephyr/device.h>
+#include <zephyr/drivers/uart.h>
+#include <zephyr/ipc/ipc_service.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/printk.h>
+#include <zephyr/ztest.h>
+
+#include "uart_ipc_emul.h"
+#include "uart_ipc_stats.h"
+
+/*
+ * Runs backend instances against each other over emulated UARTs with faults injected on the line. Every fault
+ * profile is run on a best effort link, on a best effort link without receive timeout, on a reliable link and on
+ * a link with forward error correction, and one line per run reports how many messages made it across, how long
+ * they took and the goodput. After each run the faults are turned off and the link must carry messages again,
+ * best effort links the very next one: a transfer cut short by the faults must not hold it up.
+ */
+
+#define LINK_MESSAGE_COUNT 200
+#define LINK_MESSAGE_LEN 96  // Two fragments, so that reassembly is exercised as well
+#define LINK_SEND_INTERVAL_MS 2
+#define LINK_SETTLE_MS 2000  // Time left for retransmissions after the last message
+#define LINK_RECOVERY_ATTEMPTS 20
+#define LINK_PROBE_SEQ UINT32_MAX
+#define LINK_LATE_PEER_DELAY_MS 5000  // Well past the bond timeout of the event manager proxy
+
+struct link_message {
+    uint32_t seq;
+    uint32_t sent_at;  // Cycle count
+    uint8_t payload[LINK_MESSAGE_LEN - 2 * sizeof(uint32_t)];
+};
+
+struct link {
+    const char *name;
+    bool reliable;                    // Messages must arrive in order and exactly once
+    bool fec;                         // Corrupted bytes are repaired by the receiver
+    const struct device *tx;          // Backend instance sending the messages
+    const struct device *rx;          // Backend instance receiving them
+    const struct device *tx_uart;     // Emulated UARTs, faults are injected on both
+    const struct device *rx_uart;
+    struct ipc_ept tx_ept;
+    struct ipc_ept rx_ept;
+};
+
+#define LINK_INIT(_name, _reliable, tx_node, rx_node)        \
+    {                                                        \
+        .name = _name,                                       \
+        .reliable = _reliable,                               \
+        .fec = DT_PROP(tx_node, fec),                        \
+        .tx = DEVICE_DT_GET(tx_node),                        \
+        .rx = DEVICE_DT_GET(rx_node),                        \
+        .tx_uart = DEVICE_DT_GET(DT_PARENT(tx_node)),        \
+        .rx_uart = DEVICE_DT_GET(DT_PARENT(rx_node)),        \
+    }
+
+static struct link links[] = {
+    LINK_INIT("best_effort", false, DT_NODELABEL(link_best_effort_tx), DT_NODELABEL(link_best_effort_rx)),
+    LINK_INIT("no_timeout", false, DT_NODELABEL(link_no_timeout_tx), DT_NODELABEL(link_no_timeout_rx)),
+    LINK_INIT("reliable", true, DT_NODELABEL(link_reliable_tx), DT_NODELABEL(link_reliable_rx)),
+    LINK_INIT("fec", false, DT_NODELABEL(link_fec_tx), DT_NODELABEL(link_fec_rx)),
+};
+
+struct link_profile {
+    const char *name;
+    struct uart_ipc_emul_faults faults;
+};
+
+/* Received messages of the current run, only written from the receive callback */
+static struct {
+    uint32_t delivered;
+    uint32_t corrupted;
+    uint32_t duplicates;
+    uint32_t out_of_order;
+    uint32_t highest_seq;
+    uint32_t last_delivery;  // Cycle count
+    bool seen[LINK_MESSAGE_COUNT];
+    uint32_t latency_us[LINK_MESSAGE_COUNT];
+} rx;
+
+static K_SEM_DEFINE(link_bound, 0, 2 * ARRAY_SIZE(links));
+static K_SEM_DEFINE(probe_received, 0, 1);
+static K_SEM_DEFINE(late_bound, 0, 2);
+
+static void fill_payload(struct link_message *msg) {
+    for (size_t i = 0; i < sizeof(msg->payload); ++i) {
+        msg->payload[i] = msg->seq * 31 + i;
+    }
+}
+
+static bool payload_valid(const struct link_message *msg) {
+    for (size_t i = 0; i < sizeof(msg->payload); ++i) {
+        if (msg->payload[i] != (uint8_t)(msg->seq * 31 + i)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void link_bound_cb(void *priv) {
+    k_sem_give(&link_bound);
+}
+
+static void link_received(const void *data, size_t len, void *priv) {
+    uint32_t now = k_cycle_get_32();
+    struct link_message msg;
+
+    if (len != sizeof(msg)) {
+        rx.corrupted++;
+        return;
+    }
+    memcpy(&msg, data, sizeof(msg));
+    if (msg.seq == LINK_PROBE_SEQ && payload_valid(&msg)) {
+        k_sem_give(&probe_received);
+        return;
+    }
+    if (msg.seq >= LINK_MESSAGE_COUNT || !payload_valid(&msg)) {
+        rx.corrupted++;
+        return;
+    }
+    if (rx.seen[msg.seq]) {
+        rx.duplicates++;
+        return;
+    }
+    if (rx.delivered > 0 && msg.seq < rx.highest_seq) {
+        rx.out_of_order++;
+    }
+    rx.highest_seq = MAX(rx.highest_seq, msg.seq);
+    rx.seen[msg.seq] = true;
+    rx.latency_us[rx.delivered++] = k_cyc_to_us_floor32(now - msg.sent_at);
+    rx.last_delivery = now;
+}
+
+static void link_error(const char *message, void *priv) {
+    // Expected while faults are injected, the delivered messages tell how well the link coped
+}
+
+static void late_bound_cb(void *priv) {
+    k_sem_give(&late_bound);
+}
+
+static void *suite_setup(void) {
+    static const struct ipc_ept_cfg ept_cfg = {
+        .name = "link",
+        .cb = {.bound = link_bound_cb, .received = link_received, .error = link_error},
+    };
+
+    for (size_t i = 0; i < ARRAY_SIZE(links); ++i) {
+        struct link *link = &links[i];
+        zassert_ok(ipc_service_open_instance(link->tx), "Failed to open %s link", link->name);
+        zassert_ok(ipc_service_open_instance(link->rx), "Failed to open %s link", link->name);
+        zassert_ok(ipc_service_register_endpoint(link->tx, &link->tx_ept, &ept_cfg), "Failed to register endpoint");
+        zassert_ok(ipc_service_register_endpoint(link->rx, &link->rx_ept, &ept_cfg), "Failed to register endpoint");
+    }
+    for (size_t i = 0; i < 2 * ARRAY_SIZE(links); ++i) {
+        zassert_ok(k_sem_take(&link_bound, K_SECONDS(1)), "Endpoints did not bind");
+    }
+    return NULL;
+}
+
+ZTEST_SUITE(uart_ipc_link_suite, NULL, suite_setup, NULL, NULL, NULL);
+
+static int compare_u32(const void *a, const void *b) {
+    uint32_t x = *(const uint32_t *)a;
+    uint32_t y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+static void set_faults(const struct link *link, const struct uart_ipc_emul_faults *faults) {
+    struct uart_ipc_emul_faults reverse = *faults;
+
+    reverse.seed = faults->seed ? faults->seed ^ 0x5bd1e995 : 0;  // Different faults on the way back
+    zassert_ok(uart_ipc_emul_set_faults(link->rx_uart, faults), "Failed to set faults");
+    zassert_ok(uart_ipc_emul_set_faults(link->tx_uart, &reverse), "Failed to set faults");
+}
+
+/* Sends probes until one gets across, now that the faults are off */
+static bool link_recovers(struct link *link) {
+    struct link_message probe = {.seq = LINK_PROBE_SEQ};
+
+    fill_payload(&probe);
+    for (size_t attempt = 0; attempt < LINK_RECOVERY_ATTEMPTS; ++attempt) {
+        probe.sent_at = k_cycle_get_32();
+        ipc_service_send(&link->tx_ept, &probe, sizeof(probe));
+        if (k_sem_take(&probe_received, K_MSEC(100)) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/* Sends a single probe right after the faults, it must get across */
+static bool link_delivers_at_once(struct link *link) {
+    struct link_message probe = {.seq = LINK_PROBE_SEQ, .sent_at = k_cycle_get_32()};
+
+    fill_payload(&probe);
+    uart_poll_out(link->tx_uart, 0);  // Delimits a COBS frame cut short by the faults, which is dropped
+    ipc_service_send(&link->tx_ept, &probe, sizeof(probe));
+    return k_sem_take(&probe_received, K_MSEC(100)) == 0;
+}
+
+static void run_link(struct link *link, const struct link_profile *profile) {
+    uint32_t sent = 0;
+    uint32_t send_failures = 0;
+
+    memset(&rx, 0, sizeof(rx));
+    k_sem_reset(&probe_received);
+    uart_ipc_stats_reset(link->tx);
+    uart_ipc_stats_reset(link->rx);
+    set_faults(link, &profile->faults);
+
+    uint32_t start = k_cycle_get_32();
+    for (uint32_t seq = 0; seq < LINK_MESSAGE_COUNT; ++seq) {
+        struct link_message msg = {.seq = seq, .sent_at = k_cycle_get_32()};
+        fill_payload(&msg);
+        if (ipc_service_send(&link->tx_ept, &msg, sizeof(msg)) < 0) {
+            send_failures++;
+        } else {
+            sent++;
+        }
+        k_sleep(K_MSEC(LINK_SEND_INTERVAL_MS));
+    }
+    k_sleep(K_MSEC(LINK_SETTLE_MS));
+
+    struct uart_ipc_emul_fault_counts injected, injected_reverse;
+    uart_ipc_emul_get_fault_counts(link->rx_uart, &injected);
+    uart_ipc_emul_get_fault_counts(link->tx_uart, &injected_reverse);
+    const struct uart_ipc_emul_faults no_faults = {0};
+    set_faults(link, &no_faults);
+
+    struct uart_ipc_stats tx_stats = {0}, rx_stats = {0};
+    uart_ipc_stats_get(link->tx, &tx_stats);
+    uart_ipc_stats_get(link->rx, &rx_stats);
+
+    uint32_t delivered = rx.delivered;
+    qsort(rx.latency_us, delivered, sizeof(rx.latency_us[0]), compare_u32);
+    uint32_t elapsed_us = MAX(k_cyc_to_us_floor32((delivered ? rx.last_delivery : k_cycle_get_32()) - start), 1);
+
+    printk("link profile=%s link=%s sent=%u send_failures=%u delivered=%u lost=%u corrupted=%u duplicates=%u "
+           "out_of_order=%u latency_us_median=%u latency_us_p99=%u latency_us_max=%u goodput_bytes_per_s=%u "
+           "retransmissions=%u crc_errors=%u resyncs=%u fec_corrected=%u injected_bit_flips=%u "
+           "injected_dropped_bytes=%u injected_splits=%u injected_merges=%u injected_delayed_buf_requests=%u "
+           "injected_tx_aborts=%u\n",
+           profile->name, link->name, sent, send_failures, delivered, sent - MIN(delivered, sent), rx.corrupted,
+           rx.duplicates, rx.out_of_order, delivered ? rx.latency_us[delivered / 2] : 0,
+           delivered ? rx.latency_us[delivered * 99 / 100] : 0, delivered ? rx.latency_us[delivered - 1] : 0,
+           (uint32_t)((uint64_t)delivered * sizeof(struct link_message) * USEC_PER_SEC / elapsed_us),
+           tx_stats.retransmissions, rx_stats.crc_errors + tx_stats.crc_errors, rx_stats.resyncs + tx_stats.resyncs,
+           rx_stats.fec_corrected + tx_stats.fec_corrected,
+           injected.bit_flips + injected_reverse.bit_flips, injected.dropped_bytes + injected_reverse.dropped_bytes,
+           injected.splits + injected_reverse.splits, injected.merges + injected_reverse.merges,
+           injected.delayed_buf_requests + injected_reverse.delayed_buf_requests,
+           injected.tx_aborts + injected_reverse.tx_aborts);
+
+    if (link->reliable) {
+        zassert_equal(rx.corrupted, 0, "Corrupted messages delivered on the reliable link");
+        zassert_equal(rx.duplicates, 0, "Messages delivered twice on the reliable link");
+        zassert_equal(rx.out_of_order, 0, "Messages delivered out of order on the reliable link");
+    } else if (!link->fec) {
+        zassert_true(link_delivers_at_once(link), "%s link held up by a lost fragment in profile %s", link->name, profile->name);
+    }
+    zassert_true(link_recovers(link), "%s link did not recover from profile %s", link->name, profile->name);
+}
+
+static void run_profile(const struct link_profile *profile) {
+    for (size_t i = 0; i < ARRAY_SIZE(links); ++i) {
+        run_link(&links[i], profile);
+    }
+}
+
+ZTEST(uart_ipc_link_suite, test_clean_link) {
+    const struct link_profile profile = {.name = "clean"};
+
+    for (size_t i = 0; i < ARRAY_SIZE(links); ++i) {
+        run_link(&links[i], &profile);
+        zassert_equal(rx.delivered, LINK_MESSAGE_COUNT, "Messages lost on a clean %s link", links[i].name);
+        zassert_equal(rx.corrupted, 0, "Corrupted messages on a clean %s link", links[i].name);
+    }
+}
+
+ZTEST(uart_ipc_link_suite, test_bit_flips) {
+    const struct link_profile profile = {
+        .name = "bit_flips",
+        .faults = {.seed = 1, .bit_flip_ppm = 500},
+    };
+
+    for (size_t i = 0; i < ARRAY_SIZE(links); ++i) {
+        run_link(&links[i], &profile);
+        if (links[i].fec) {
+            /* Several flips in one frame are needed to get past the parity at this rate */
+            zassert_equal(rx.delivered, LINK_MESSAGE_COUNT, "Messages lost to bit flips on the %s link", links[i].name);
+        }
+    }
+}
+
+ZTEST(uart_ipc_link_suite, test_dropped_bytes) {
+    run_profile(&(const struct link_profile){
+        .name = "dropped_bytes",
+        .faults = {.seed = 2, .drop_ppm = 500},
+    });
+}
+
+ZTEST(uart_ipc_link_suite, test_split_chunks) {
+    run_profile(&(const struct link_profile){
+        .name = "split_chunks",
+        .faults = {.seed = 3, .split_ppm = 500000},
+    });
+}
+
+ZTEST(uart_ipc_link_suite, test_merged_chunks) {
+    run_profile(&(const struct link_profile){
+        .name = "merged_chunks",
+        .faults = {.seed = 4, .merge_ppm = 500000},
+    });
+}
+
+ZTEST(uart_ipc_link_suite, test_delayed_buf_requests) {
+    run_profile(&(const struct link_profile){
+        .name = "delayed_buf_requests",
+        .faults = {.seed = 5, .buf_request_delay_ppm = 100000, .buf_request_delay_us = 2000},
+    });
+}
+
+ZTEST(uart_ipc_link_suite, test_tx_aborts) {
+    run_profile(&(const struct link_profile){
+        .name = "tx_aborts",
+        .faults = {.seed = 6, .tx_abort_ppm = 20000},
+    });
+}
+
+ZTEST(uart_ipc_link_suite, test_all_faults) {
+    run_profile(&(const struct link_profile){
+        .name = "all_faults",
+        .faults = {
+            .seed = 7,
+            .bit_flip_ppm = 200,
+            .drop_ppm = 200,
+            .split_ppm = 200000,
+            .merge_ppm = 200000,
+            .buf_request_delay_ppm = 50000,
+            .buf_request_delay_us = 2000,
+            .tx_abort_ppm = 10000,
+        },
+    });
+}
+
+ZTEST(uart_ipc_link_suite, test_late_peer) {
+    static const struct ipc_ept_cfg ept_cfg = {
+        .name = "late",
+        .cb = {.bound = late_bound_cb, .received = link_received, .error = link_error},
+    };
+    const struct device *first = DEVICE_DT_GET(DT_NODELABEL(link_late_first));
+    const struct device *second = DEVICE_DT_GET(DT_NODELABEL(link_late_second));
+    static struct ipc_ept first_ept, second_ept;
+
+    /* One side registers its endpoint long before the other one starts */
+    zassert_ok(ipc_service_open_instance(first), "Failed to open first instance");
+    zassert_ok(ipc_service_register_endpoint(first, &first_ept, &ept_cfg), "Failed to register endpoint");
+    k_sleep(K_MSEC(LINK_LATE_PEER_DELAY_MS));
+    zassert_equal(k_sem_count_get(&late_bound), 0, "Endpoint bound without a peer");
+
+    /* Both endpoints bind as soon as the peer is up, and carry messages */
+    zassert_ok(ipc_service_open_instance(second), "Failed to open second instance");
+    zassert_ok(ipc_service_register_endpoint(second, &second_ept, &ept_cfg), "Failed to register endpoint");
+    for (size_t i = 0; i < 2; ++i) {
+        zassert_ok(k_sem_take(&late_bound, K_SECONDS(1)), "Endpoints did not bind to the late peer");
+    }
+
+    struct link_message probe = {.seq = LINK_PROBE_SEQ};
+    k_sem_reset(&probe_received);
+    zassert_true(ipc_service_send(&first_ept, &probe, sizeof(probe)) >= 0, "Failed to send");
+    zassert_ok(k_sem_take(&probe_received, K_MSEC(100)), "Message not delivered to the late peer");
+}